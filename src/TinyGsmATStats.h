@@ -0,0 +1,215 @@
+/**
+ * @file       TinyGsmATStats.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef SRC_TINYGSMATSTATS_H_
+#define SRC_TINYGSMATSTATS_H_
+
+#include "TinyGsmCommon.h"
+
+// Timing of every AT command, kept per command when TINY_GSM_AT_STATS is
+// defined before including TinyGsmClient.h; without it none of this is
+// compiled in.  A command is timed from sendAT() until waitResponse() matches
+// one of the responses it was given, or until the next command if it never
+// does (a timeout).  Commands are told apart by their text up to the first
+// '=', '?' or ','.
+
+// Number of different commands tracked; commands beyond that are counted
+// together under "*"
+#if !defined(TINY_GSM_AT_STATS_COMMANDS)
+#define TINY_GSM_AT_STATS_COMMANDS 16
+#endif
+
+// Longest command name kept, including "AT"
+#define TINY_GSM_AT_STATS_NAME_LEN 12
+
+// Upper edges of the latency histogram buckets in milliseconds; the last
+// bucket takes everything slower
+#define TINY_GSM_AT_STATS_BUCKETS 8
+static const uint16_t TinyGsmATStatsEdges[TINY_GSM_AT_STATS_BUCKETS - 1] = {
+    5, 20, 50, 100, 250, 1000, 5000};
+
+struct TinyGsmATStat {
+  char     command[TINY_GSM_AT_STATS_NAME_LEN + 1];
+  uint16_t count;
+  uint16_t results[6];  // by matched response index, [0] are timeouts
+  uint16_t histogram[TINY_GSM_AT_STATS_BUCKETS];
+  uint32_t total_ms;       // send to match
+  uint32_t first_byte_ms;  // send to the first character back, summed
+  uint16_t max_ms;
+  uint32_t bytes_out;
+  uint32_t bytes_in;  // up to the matched response
+};
+
+class TinyGsmATStats {
+ public:
+  // Recording can be switched off at run time, e.g. to only sample some
+  // devices
+  bool enabled = true;
+
+  // Starts timing the command made of the given sendAT() arguments
+  template <typename... Args>
+  void commandSent(Args... cmd) {
+    if (open) { record(0); }
+    if (!enabled) { return; }
+    NamePrinter name;
+    name.print("AT");
+    name.printAll(cmd...);
+    current = findEntry(name.text);
+    if (!current) { return; }
+    open             = true;
+    sent_us          = micros();
+    ended_us         = sent_us;
+    first_byte_us    = 0;
+    got_first_byte   = false;
+    pending_bytes_in = 0;
+    current->bytes_out += name.length + 2;  // with the line ending
+  }
+
+  // Called whenever the library waits for the modem, noting when the reply
+  // starts to come in
+  void responseWaiting(bool available) {
+    if (!open || got_first_byte || !available) { return; }
+    got_first_byte = true;
+    first_byte_us  = micros() - sent_us;
+  }
+
+  // Called as waitResponse() returns.  A miss only marks the time; the
+  // command may still be answered by a later waitResponse().
+  void responseMatched(int8_t index, size_t bytes) {
+    if (!open) { return; }
+    pending_bytes_in += bytes;
+    ended_us = micros();
+    if (index > 0) { record(index); }
+  }
+  void commandTimedOut() {
+    if (open) { record(0); }
+  }
+
+  uint8_t size() {
+    return used;
+  }
+  const TinyGsmATStat& operator[](uint8_t i) {
+    return entries[i];
+  }
+  void clear() {
+    used = 0;
+    open = false;
+  }
+
+  // Writes one line per command: name, count, results (ok counts the first
+  // response waited for, usually OK), mean and max time, mean time to the
+  // first byte, bytes out and in, then the histogram
+  void printTo(Print& out) {
+    for (uint8_t i = 0; i < used; i++) {
+      TinyGsmATStat& s = entries[i];
+      out.print(s.command);
+      out.print(GF(" n="));
+      out.print(s.count);
+      out.print(GF(" ok="));
+      out.print(s.results[1]);
+      out.print(GF(" other="));
+      out.print(s.results[2] + s.results[3] + s.results[4] + s.results[5]);
+      out.print(GF(" timeout="));
+      out.print(s.results[0]);
+      out.print(GF(" mean_ms="));
+      out.print(s.count ? s.total_ms / s.count : 0);
+      out.print(GF(" max_ms="));
+      out.print(s.max_ms);
+      out.print(GF(" first_ms="));
+      out.print(s.count ? s.first_byte_ms / s.count : 0);
+      out.print(GF(" out="));
+      out.print(s.bytes_out);
+      out.print(GF(" in="));
+      out.print(s.bytes_in);
+      out.print(GF(" hist="));
+      for (uint8_t b = 0; b < TINY_GSM_AT_STATS_BUCKETS; b++) {
+        if (b) { out.print(','); }
+        out.print(s.histogram[b]);
+      }
+      out.println();
+    }
+  }
+
+ protected:
+  // Keeps the start of what is printed to it, up to the first '=', '?' or
+  // ',', and counts the rest
+  class NamePrinter : public Print {
+   public:
+    char   text[TINY_GSM_AT_STATS_NAME_LEN + 1] = {0};
+    size_t length                               = 0;
+
+    size_t write(uint8_t c) override {
+      if (c == '=' || c == '?' || c == ',') { done = true; }
+      if (!done && length < TINY_GSM_AT_STATS_NAME_LEN) { text[length] = c; }
+      length++;
+      return 1;
+    }
+    using Print::write;
+
+    void printAll() {}
+    template <typename T, typename... Args>
+    void printAll(T head, Args... tail) {
+      print(head);
+      printAll(tail...);
+    }
+
+   protected:
+    bool done = false;
+  };
+
+  TinyGsmATStat* findEntry(const char* name) {
+    for (uint8_t i = 0; i < used; i++) {
+      if (!strcmp(entries[i].command, name)) { return &entries[i]; }
+    }
+    if (used >= TINY_GSM_AT_STATS_COMMANDS) {
+      // Out of room; an extra entry collects the rest
+      TinyGsmATStat& rest = entries[TINY_GSM_AT_STATS_COMMANDS];
+      if (used == TINY_GSM_AT_STATS_COMMANDS) {
+        memset(&rest, 0, sizeof(rest));
+        rest.command[0] = '*';
+        used++;
+      }
+      return &rest;
+    }
+    TinyGsmATStat& entry = entries[used++];
+    memset(&entry, 0, sizeof(entry));
+    TinyGsmCopyString(entry.command, sizeof(entry.command), name);
+    return &entry;
+  }
+
+  void record(int8_t index) {
+    uint32_t ms = (ended_us - sent_us + 500) / 1000;
+    open        = false;
+    current->count++;
+    current->results[index]++;
+    current->total_ms += ms;
+    current->first_byte_ms += (first_byte_us + 500) / 1000;
+    current->max_ms = TinyGsmMax(current->max_ms,
+                                 static_cast<uint16_t>(TinyGsmMin(
+                                     ms, static_cast<uint32_t>(0xFFFF))));
+    current->bytes_in += pending_bytes_in;
+    uint8_t bucket = 0;
+    while (bucket < TINY_GSM_AT_STATS_BUCKETS - 1 &&
+           ms > TinyGsmATStatsEdges[bucket]) {
+      bucket++;
+    }
+    current->histogram[bucket]++;
+  }
+
+  TinyGsmATStat  entries[TINY_GSM_AT_STATS_COMMANDS + 1];
+  uint8_t        used    = 0;
+  TinyGsmATStat* current = NULL;
+  bool           open    = false;
+  bool           got_first_byte;
+  uint32_t       sent_us;
+  uint32_t       ended_us;
+  uint32_t       first_byte_us;
+  uint32_t       pending_bytes_in;
+};
+
+#endif  // SRC_TINYGSMATSTATS_H_
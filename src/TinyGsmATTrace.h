@@ -0,0 +1,195 @@
+/**
+ * @file       TinyGsmATTrace.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef SRC_TINYGSMATTRACE_H_
+#define SRC_TINYGSMATTRACE_H_
+
+#include "TinyGsmCommon.h"
+
+#if defined(__linux__)
+#include <stdio.h>
+#endif
+
+// Keeps the last bytes that went to and from the modem in memory, with the
+// time they were sent or read, when TINY_GSM_AT_TRACE is defined before
+// including TinyGsmClient.h.  Unlike DUMP_AT_COMMANDS nothing is printed as
+// it happens, so timing is barely changed; dump the trace when something
+// goes wrong instead:
+//
+//   if (!modem.gprsConnect(apn)) { modem.getATTrace().printTo(SerialMon); }
+//
+// The trace is a series of records, oldest first, each one being
+//
+//   1 byte   direction in the top bit (1 is to the modem), length below it
+//   4 bytes  micros() at the first byte, little endian
+//   n bytes  the data
+//
+// Bytes going the same way are added to the last record until it is full or
+// TINY_GSM_AT_TRACE_GAP_US goes by without one.  Old records are dropped to
+// make room for new ones.  writeTo() and saveTo() write the records as they
+// are, after a "TGAT" and a version byte.
+
+// Bytes of memory the records take up; at least 256
+#if !defined(TINY_GSM_AT_TRACE_SIZE)
+#define TINY_GSM_AT_TRACE_SIZE 1024
+#endif
+
+// A pause longer than this starts a new record
+#if !defined(TINY_GSM_AT_TRACE_GAP_US)
+#define TINY_GSM_AT_TRACE_GAP_US 2000
+#endif
+
+#define TINY_GSM_AT_TRACE_HEADER 5
+#define TINY_GSM_AT_TRACE_MAX_LEN 0x7F
+
+class TinyGsmATTrace {
+ public:
+  // Recording can be stopped, e.g. to keep the bytes around a failure until
+  // they are dumped
+  bool enabled = true;
+
+  void record(bool to_modem, const uint8_t* data, size_t len) {
+    if (!enabled || !len) { return; }
+    uint32_t now    = micros();
+    bool     recent = now - last_us <= TINY_GSM_AT_TRACE_GAP_US;
+    last_us         = now;
+    while (len--) {
+      bool append = open_record && recent && to_modem == open_to_modem &&
+                    open_len < TINY_GSM_AT_TRACE_MAX_LEN;
+      // Making room must not drop the record being added to
+      if (append && used == TINY_GSM_AT_TRACE_SIZE && tail == open_pos) {
+        append = false;
+      }
+      if (append) {
+        makeRoom(1);
+      } else {
+        makeRoom(TINY_GSM_AT_TRACE_HEADER + 1);
+        open_record   = true;
+        open_to_modem = to_modem;
+        open_pos      = head;
+        open_len      = 0;
+        push(0);
+        for (uint8_t i = 0; i < 4; i++) { push(now >> (8 * i)); }
+        records++;
+      }
+      push(*data++);
+      open_len++;
+      buf[open_pos] = (to_modem ? 0x80 : 0) | open_len;
+      recent        = true;
+    }
+  }
+
+  // Number of records held and bytes they take up
+  uint16_t size() {
+    return records;
+  }
+  uint16_t length() {
+    return used;
+  }
+  // Records dropped to make room since the last clear()
+  uint32_t droppedRecords() {
+    return dropped;
+  }
+  void clear() {
+    head = tail = used = records = 0;
+    dropped     = 0;
+    open_record = false;
+  }
+
+  // Writes the records in the binary format above
+  void writeTo(Print& out) {
+    out.print(GF("TGAT"));
+    out.write(static_cast<uint8_t>(1));
+    for (uint16_t i = 0; i < used; i++) { out.write(at(i)); }
+  }
+
+#if defined(__linux__)
+  // Writes the records to a file in the binary format above
+  bool saveTo(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) { return false; }
+    fwrite("TGAT\x01", 1, 5, file);
+    for (uint16_t i = 0; i < used; i++) { fputc(at(i), file); }
+    return fclose(file) == 0;
+  }
+#endif
+
+  // Writes one line per record for reading over a debug port: the time, '>'
+  // for bytes to the modem or '<' for bytes from it, then the bytes with line
+  // endings and other control characters escaped
+  void printTo(Print& out) {
+    uint16_t i = 0;
+    while (i < used) {
+      uint8_t  header = at(i);
+      uint8_t  len    = header & TINY_GSM_AT_TRACE_MAX_LEN;
+      uint32_t us     = 0;
+      for (uint8_t b = 0; b < 4; b++) {
+        us |= static_cast<uint32_t>(at(i + 1 + b)) << (8 * b);
+      }
+      out.print('[');
+      out.print(us);
+      out.print(header & 0x80 ? GF("] > ") : GF("] < "));
+      i += TINY_GSM_AT_TRACE_HEADER;
+      for (uint8_t b = 0; b < len; b++) { printEscaped(out, at(i++)); }
+      out.println();
+    }
+  }
+
+ protected:
+  inline uint8_t at(uint16_t i) {
+    return buf[(tail + i) % TINY_GSM_AT_TRACE_SIZE];
+  }
+
+  inline void push(uint8_t c) {
+    buf[head] = c;
+    head      = (head + 1) % TINY_GSM_AT_TRACE_SIZE;
+    used++;
+  }
+
+  void makeRoom(uint16_t needed) {
+    while (TINY_GSM_AT_TRACE_SIZE - used < needed) {
+      uint16_t size = TINY_GSM_AT_TRACE_HEADER +
+                      (buf[tail] & TINY_GSM_AT_TRACE_MAX_LEN);
+      if (tail == open_pos) { open_record = false; }
+      tail = (tail + size) % TINY_GSM_AT_TRACE_SIZE;
+      used -= size;
+      records--;
+      dropped++;
+    }
+  }
+
+  static void printEscaped(Print& out, uint8_t c) {
+    if (c == '\r') {
+      out.print(GF("\\r"));
+    } else if (c == '\n') {
+      out.print(GF("\\n"));
+    } else if (c == '\\') {
+      out.print(GF("\\\\"));
+    } else if (c < 0x20 || c >= 0x7F) {
+      out.print(GF("\\x"));
+      if (c < 0x10) { out.print('0'); }
+      out.print(c, HEX);
+    } else {
+      out.print(static_cast<char>(c));
+    }
+  }
+
+  uint8_t  buf[TINY_GSM_AT_TRACE_SIZE];
+  uint16_t head          = 0;
+  uint16_t tail          = 0;
+  uint16_t used          = 0;
+  uint16_t records       = 0;
+  uint32_t dropped       = 0;
+  bool     open_record   = false;
+  bool     open_to_modem = false;
+  uint16_t open_pos      = 0;
+  uint8_t  open_len      = 0;
+  uint32_t last_us       = 0;
+};
+
+#endif  // SRC_TINYGSMATTRACE_H_
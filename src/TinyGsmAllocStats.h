@@ -0,0 +1,267 @@
+/**
+ * @file       TinyGsmAllocStats.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef SRC_TINYGSMALLOCSTATS_H_
+#define SRC_TINYGSMALLOCSTATS_H_
+
+#include "TinyGsmCommon.h"
+
+// Heap use of the library's calls, kept per call when TINY_GSM_ALLOC_STATS is
+// defined before including TinyGsmClient.h; without it none of this is
+// compiled in.  The calls that hand back a String (getIMEI(), getLocalIP(),
+// getGSMDateTime() and the like), resolve() and connect() by IP address note
+// the allocations made while they run, the bytes asked for and how far the
+// heap grew above where it stood when they began:
+//
+//   modem.getIMEI();
+//   modem.getAllocStats().printTo(SerialMon);
+//
+// Allocations are counted by wrapping the allocator.  With glibc (a Linux
+// host) that happens by itself.  Other GCC toolchains need
+// TINY_GSM_ALLOC_STATS_WRAP defined and the program linked with
+//
+//   -Wl,--wrap=malloc,--wrap=free,--wrap=realloc,--wrap=calloc
+//
+// which catches the core's String too, as it allocates through realloc().
+// Without either the calls are still counted but the heap figures stay 0.
+
+// Number of different calls tracked; calls beyond that are counted together
+// under "other"
+#if !defined(TINY_GSM_ALLOC_STATS_CALLS)
+#define TINY_GSM_ALLOC_STATS_CALLS 16
+#endif
+
+// Running totals kept by the wrapped allocator
+struct TinyGsmHeap {
+  uint32_t allocs;  // malloc, calloc and realloc calls, new included
+  uint32_t bytes;   // asked for by them
+  uint32_t in_use;  // held now, as rounded up by the allocator
+  uint32_t peak;    // most held at once since the innermost call began
+};
+
+inline TinyGsmHeap& TinyGsmHeapTotals() {
+  static TinyGsmHeap totals;
+  return totals;
+}
+
+inline void TinyGsmHeapAllocated(size_t asked, size_t held) {
+  TinyGsmHeap& heap = TinyGsmHeapTotals();
+  heap.allocs++;
+  heap.bytes += asked;
+  heap.in_use += held;
+  if (heap.in_use > heap.peak) { heap.peak = heap.in_use; }
+}
+
+inline void TinyGsmHeapFreed(size_t held) {
+  TinyGsmHeap& heap = TinyGsmHeapTotals();
+  heap.in_use -= TinyGsmMin(static_cast<uint32_t>(held), heap.in_use);
+}
+
+#if defined(__GLIBC__)
+#define TINY_GSM_ALLOC_STATS_HOOKED
+#include <malloc.h>
+
+// Weak, so every file including this can carry them
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void  __libc_free(void* ptr);
+
+__attribute__((weak)) void* malloc(size_t size) {
+  void* ptr = __libc_malloc(size);
+  if (ptr) { TinyGsmHeapAllocated(size, malloc_usable_size(ptr)); }
+  return ptr;
+}
+__attribute__((weak)) void* calloc(size_t count, size_t size) {
+  void* ptr = __libc_calloc(count, size);
+  if (ptr) { TinyGsmHeapAllocated(count * size, malloc_usable_size(ptr)); }
+  return ptr;
+}
+__attribute__((weak)) void* realloc(void* ptr, size_t size) {
+  size_t held = ptr ? malloc_usable_size(ptr) : 0;
+  void*  out  = __libc_realloc(ptr, size);
+  if (out) {
+    TinyGsmHeapFreed(held);
+    TinyGsmHeapAllocated(size, malloc_usable_size(out));
+  } else if (!size) {
+    TinyGsmHeapFreed(held);
+  }
+  return out;
+}
+__attribute__((weak)) void free(void* ptr) {
+  if (ptr) { TinyGsmHeapFreed(malloc_usable_size(ptr)); }
+  __libc_free(ptr);
+}
+}
+
+#elif defined(TINY_GSM_ALLOC_STATS_WRAP)
+#define TINY_GSM_ALLOC_STATS_HOOKED
+#if !defined(__AVR__)
+#include <malloc.h>
+#endif
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void  __real_free(void* ptr);
+
+inline size_t TinyGsmHeldSize(void* ptr) {
+#if defined(__AVR__)
+  // avr-libc keeps the size of a block just ahead of it
+  return reinterpret_cast<size_t*>(ptr)[-1];
+#else
+  return malloc_usable_size(ptr);
+#endif
+}
+
+__attribute__((weak)) void* __wrap_malloc(size_t size) {
+  void* ptr = __real_malloc(size);
+  if (ptr) { TinyGsmHeapAllocated(size, TinyGsmHeldSize(ptr)); }
+  return ptr;
+}
+__attribute__((weak)) void* __wrap_calloc(size_t count, size_t size) {
+  void* ptr = __real_calloc(count, size);
+  if (ptr) { TinyGsmHeapAllocated(count * size, TinyGsmHeldSize(ptr)); }
+  return ptr;
+}
+__attribute__((weak)) void* __wrap_realloc(void* ptr, size_t size) {
+  size_t held = ptr ? TinyGsmHeldSize(ptr) : 0;
+  void*  out  = __real_realloc(ptr, size);
+  if (out) {
+    TinyGsmHeapFreed(held);
+    TinyGsmHeapAllocated(size, TinyGsmHeldSize(out));
+  } else if (!size) {
+    TinyGsmHeapFreed(held);
+  }
+  return out;
+}
+__attribute__((weak)) void __wrap_free(void* ptr) {
+  if (ptr) { TinyGsmHeapFreed(TinyGsmHeldSize(ptr)); }
+  __real_free(ptr);
+}
+}
+#endif
+
+struct TinyGsmAllocStat {
+  GsmConstStr call;
+  uint16_t    count;
+  uint32_t    allocs;
+  uint32_t    bytes;
+  uint32_t    max_peak;  // most the heap grew during one call
+};
+
+class TinyGsmAllocStats {
+ public:
+  // Recording can be switched off at run time, e.g. while setting up
+  bool enabled = true;
+
+  // The one table every modem shares, as there is only one heap
+  static TinyGsmAllocStats& global() {
+    static TinyGsmAllocStats stats;
+    return stats;
+  }
+
+  void record(GsmConstStr call, uint32_t allocs, uint32_t bytes,
+              uint32_t peak) {
+    if (!enabled) { return; }
+    TinyGsmAllocStat* entry = findEntry(call);
+    entry->count++;
+    entry->allocs += allocs;
+    entry->bytes += bytes;
+    entry->max_peak = TinyGsmMax(entry->max_peak, peak);
+  }
+
+  uint8_t size() {
+    return used;
+  }
+  const TinyGsmAllocStat& operator[](uint8_t i) {
+    return entries[i];
+  }
+  void clear() {
+    used = 0;
+  }
+
+  // Writes one line per call: name, count, then the allocations and bytes
+  // per call and the highest peak
+  void printTo(Print& out) {
+    for (uint8_t i = 0; i < used; i++) {
+      TinyGsmAllocStat& s = entries[i];
+      out.print(s.call);
+      out.print(GF(" n="));
+      out.print(s.count);
+      out.print(GF(" allocs="));
+      out.print(s.count ? static_cast<float>(s.allocs) / s.count : 0, 1);
+      out.print(GF(" bytes="));
+      out.print(s.count ? s.bytes / s.count : 0);
+      out.print(GF(" peak="));
+      out.print(s.max_peak);
+      out.println();
+    }
+  }
+
+ protected:
+  // Calls are told apart by the address of their name, which each call site
+  // passes as a literal
+  TinyGsmAllocStat* findEntry(GsmConstStr call) {
+    for (uint8_t i = 0; i < used; i++) {
+      if (entries[i].call == call) { return &entries[i]; }
+    }
+    if (used >= TINY_GSM_ALLOC_STATS_CALLS) {
+      // Out of room; an extra entry collects the rest
+      TinyGsmAllocStat& rest = entries[TINY_GSM_ALLOC_STATS_CALLS];
+      if (used == TINY_GSM_ALLOC_STATS_CALLS) {
+        memset(&rest, 0, sizeof(rest));
+        rest.call = GF("other");
+        used++;
+      }
+      return &rest;
+    }
+    TinyGsmAllocStat& entry = entries[used++];
+    memset(&entry, 0, sizeof(entry));
+    entry.call = call;
+    return &entry;
+  }
+
+  TinyGsmAllocStat entries[TINY_GSM_ALLOC_STATS_CALLS + 1];
+  uint8_t          used = 0;
+};
+
+// Notes the heap use from its making until it goes out of scope; scopes may
+// nest, each counting what the inner ones did too
+class TinyGsmAllocScope {
+ public:
+  explicit TinyGsmAllocScope(GsmConstStr call) : call(call) {
+    TinyGsmHeap& heap = TinyGsmHeapTotals();
+    allocs            = heap.allocs;
+    bytes             = heap.bytes;
+    base              = heap.in_use;
+    outer_peak        = heap.peak;
+    heap.peak         = heap.in_use;
+  }
+  ~TinyGsmAllocScope() {
+    TinyGsmHeap& heap = TinyGsmHeapTotals();
+    TinyGsmAllocStats::global().record(call, heap.allocs - allocs,
+                                       heap.bytes - bytes,
+                                       heap.peak > base ? heap.peak - base
+                                                        : 0);
+    heap.peak = TinyGsmMax(outer_peak, heap.peak);
+  }
+
+ protected:
+  GsmConstStr call;
+  uint32_t    allocs;
+  uint32_t    bytes;
+  uint32_t    base;
+  uint32_t    outer_peak;
+};
+
+#define TINY_GSM_ALLOC_SCOPE(call) TinyGsmAllocScope tinyGsmAllocScope(GF(call))
+
+#endif  // SRC_TINYGSMALLOCSTATS_H_
@@ -14,17 +14,23 @@
 typedef TinyGsmSim800                        TinyGsm;
 typedef TinyGsmSim800::GsmClientSim800       TinyGsmClient;
 typedef TinyGsmSim800::GsmClientSecureSim800 TinyGsmClientSecure;
+typedef TinyGsmSim800::GsmUDPSim800          TinyGsmClientUDP;
+typedef TinyGsmSim800::GsmServerSim800       TinyGsmClientServer;
 
 #elif defined(TINY_GSM_MODEM_SIM808) || defined(TINY_GSM_MODEM_SIM868)
 #include "TinyGsmClientSIM808.h"
 typedef TinyGsmSim808                        TinyGsm;
 typedef TinyGsmSim808::GsmClientSim800       TinyGsmClient;
 typedef TinyGsmSim808::GsmClientSecureSim800 TinyGsmClientSecure;
+typedef TinyGsmSim808::GsmUDPSim800          TinyGsmClientUDP;
+typedef TinyGsmSim808::GsmServerSim800       TinyGsmClientServer;
 
 #elif defined(TINY_GSM_MODEM_SIM900)
 #include "TinyGsmClientSIM800.h"
 typedef TinyGsmSim800                  TinyGsm;
 typedef TinyGsmSim800::GsmClientSim800 TinyGsmClient;
+typedef TinyGsmSim800::GsmUDPSim800    TinyGsmClientUDP;
+typedef TinyGsmSim800::GsmServerSim800 TinyGsmClientServer;
 
 #elif defined(TINY_GSM_MODEM_SIM7000)
 #include "TinyGsmClientSIM7000.h"
@@ -43,6 +49,7 @@ typedef TinyGsmSim7000SSL::GsmClientSecureSIM7000SSL TinyGsmClientSecure;
 typedef TinyGsmSim7080                         TinyGsm;
 typedef TinyGsmSim7080::GsmClientSim7080       TinyGsmClient;
 typedef TinyGsmSim7080::GsmClientSecureSIM7080 TinyGsmClientSecure;
+typedef TinyGsmSim7080::GsmUDPSim7080          TinyGsmClientUDP;
 
 #elif defined(TINY_GSM_MODEM_SIM5320) || defined(TINY_GSM_MODEM_SIM5360) || \
     defined(TINY_GSM_MODEM_SIM5300) || defined(TINY_GSM_MODEM_SIM7100)
@@ -55,12 +62,15 @@ typedef TinyGsmSim5360::GsmClientSim5360 TinyGsmClient;
 #include "TinyGsmClientSIM7600.h"
 typedef TinyGsmSim7600                   TinyGsm;
 typedef TinyGsmSim7600::GsmClientSim7600 TinyGsmClient;
+typedef TinyGsmSim7600::GsmUDPSim7600    TinyGsmClientUDP;
 
 #elif defined(TINY_GSM_MODEM_UBLOX)
 #include "TinyGsmClientUBLOX.h"
 typedef TinyGsmUBLOX                       TinyGsm;
 typedef TinyGsmUBLOX::GsmClientUBLOX       TinyGsmClient;
 typedef TinyGsmUBLOX::GsmClientSecureUBLOX TinyGsmClientSecure;
+typedef TinyGsmUBLOX::GsmUDPUBLOX          TinyGsmClientUDP;
+typedef TinyGsmUBLOX::GsmServerUBLOX       TinyGsmClientServer;
 
 #elif defined(TINY_GSM_MODEM_SARAR4)
 #include "TinyGsmClientSaraR4.h"
@@ -77,6 +87,8 @@ typedef TinyGsmM95::GsmClientM95 TinyGsmClient;
 #include "TinyGsmClientBG96.h"
 typedef TinyGsmBG96                TinyGsm;
 typedef TinyGsmBG96::GsmClientBG96 TinyGsmClient;
+typedef TinyGsmBG96::GsmUDPBG96    TinyGsmClientUDP;
+typedef TinyGsmBG96::GsmServerBG96 TinyGsmClientServer;
 
 #elif defined(TINY_GSM_MODEM_A6) || defined(TINY_GSM_MODEM_A7)
 #include "TinyGsmClientA6.h"
@@ -99,6 +111,7 @@ typedef TinyGsmMC60::GsmClientMC60 TinyGsmClient;
 typedef TinyGsmESP8266                         TinyGsm;
 typedef TinyGsmESP8266::GsmClientESP8266       TinyGsmClient;
 typedef TinyGsmESP8266::GsmClientSecureESP8266 TinyGsmClientSecure;
+typedef TinyGsmESP8266::GsmServerESP8266       TinyGsmClientServer;
 
 #elif defined(TINY_GSM_MODEM_XBEE)
 #define TINY_GSM_MODEM_HAS_WIFI
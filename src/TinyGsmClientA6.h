@@ -71,9 +71,12 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
     }
 
     bool init(TinyGsmA6* modem, uint8_t = 0) {
-      this->at       = modem;
-      this->mux      = -1;
-      sock_connected = false;
+      this->at        = modem;
+      this->mux       = -1;
+      prev_check      = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
 
       return true;
     }
@@ -121,7 +124,7 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
    * Constructor
    */
  public:
-  explicit TinyGsmA6(Stream& stream) : stream(stream) {
+  explicit TinyGsmA6(Stream& stream) : stream(tapStream(stream)) {
     memset(sockets, 0, sizeof(sockets));
   }
 
@@ -151,7 +154,7 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
         GF("+CMER=3,0,0,2"));  // Set unsolicited result code output destination
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     SimStatus ret = getSimStatus();
     // if the sim isn't ready and a pin has been provided, try to unlock the sim
@@ -208,14 +211,9 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
     return (s == REG_OK_HOME || s == REG_OK_ROAMING);
   }
 
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+CIFSR"));
-    String res;
-    if (waitResponse(10000L, res) != 1) { return ""; }
-    res.replace(GSM_NL "OK" GSM_NL, "");
-    res.replace(GSM_NL, "");
-    res.trim();
-    return res;
+    return waitResponseText(10000L, buf, len);
   }
 
   /*
@@ -261,29 +259,28 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
     return false;
   }
 
-  String getOperatorImpl() {
+  size_t getOperatorImpl(char* buf, size_t len) {
     sendAT(GF("+COPS=3,0"));  // Set format
     waitResponse();
 
     sendAT(GF("+COPS?"));
-    if (waitResponse(GF(GSM_NL "+COPS:")) != 1) { return ""; }
+    if (waitResponse(GF(GSM_NL "+COPS:")) != 1) { return 0; }
     streamSkipUntil('"');  // Skip mode and format
-    String res = stream.readStringUntil('"');
+    size_t n = streamGetStringBefore('"', buf, len);
     waitResponse();
-    return res;
+    return n;
   }
 
   /*
    * SIM card functions
    */
  protected:
-  String getSimCCIDImpl() {
+  size_t getSimCCIDImpl(char* buf, size_t len) {
     sendAT(GF("+CCID"));
-    if (waitResponse(GF(GSM_NL "+SCID: SIM Card ID:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(GF(GSM_NL "+SCID: SIM Card ID:")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -355,25 +352,25 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
    * Messaging functions
    */
  protected:
-  String sendUSSDImpl(const String& code) {
+  size_t sendUSSDImpl(const char* code, char* buf, size_t len) {
     sendAT(GF("+CMGF=1"));
     waitResponse();
     sendAT(GF("+CSCS=\"HEX\""));
     waitResponse();
     sendAT(GF("+CUSD=1,\""), code, GF("\",15"));
-    if (waitResponse(10000L) != 1) { return ""; }
-    if (waitResponse(GF(GSM_NL "+CUSD:")) != 1) { return ""; }
+    if (waitResponse(10000L) != 1) { return 0; }
+    if (waitResponse(GF(GSM_NL "+CUSD:")) != 1) { return 0; }
     streamSkipUntil('"');
-    String hex = stream.readStringUntil('"');
+    size_t n = streamGetStringBefore('"', buf, len);
     streamSkipUntil(',');
     int8_t dcs = streamGetIntBefore('\n');
 
     if (dcs == 15) {
-      return TinyGsmDecodeHex7bit(hex);
+      return TinyGsmDecodeHex7bit(buf);
     } else if (dcs == 72) {
-      return TinyGsmDecodeHex16bit(hex);
+      return TinyGsmDecodeHex16bit(buf, len);
     } else {
-      return hex;
+      return n;
     }
   }
 
@@ -479,7 +476,7 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -505,6 +502,8 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF("+CIPRCV:"))) {
           int8_t  mux      = streamGetIntBefore(',');
           int16_t len      = streamGetIntBefore(',');
@@ -534,7 +533,8 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -553,8 +553,7 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
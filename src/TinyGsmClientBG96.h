@@ -14,16 +14,24 @@
 
 #define TINY_GSM_MUX_COUNT 12
 #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+// Incoming data is reliably announced with +QIURC: "recv", so the fallback
+// check for unannounced data can start out slower
+#if !defined(TINY_GSM_DATA_CHECK_MS)
+#define TINY_GSM_DATA_CHECK_MS 2000
+#endif
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmCalling.tpp"
+#include "TinyGsmDNS.tpp"
 #include "TinyGsmGPRS.tpp"
 #include "TinyGsmGPS.tpp"
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSMS.tpp"
+#include "TinyGsmServer.tpp"
 #include "TinyGsmTCP.tpp"
 #include "TinyGsmTemperature.tpp"
 #include "TinyGsmTime.tpp"
+#include "TinyGsmUDP.tpp"
 #include "TinyGsmNTP.tpp"
 
 #define GSM_NL "\r\n"
@@ -47,6 +55,9 @@ enum RegStatus {
 class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
                     public TinyGsmGPRS<TinyGsmBG96>,
                     public TinyGsmTCP<TinyGsmBG96, TINY_GSM_MUX_COUNT>,
+                    public TinyGsmUDP<TinyGsmBG96, TINY_GSM_MUX_COUNT>,
+                    public TinyGsmServer<TinyGsmBG96, TINY_GSM_MUX_COUNT>,
+                    public TinyGsmDNS<TinyGsmBG96>,
                     public TinyGsmCalling<TinyGsmBG96>,
                     public TinyGsmSMS<TinyGsmBG96>,
                     public TinyGsmTime<TinyGsmBG96>,
@@ -57,6 +68,9 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
   friend class TinyGsmModem<TinyGsmBG96>;
   friend class TinyGsmGPRS<TinyGsmBG96>;
   friend class TinyGsmTCP<TinyGsmBG96, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmUDP<TinyGsmBG96, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmServer<TinyGsmBG96, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmDNS<TinyGsmBG96>;
   friend class TinyGsmCalling<TinyGsmBG96>;
   friend class TinyGsmSMS<TinyGsmBG96>;
   friend class TinyGsmTime<TinyGsmBG96>;
@@ -80,11 +94,14 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
     }
 
     bool init(TinyGsmBG96* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_available = 0;
-      prev_check     = 0;
-      sock_connected = false;
-      got_data       = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      check_backoff   = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
+      got_data        = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -106,11 +123,27 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
     }
     TINY_GSM_CLIENT_CONNECT_OVERRIDES
 
+    // The modem reports the result with a +QIOPEN URC, so several sockets
+    // can be opening at once
+    int connectAsync(const char* host, uint16_t port) override {
+      return connectAsync(host, port, 150);
+    }
+    int connectAsync(const char* host, uint16_t port, int timeout_s) {
+      stop();
+      TINY_GSM_YIELD();
+      rx.clear();
+      connect_start      = millis();
+      connect_timeout_ms = ((uint32_t)timeout_s) * 1000;
+      sock_connecting    = at->modemConnectStart(host, port, mux);
+      return sock_connecting;
+    }
+
     void stop(uint32_t maxWaitMs) {
       uint32_t startMillis = millis();
       dumpModemBuffer(maxWaitMs);
       at->sendAT(GF("+QICLOSE="), mux);
-      sock_connected = false;
+      sock_connected  = false;
+      sock_connecting = false;
       at->waitResponse((maxWaitMs - (millis() - startMillis)));
     }
     void stop() override {
@@ -151,11 +184,23 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
   };
   */
 
+  /*
+   * Inner UDP Client
+   */
+ public:
+  typedef GsmUDP<GsmClientBG96> GsmUDPBG96;
+
+  /*
+   * Inner Server
+   */
+ public:
+  typedef GsmServer<GsmClientBG96> GsmServerBG96;
+
   /*
    * Constructor
    */
  public:
-  explicit TinyGsmBG96(Stream& stream) : stream(stream) {
+  explicit TinyGsmBG96(Stream& stream) : stream(tapStream(stream)) {
     memset(sockets, 0, sizeof(sockets));
   }
 
@@ -179,7 +224,7 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     // Disable time and time zone URC's
     sendAT(GF("+CTZR=0"));
@@ -287,17 +332,44 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
     return true;
   }
 
+#if TINY_GSM_COMMAND_QUEUE_SIZE > 0
+  // For sockets reconnecting on their own; the context is all that needs to
+  // come back, its settings are kept
+  bool queueDataCheck() {
+    return sendATAsync(GF("+QIACT?"), dataActive, this);
+  }
+  static void dataActive(int8_t result, String& data, void* arg) {
+    TinyGsmBG96* modem = static_cast<TinyGsmBG96*>(arg);
+    bool         up = result == 1 && data.indexOf(GF("+QIACT: 1,1")) >= 0;
+    modem->restoreState = up ? RESTORE_UP : RESTORE_DOWN;
+  }
+  // The context settings go first, for a gprsConnectAsync() with new ones
+  bool queueDataResume() {
+    if (TINY_GSM_COMMAND_QUEUE_SIZE - commandsPending() < 2) { return false; }
+    void*  gprs = static_cast<TinyGsmGPRS<TinyGsmBG96>*>(this);
+    String csgp(GF("+QICSGP=1,1,\""));
+    csgp += gprsApn();
+    csgp += GF("\",\"");
+    csgp += gprsUser();
+    csgp += GF("\",\"");
+    csgp += gprsPwd();
+    csgp += '"';
+    sendATAsync(csgp, dataStepDone, gprs);
+    sendATAsync(GF("+QIACT=1"), dataResumed, gprs, 150000L);
+    return true;
+  }
+#endif
+
   /*
    * SIM card functions
    */
  protected:
-  String getSimCCIDImpl() {
+  size_t getSimCCIDImpl(char* buf, size_t len) {
     sendAT(GF("+QCCID"));
-    if (waitResponse(GF(GSM_NL "+QCCID:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(GF(GSM_NL "+QCCID:")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -339,13 +411,12 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
   }
 
   // get the RAW GPS output
-  String getGPSrawImpl() {
+  size_t getGPSrawImpl(char* buf, size_t len) {
     sendAT(GF("+QGPSLOC=2"));
-    if (waitResponse(10000L, GF(GSM_NL "+QGPSLOC:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(10000L, GF(GSM_NL "+QGPSLOC:")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   // get GPS informations
@@ -419,22 +490,23 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
    * Time functions
    */
  protected:
-  String getGSMDateTimeImpl(TinyGSMDateTimeFormat format) {
+  size_t getGSMDateTimeImpl(TinyGSMDateTimeFormat format, char* buf,
+                            size_t len) {
     sendAT(GF("+QLTS=2"));
-    if (waitResponse(2000L, GF("+QLTS: \"")) != 1) { return ""; }
+    if (waitResponse(2000L, GF("+QLTS: \"")) != 1) { return 0; }
 
-    String res;
+    size_t n = 0;
 
     switch (format) {
-      case DATE_FULL: res = stream.readStringUntil('"'); break;
+      case DATE_FULL: n = streamGetStringBefore('"', buf, len); break;
       case DATE_TIME:
         streamSkipUntil(',');
-        res = stream.readStringUntil('"');
+        n = streamGetStringBefore('"', buf, len);
         break;
-      case DATE_DATE: res = stream.readStringUntil(','); break;
+      case DATE_DATE: n = streamGetStringBefore(',', buf, len); break;
     }
     waitResponse();  // Ends with OK
-    return res;
+    return n;
   }
 
   // The BG96 returns UTC time instead of local time as other modules do in
@@ -489,10 +561,9 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
     // AT+QNTP=<contextID>,<server>[,<port>][,<autosettime>]
     sendAT(GF("+QNTP=1,\""), server, '"');
     if (waitResponse(10000L, GF("+QNTP:"))) {
-      String result = stream.readStringUntil(',');
+      int16_t result = streamGetIntBefore(',');
       streamSkipUntil('\n');
-      result.trim();
-      if (TinyGsmIsValidNumber(result)) { return result.toInt(); }
+      if (result != -9999) { return result; }
     } else {
       return -1;
     }
@@ -525,28 +596,171 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
     return res;
   }
 
+  /*
+   * DNS functions
+   */
+ protected:
+  bool dnsResolveImpl(const char* host, IPAddress& ip, uint32_t& ttl_ms) {
+    sendAT(GF("+QIDNSGIP=1,\""), host, GF("\""));
+    if (waitResponse() != 1) { return false; }
+    // +QIURC: "dnsgip",<err>,<IP_count>,<DNS_ttl>
+    // +QIURC: "dnsgip","<hostIPaddr>"  (once per address)
+    bool     header      = true;
+    uint32_t startMillis = millis();
+    while (millis() - startMillis < 60000L) {
+      // Matched here rather than in waitResponse() so the generic +QIURC
+      // handling doesn't throw the answer away
+      if (waitResponse(60000L - (millis() - startMillis),
+                       GF(GSM_NL "+QIURC:")) != 1) {
+        return false;
+      }
+      char urc[12];
+      streamSkipUntil('\"');
+      streamGetStringBefore('\"', urc, sizeof(urc));
+      streamSkipUntil(',');
+      if (strcmp(urc, "dnsgip")) {
+        handleQIURC(urc);
+        continue;
+      }
+      if (header) {
+        if (streamGetIntBefore(',') != 0) {
+          streamSkipUntil('\n');
+          return false;
+        }
+        streamSkipUntil(',');  // Skip the number of addresses
+        char ttl[12];
+        streamGetStringBefore('\n', ttl, sizeof(ttl));
+        int32_t ttl_s = atol(ttl);
+        if (ttl_s > 0 && (uint32_t)ttl_s < ttl_ms / 1000) {
+          ttl_ms = ttl_s * 1000;
+        }
+        header = false;
+        continue;
+      }
+      streamSkipUntil('\"');
+      ip = streamGetIpBefore('\"');
+      streamSkipUntil('\n');
+      return ip != IPAddress(0, 0, 0, 0);
+    }
+    return false;
+  }
+
   /*
    * Client related functions
    */
  protected:
+  bool setKeepAliveImpl(bool enable, uint16_t idle_s, uint16_t interval_s,
+                        uint8_t count) {
+    // AT+QICFG="tcp/keepalive",<enable>,<idle>(1-120 min),<interval>(25-100 s),
+    // <count>(3-10)
+    if (!enable) {
+      sendAT(GF("+QICFG=\"tcp/keepalive\",0"));
+      return waitResponse() == 1;
+    }
+    uint16_t idle_min = idle_s / 60;
+    sendAT(GF("+QICFG=\"tcp/keepalive\",1,"),
+           TinyGsmMax(TinyGsmMin(idle_min, (uint16_t)120), (uint16_t)1), ',',
+           TinyGsmMax(TinyGsmMin(interval_s, (uint16_t)100), (uint16_t)25),
+           ',', TinyGsmMax(TinyGsmMin(count, (uint8_t)10), (uint8_t)3));
+    return waitResponse() == 1;
+  }
+
   bool modemConnect(const char* host, uint16_t port, uint8_t mux,
                     bool ssl = false, int timeout_s = 150) {
     if (ssl) { DBG("SSL not yet supported on this module!"); }
 
     uint32_t timeout_ms = ((uint32_t)timeout_s) * 1000;
 
+    modemConnectStart(host, port, mux);
+    return modemConnectWait(mux, timeout_ms);
+  }
+
+  // Waits for the +QIOPEN URC with the result for mux
+  bool modemConnectWait(uint8_t mux, uint32_t timeout_ms) {
+    uint32_t startMillis = millis();
+    while (millis() - startMillis < timeout_ms) {
+      if (waitResponse(timeout_ms - (millis() - startMillis),
+                       GF(GSM_NL "+QIOPEN:")) != 1) {
+        return false;
+      }
+      int8_t  opened = streamGetIntBefore(',');
+      int16_t err    = streamGetIntBefore('\n');
+      // Read status
+      if (opened == mux) { return (0 == err); }
+      // The result for a socket opened by connectAsync()
+      modemConnectResult(opened, err);
+    }
+    return false;
+  }
+
+  // Sends +QIOPEN and leaves the +QIOPEN URC to waitResponse()
+  bool modemConnectStart(const char* host, uint16_t port, uint8_t mux) {
+    char        ip[16];
+    const char* target = dnsConnectHost(host, ip);
     // <PDPcontextID>(1-16), <connectID>(0-11),
     // "TCP/UDP/TCP LISTENER/UDPSERVICE", "<IP_address>/<domain_name>",
     // <remote_port>,<local_port>,<access_mode>(0-2; 0=buffer)
-    sendAT(GF("+QIOPEN=1,"), mux, GF(",\""), GF("TCP"), GF("\",\""), host,
+    sendAT(GF("+QIOPEN=1,"), mux, GF(",\""), GF("TCP"), GF("\",\""), target,
            GF("\","), port, GF(",0,0"));
-    waitResponse();
+    return waitResponse() == 1;
+  }
+
+  void modemConnectResult(int8_t mux, int16_t err) {
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->sock_connecting = false;
+      sockets[mux]->sock_connected  = (0 == err);
+    }
+  }
 
-    if (waitResponse(timeout_ms, GF(GSM_NL "+QIOPEN:")) != 1) { return false; }
+  // Without a host the socket is a "UDP SERVICE" one with no fixed remote end,
+  // and every datagram is addressed with +QISEND
+  bool modemOpenUDP(const char* host, uint16_t port, uint8_t* mux,
+                    uint16_t localPort) {
+    if (host) {
+      char ip[16];
+      sendAT(GF("+QIOPEN=1,"), *mux, GF(",\"UDP\",\""),
+             dnsConnectHost(host, ip), GF("\","), port, ',', localPort,
+             GF(",0"));
+    } else {
+      sendAT(GF("+QIOPEN=1,"), *mux, GF(",\"UDP SERVICE\",\"127.0.0.1\",0,"),
+             localPort, GF(",0"));
+    }
+    if (waitResponse() != 1) { return false; }
+    return modemConnectWait(*mux, 150000L);
+  }
+
+  // The listener takes a socket of its own, the highest one no client is
+  // using.  Incoming connections are reported with +QIURC: "incoming".
+  bool modemListen(uint16_t port) {
+    serverMux = -1;
+    for (int8_t mux = TINY_GSM_MUX_COUNT - 1; mux >= 0; mux--) {
+      if (!sockets[mux]) {
+        serverMux = mux;
+        break;
+      }
+    }
+    if (serverMux < 0) { return false; }
+    sendAT(GF("+QIOPEN=1,"), serverMux,
+           GF(",\"TCP LISTENER\",\"127.0.0.1\",0,"), port, GF(",0"));
+    if (waitResponse() != 1) { return false; }
+    return modemConnectWait(serverMux, 150000L);
+  }
 
-    if (streamGetIntBefore(',') != mux) { return false; }
-    // Read status
-    return (0 == streamGetIntBefore('\n'));
+  void modemStopListening() {
+    sendAT(GF("+QICLOSE="), serverMux);
+    waitResponse(10000L);
+  }
+
+  int16_t modemSendTo(const void* buff, size_t len, uint8_t mux,
+                      const char* host, uint16_t port) {
+    char ip[16];
+    sendAT(GF("+QISEND="), mux, ',', (uint16_t)len, GF(",\""),
+           dnsConnectHost(host, ip), GF("\","), port);
+    if (waitResponse(GF(">")) != 1) { return 0; }
+    stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+    stream.flush();
+    if (waitResponse(GF(GSM_NL "SEND OK")) != 1) { return 0; }
+    return len;
   }
 
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
@@ -563,16 +777,54 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
     if (!sockets[mux]) return 0;
     sendAT(GF("+QIRD="), mux, ',', (uint16_t)size);
     if (waitResponse(GF("+QIRD:")) != 1) { return 0; }
-    int16_t len = streamGetIntBefore('\n');
+    // +QIRD: <len> or, on a "UDP SERVICE" socket,
+    // +QIRD: <len>,"<remote IP>",<remote port>
+    // The address only follows when there is data, so for a datagram the
+    // line is read whole before it is parsed
+    IPAddress ip(0, 0, 0, 0);
+    uint16_t  port = 0;
+    int16_t   len;
+    if (sockets[mux]->isDatagram()) {
+      char header[64];
+      streamGetStringBefore('\n', header, sizeof(header));
+      len               = atoi(header);
+      const char* quote = strchr(header, '"');
+      if (quote) {
+        // Both stop at the first character not part of them
+        ip   = TinyGsmIpFromString(quote + 1);
+        port = atoi(strrchr(header, ',') + 1);
+      }
+    } else {
+      len = streamGetIntBefore('\n');
+    }
+    if (len < 0) { len = 0; }
 
     for (int i = 0; i < len; i++) { moveCharFromStreamToFifo(mux); }
+    if (sockets[mux]->isDatagram()) {
+      sockets[mux]->datagramReceived(len, ip, port);
+    }
     waitResponse();
     // DBG("### READ:", len, "from", mux);
     sockets[mux]->sock_available = modemGetAvailable(mux);
     return len;
   }
 
-  size_t modemGetAvailable(uint8_t mux) {
+  // Asks how much data is waiting on each flagged socket, but leaves the
+  // state check for the end because +QISTATE reports on every socket at once
+  void modemCheckAvailable() {
+    int8_t check_mux = -1;
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      GsmClientBG96* sock = sockets[mux];
+      if (sock && sock->got_data) {
+        sock->got_data       = false;
+        sock->sock_available = modemGetAvailable(mux, false);
+        if (!sock->sock_available) { check_mux = mux; }
+      }
+    }
+    if (check_mux >= 0) { modemGetConnected(check_mux); }
+  }
+
+  size_t modemGetAvailable(uint8_t mux, bool check_state = true) {
     if (!sockets[mux]) return 0;
     sendAT(GF("+QIRD="), mux, GF(",0"));
     size_t result = 0;
@@ -583,34 +835,92 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
       if (result) { DBG("### DATA AVAILABLE:", result, "on", mux); }
       waitResponse();
     }
-    if (!result) { sockets[mux]->sock_connected = modemGetConnected(mux); }
+    if (!result && check_state) {
+      sockets[mux]->sock_connected = modemGetConnected(mux);
+    }
     return result;
   }
 
   bool modemGetConnected(uint8_t mux) {
-    sendAT(GF("+QISTATE=1,"), mux);
+    // Read the status of all sockets at once
+    // Without a connect ID +QISTATE lists every socket that has been opened;
+    // any socket that isn't listed is closed
     // +QISTATE: 0,"TCP","151.139.237.11",80,5087,4,1,0,0,"uart1"
-
-    if (waitResponse(GF("+QISTATE:")) != 1) { return false; }
-
-    streamSkipUntil(',');                  // Skip mux
-    streamSkipUntil(',');                  // Skip socket type
-    streamSkipUntil(',');                  // Skip remote ip
-    streamSkipUntil(',');                  // Skip remote port
-    streamSkipUntil(',');                  // Skip local port
-    int8_t res = streamGetIntBefore(',');  // socket state
-
-    waitResponse();
-
-    // 0 Initial, 1 Opening, 2 Connected, 3 Listening, 4 Closing
-    return 2 == res;
+    bool listed[TINY_GSM_MUX_COUNT] = {};
+    sendAT(GF("+QISTATE"));
+    int8_t res = 0;
+    for (int muxNo = 0; muxNo <= TINY_GSM_MUX_COUNT; muxNo++) {
+      // after the last socket there's an OK, so we catch it right away
+      res = waitResponse(GF("+QISTATE:"), GFP(GSM_OK), GFP(GSM_ERROR));
+      if (res != 1) { break; }
+      int8_t ret_mux = streamGetIntBefore(',');
+      streamSkipUntil(',');                    // Skip socket type
+      streamSkipUntil(',');                    // Skip remote ip
+      streamSkipUntil(',');                    // Skip remote port
+      streamSkipUntil(',');                    // Skip local port
+      int8_t state = streamGetIntBefore(',');  // socket state
+      streamSkipUntil('\n');
+      // 0 Initial, 1 Opening, 2 Connected, 3 Listening, 4 Closing
+      if (ret_mux >= 0 && ret_mux < TINY_GSM_MUX_COUNT) {
+        listed[ret_mux] = true;
+        if (sockets[ret_mux]) {
+          sockets[ret_mux]->sock_connected = (2 == state || 3 == state);
+        }
+      }
+    }
+    // only trust the absence of a socket if the whole list was read
+    if (res == 2) {
+      for (int muxNo = 0; muxNo < TINY_GSM_MUX_COUNT; muxNo++) {
+        if (!listed[muxNo] && sockets[muxNo]) {
+          sockets[muxNo]->sock_connected = false;
+        }
+      }
+    }
+    if (!sockets[mux]) { return false; }
+    return sockets[mux]->sock_connected;
   }
 
+
   /*
    * Utilities
    */
  public:
   // TODO(vshymanskyy): Optimize this!
+  // Acts on a +QIURC, read up to the comma after its name.  Used by
+  // waitResponse() and by anything else reading +QIURC's itself, so none of
+  // them is lost.
+  void handleQIURC(const char* urc) {
+    if (!strcmp(urc, "recv")) {
+      int8_t mux = streamGetIntBefore('\n');
+      DBG("### URC RECV:", mux);
+      if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+        sockets[mux]->got_data = true;
+      }
+    } else if (!strcmp(urc, "incoming")) {
+      // +QIURC: "incoming",<connectID>,<serverID>,"<ip>",<port>
+      int8_t mux = streamGetIntBefore(',');
+      streamSkipUntil('\"');
+      IPAddress ip = streamGetIpBefore('\"');
+      streamSkipUntil('\n');
+      serverIncoming(mux, ip);
+    } else if (!strcmp(urc, "closed")) {
+      int8_t mux = streamGetIntBefore('\n');
+      DBG("### URC CLOSE:", mux);
+      if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+        sockets[mux]->sock_connected = false;
+      }
+    } else if (!strcmp(urc, "pdpdeact")) {
+      // +QIURC: "pdpdeact",<contextID>; every socket went down with it
+      streamSkipUntil('\n');
+      DBG("### URC PDP DEACT");
+      for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+        if (sockets[mux]) { sockets[mux]->sock_connected = false; }
+      }
+    } else {
+      streamSkipUntil('\n');
+    }
+  }
+
   int8_t waitResponse(uint32_t timeout_ms, String& data,
                       GsmConstStr r1 = GFP(GSM_OK),
                       GsmConstStr r2 = GFP(GSM_ERROR),
@@ -631,7 +941,7 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -657,31 +967,27 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF(GSM_NL "+QIURC:"))) {
+          char urc[12];
           streamSkipUntil('\"');
-          String urc = stream.readStringUntil('\"');
+          streamGetStringBefore('\"', urc, sizeof(urc));
           streamSkipUntil(',');
-          if (urc == "recv") {
-            int8_t mux = streamGetIntBefore('\n');
-            DBG("### URC RECV:", mux);
-            if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-              sockets[mux]->got_data = true;
-            }
-          } else if (urc == "closed") {
-            int8_t mux = streamGetIntBefore('\n');
-            DBG("### URC CLOSE:", mux);
-            if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-              sockets[mux]->sock_connected = false;
-            }
-          } else {
-            streamSkipUntil('\n');
-          }
+          handleQIURC(urc);
+          data = "";
+        } else if (data.endsWith(GF(GSM_NL "+QIOPEN:"))) {
+          int8_t  mux = streamGetIntBefore(',');
+          int16_t err = streamGetIntBefore('\n');
+          DBG("### URC OPEN:", mux, err);
+          modemConnectResult(mux, err);
           data = "";
         }
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -700,8 +1006,7 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
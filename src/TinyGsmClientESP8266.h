@@ -17,6 +17,7 @@
 
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSSL.tpp"
+#include "TinyGsmServer.tpp"
 #include "TinyGsmTCP.tpp"
 #include "TinyGsmWifi.tpp"
 
@@ -41,10 +42,12 @@ enum RegStatus {
 class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
                        public TinyGsmWifi<TinyGsmESP8266>,
                        public TinyGsmTCP<TinyGsmESP8266, TINY_GSM_MUX_COUNT>,
+                       public TinyGsmServer<TinyGsmESP8266, TINY_GSM_MUX_COUNT>,
                        public TinyGsmSSL<TinyGsmESP8266> {
   friend class TinyGsmModem<TinyGsmESP8266>;
   friend class TinyGsmWifi<TinyGsmESP8266>;
   friend class TinyGsmTCP<TinyGsmESP8266, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmServer<TinyGsmESP8266, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmSSL<TinyGsmESP8266>;
 
   /*
@@ -62,8 +65,11 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
     }
 
     bool init(TinyGsmESP8266* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_connected = false;
+      this->at        = modem;
+      prev_check      = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -125,11 +131,17 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
     TINY_GSM_CLIENT_CONNECT_OVERRIDES
   };
 
+  /*
+   * Inner Server
+   */
+ public:
+  typedef GsmServer<GsmClientESP8266> GsmServerESP8266;
+
   /*
    * Constructor
    */
  public:
-  explicit TinyGsmESP8266(Stream& stream) : stream(stream) {
+  explicit TinyGsmESP8266(Stream& stream) : stream(tapStream(stream)) {
     memset(sockets, 0, sizeof(sockets));
   }
 
@@ -155,12 +167,12 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
                                     // for some firmware variants if needed
       if (waitResponse() != 1) { return false; }
     }
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
     return true;
   }
 
-  String getModemNameImpl() {
-    return "ESP8266";
+  size_t getModemNameImpl(char* buf, size_t len) {
+    return TinyGsmCopyString(buf, len, "ESP8266");
   }
 
   void setBaudImpl(uint32_t baud) {
@@ -181,14 +193,9 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
     return waitResponse() == 1;
   }
 
-  String getModemInfoImpl() {
+  size_t getModemInfoImpl(char* buf, size_t len) {
     sendAT(GF("+GMR"));
-    String res;
-    if (waitResponse(1000L, res) != 1) { return ""; }
-    res.replace(GSM_NL "OK" GSM_NL, "");
-    res.replace(GSM_NL, " ");
-    res.trim();
-    return res;
+    return waitResponseText(1000L, buf, len);
   }
 
   /*
@@ -258,7 +265,8 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
       return true;
     } else if (s == REG_OK_NO_TCP) {
       // with this, we may or may not be connected
-      if (getLocalIP() == "") {
+      char ip[32];
+      if (!getLocalIP(ip, sizeof(ip))) {
         return false;
       } else {
         return true;
@@ -268,21 +276,27 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
     }
   }
 
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     // attempt with and without 'current' flag
     sendAT(GF("+CIPSTA?"));
     int8_t res1 = waitResponse(GF("ERROR"), GF("+CIPSTA:"));
     if (res1 != 2) {
       sendAT(GF("+CIPSTA_CUR?"));
       res1 = waitResponse(GF("ERROR"), GF("+CIPSTA_CUR:"));
-      if (res1 != 2) { return ""; }
+      if (res1 != 2) { return 0; }
     }
-    String res2 = stream.readStringUntil('\n');
-    res2.replace("ip:", "");  // newer firmwares have this
-    res2.replace("\"", "");
-    res2.trim();
+    streamGetStringBefore('\n', buf, len);
+    size_t n = 0;
+    for (char* in = buf; *in; in++) {
+      if (!strncmp(in, "ip:", 3)) {  // newer firmwares have this
+        in += 2;
+      } else if (*in != '"') {
+        buf[n++] = *in;
+      }
+    }
+    buf[n] = '\0';
     waitResponse();
-    return res2;
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -325,13 +339,29 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
            GF("\",\""), host, GF("\","), port, GF(","),
            TINY_GSM_TCP_KEEP_ALIVE);
     // TODO(?): Check mux
-    int8_t rsp = waitResponse(timeout_ms, GFP(GSM_OK), GFP(GSM_ERROR),
-                              GF("ALREADY CONNECT"));
+    // "<mux>,CONNECT" comes before the OK and must not be taken for an
+    // incoming connection
+    connectingMux = mux;
+    int8_t rsp    = waitResponse(timeout_ms, GFP(GSM_OK), GFP(GSM_ERROR),
+                                 GF("ALREADY CONNECT"));
+    connectingMux = -1;
     // if (rsp == 3) waitResponse();
     // May return "ERROR" after the "ALREADY CONNECT"
     return (1 == rsp);
   }
 
+  // Incoming connections are reported as "<mux>,CONNECT", without the
+  // address they came from
+  bool modemListen(uint16_t port) {
+    sendAT(GF("+CIPSERVER=1,"), port);
+    return waitResponse() == 1;
+  }
+
+  void modemStopListening() {
+    sendAT(GF("+CIPSERVER=0"));
+    waitResponse();
+  }
+
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
     sendAT(GF("+CIPSEND="), mux, ',', (uint16_t)len);
     if (waitResponse(GF(">")) != 1) { return 0; }
@@ -397,7 +427,7 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -437,6 +467,14 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
             }
           }
           data = "";
+        } else if (data.endsWith(GF(",CONNECT" GSM_NL))) {
+          int8_t muxStart =
+              TinyGsmMax(0, data.lastIndexOf(GSM_NL, data.length() - 11));
+          int8_t mux = data.substring(muxStart).toInt();
+          if (mux != connectingMux) {
+            serverIncoming(mux, IPAddress(0, 0, 0, 0));
+          }
+          data = "";
         } else if (data.endsWith(GF("CLOSED"))) {
           int8_t muxStart =
               TinyGsmMax(0, data.lastIndexOf(GSM_NL, data.length() - 8));
@@ -451,7 +489,8 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -464,8 +503,7 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
   int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
                       GsmConstStr r2 = GFP(GSM_ERROR), GsmConstStr r3 = NULL,
                       GsmConstStr r4 = NULL, GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
@@ -479,7 +517,8 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
 
  protected:
   GsmClientESP8266* sockets[TINY_GSM_MUX_COUNT];
-  const char*       gsmNL = GSM_NL;
+  int8_t            connectingMux = -1;
+  const char*       gsmNL         = GSM_NL;
 };
 
 #endif  // SRC_TINYGSMCLIENTESP8266_H_
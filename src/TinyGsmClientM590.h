@@ -15,6 +15,7 @@
 #define TINY_GSM_MUX_COUNT 2
 #define TINY_GSM_NO_MODEM_BUFFER
 
+#include "TinyGsmDNS.tpp"
 #include "TinyGsmGPRS.tpp"
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSMS.tpp"
@@ -42,11 +43,13 @@ enum RegStatus {
 class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
                     public TinyGsmGPRS<TinyGsmM590>,
                     public TinyGsmTCP<TinyGsmM590, TINY_GSM_MUX_COUNT>,
+                    public TinyGsmDNS<TinyGsmM590>,
                     public TinyGsmSMS<TinyGsmM590>,
                     public TinyGsmTime<TinyGsmM590> {
   friend class TinyGsmModem<TinyGsmM590>;
   friend class TinyGsmGPRS<TinyGsmM590>;
   friend class TinyGsmTCP<TinyGsmM590, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmDNS<TinyGsmM590>;
   friend class TinyGsmSMS<TinyGsmM590>;
   friend class TinyGsmTime<TinyGsmM590>;
 
@@ -65,8 +68,11 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
     }
 
     bool init(TinyGsmM590* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_connected = false;
+      this->at        = modem;
+      prev_check      = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -110,7 +116,7 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
    * Constructor
    */
  public:
-  explicit TinyGsmM590(Stream& stream) : stream(stream) {
+  explicit TinyGsmM590(Stream& stream) : stream(tapStream(stream)) {
     memset(sockets, 0, sizeof(sockets));
   }
 
@@ -134,7 +140,7 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     SimStatus ret = getSimStatus();
     // if the sim isn't ready and a pin has been provided, try to unlock the sim
@@ -149,8 +155,8 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
   }
 
   // Doesn't support CGMI
-  String getModemNameImpl() {
-    return "Neoway M590";
+  size_t getModemNameImpl(char* buf, size_t len) {
+    return TinyGsmCopyString(buf, len, "Neoway M590");
   }
 
   // Extra stuff here - pwr save, internal stack
@@ -208,14 +214,13 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
     return (s == REG_OK_HOME || s == REG_OK_ROAMING);
   }
 
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+XIIC?"));
-    if (waitResponse(GF(GSM_NL "+XIIC:")) != 1) { return ""; }
+    if (waitResponse(GF(GSM_NL "+XIIC:")) != 1) { return 0; }
     streamSkipUntil(',');
-    String res = stream.readStringUntil('\n');
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -293,6 +298,15 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
  protected:
   // Can follow the standard CCLK function in the template
 
+  /*
+   * DNS functions
+   */
+ protected:
+  bool dnsResolveImpl(const char* host, IPAddress& ip, uint32_t&) {
+    ip = dnsIpQuery(host);
+    return ip != IPAddress(0, 0, 0, 0);
+  }
+
   /*
    * Client related functions
    */
@@ -301,9 +315,9 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
                     int timeout_s = 75) {
     uint32_t timeout_ms = ((uint32_t)timeout_s) * 1000;
     for (int i = 0; i < 3; i++) {  // TODO(?): no need for loop?
-      String ip = dnsIpQuery(host);
-
-      sendAT(GF("+TCPSETUP="), mux, GF(","), ip, GF(","), port);
+      char ip[16];
+      sendAT(GF("+TCPSETUP="), mux, GF(","), dnsConnectHost(host, ip), GF(","),
+             port);
       int8_t rsp = waitResponse(timeout_ms, GF(",OK" GSM_NL),
                                 GF(",FAIL" GSM_NL),
                                 GF("+TCPSETUP:Error" GSM_NL));
@@ -337,12 +351,13 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
     return 1 == res;
   }
 
-  String dnsIpQuery(const char* host) {
+  IPAddress dnsIpQuery(const char* host) {
     sendAT(GF("+DNS=\""), host, GF("\""));
-    if (waitResponse(10000L, GF(GSM_NL "+DNS:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(10000L, GF(GSM_NL "+DNS:")) != 1) {
+      return IPAddress(0, 0, 0, 0);
+    }
+    IPAddress res = streamGetIpBefore('\n');
     waitResponse(GF("+DNS:OK" GSM_NL));
-    res.trim();
     return res;
   }
 
@@ -371,7 +386,7 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -397,6 +412,8 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF("+TCPRECV:"))) {
           int8_t  mux      = streamGetIntBefore(',');
           int16_t len      = streamGetIntBefore(',');
@@ -427,7 +444,8 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -446,8 +464,7 @@ class TinyGsmM590 : public TinyGsmModem<TinyGsmM590>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
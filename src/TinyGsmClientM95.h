@@ -75,9 +75,12 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
     }
 
     bool init(TinyGsmM95* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_available = 0;
-      sock_connected = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -149,7 +152,7 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
    * Constructor
    */
  public:
-  explicit TinyGsmM95(Stream& stream) : stream(stream) {
+  explicit TinyGsmM95(Stream& stream) : stream(tapStream(stream)) {
     memset(sockets, 0, sizeof(sockets));
   }
 
@@ -176,7 +179,7 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     // Enable network time synchronization
     sendAT(GF("+QNITZ=1"));
@@ -253,12 +256,11 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
     waitResponse();
   }
 
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+QILOCIP"));
     streamSkipUntil('\n');
-    String res = stream.readStringUntil('\n');
-    res.trim();
-    return res;
+    streamGetStringBefore('\n', buf, len);
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -344,13 +346,12 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
    * SIM card functions
    */
  protected:
-  String getSimCCIDImpl() {
+  size_t getSimCCIDImpl(char* buf, size_t len) {
     sendAT(GF("+QCCID"));
-    if (waitResponse(GF(GSM_NL "+QCCID:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(GF(GSM_NL "+QCCID:")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -536,7 +537,7 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -562,6 +563,8 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF(GSM_NL "+QIRDI:"))) {
           streamSkipUntil(',');  // Skip the context
           streamSkipUntil(',');  // Skip the role
@@ -590,7 +593,8 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -609,8 +613,7 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
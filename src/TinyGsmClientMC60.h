@@ -74,9 +74,12 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
     }
 
     bool init(TinyGsmMC60* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_available = 0;
-      sock_connected = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -148,7 +151,7 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
    * Constructor
    */
  public:
-  explicit TinyGsmMC60(Stream& stream) : stream(stream) {
+  explicit TinyGsmMC60(Stream& stream) : stream(tapStream(stream)) {
     memset(sockets, 0, sizeof(sockets));
   }
 
@@ -175,7 +178,7 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     // Enable network time synchronization
     sendAT(GF("+QNITZ=1"));
@@ -239,12 +242,11 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
     return (s == REG_OK_HOME || s == REG_OK_ROAMING);
   }
 
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+QILOCIP"));
     streamSkipUntil('\n');
-    String res = stream.readStringUntil('\n');
-    res.trim();
-    return res;
+    streamGetStringBefore('\n', buf, len);
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -510,7 +512,7 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -536,6 +538,8 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (r6 && data.endsWith(r6)) {
           index = 6;
           goto finish;
@@ -576,7 +580,8 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -595,8 +600,7 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL, GsmConstStr r6 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5, r6);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5, r6);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
@@ -16,6 +16,7 @@
 #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
 
 #include "TinyGsmBattery.tpp"
+#include "TinyGsmDNS.tpp"
 #include "TinyGsmGPRS.tpp"
 #include "TinyGsmGSMLocation.tpp"
 #include "TinyGsmModem.tpp"
@@ -46,6 +47,7 @@ enum RegStatus {
 class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
                        public TinyGsmGPRS<TinyGsmSim5360>,
                        public TinyGsmTCP<TinyGsmSim5360, TINY_GSM_MUX_COUNT>,
+                       public TinyGsmDNS<TinyGsmSim5360>,
                        public TinyGsmSMS<TinyGsmSim5360>,
                        public TinyGsmTime<TinyGsmSim5360>,
                        public TinyGsmNTP<TinyGsmSim5360>,
@@ -55,6 +57,7 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
   friend class TinyGsmModem<TinyGsmSim5360>;
   friend class TinyGsmGPRS<TinyGsmSim5360>;
   friend class TinyGsmTCP<TinyGsmSim5360, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmDNS<TinyGsmSim5360>;
   friend class TinyGsmSMS<TinyGsmSim5360>;
   friend class TinyGsmTime<TinyGsmSim5360>;
   friend class TinyGsmNTP<TinyGsmSim5360>;
@@ -77,11 +80,14 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
     }
 
     bool init(TinyGsmSim5360* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_available = 0;
-      prev_check     = 0;
-      sock_connected = false;
-      got_data       = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      check_backoff   = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
+      got_data        = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -149,7 +155,7 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
    * Constructor
    */
  public:
-  explicit TinyGsmSim5360(Stream& stream) : stream(stream) {
+  explicit TinyGsmSim5360(Stream& stream) : stream(tapStream(stream)) {
     memset(sockets, 0, sizeof(sockets));
   }
 
@@ -173,7 +179,7 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     // Disable time and time zone URC's
     sendAT(GF("+CTZR=0"));
@@ -195,19 +201,16 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
     }
   }
 
-  String getModemNameImpl() {
-    String name = "SIMCom SIM5360";
-
+  size_t getModemNameImpl(char* buf, size_t len) {
     sendAT(GF("+CGMM"));
-    String res2;
-    if (waitResponse(1000L, res2) != 1) { return name; }
-    res2.replace(GSM_NL "OK" GSM_NL, "");
-    res2.replace("_", " ");
-    res2.trim();
-
-    name = res2;
-    DBG("### Modem:", name);
-    return name;
+    size_t n = waitResponseText(1000L, buf, len);
+    if (!n) { return TinyGsmCopyString(buf, len, "SIMCom SIM5360"); }
+    for (size_t i = 0; i < n; i++) {
+      if (buf[i] == '_') { buf[i] = ' '; }
+    }
+    n = TinyGsmTrim(buf);
+    DBG("### Modem:", buf);
+    return n;
   }
 
   bool factoryDefaultImpl() {  // these commands aren't supported
@@ -286,15 +289,10 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
     return waitResponse() == 1;
   }
 
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+IPADDR"));  // Inquire Socket PDP address
     // sendAT(GF("+CGPADDR=1"));  // Show PDP address
-    String res;
-    if (waitResponse(10000L, res) != 1) { return ""; }
-    res.replace(GSM_NL "OK" GSM_NL, "");
-    res.replace(GSM_NL, "");
-    res.trim();
-    return res;
+    return waitResponseText(10000L, buf, len);
   }
 
   /*
@@ -415,13 +413,12 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
    */
  protected:
   // Gets the CCID of a sim card via AT+CCID
-  String getSimCCIDImpl() {
+  size_t getSimCCIDImpl(char* buf, size_t len) {
     sendAT(GF("+CICCID"));
-    if (waitResponse(GF(GSM_NL "+ICCID:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(GF(GSM_NL "+ICCID:")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -448,6 +445,28 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
    */
   // Can sync with server using CNTP as per template
 
+  /*
+   * DNS functions
+   */
+ protected:
+  bool dnsResolveImpl(const char* host, IPAddress& ip, uint32_t&) {
+    sendAT(GF("+CDNSGIP=\""), host, GF("\""));
+    // +CDNSGIP: 1,<domain name>,<IP1>[,<IP2>] then OK, or
+    // +CDNSGIP: 0,<dns error code> then ERROR
+    if (waitResponse(30000L, GF("+CDNSGIP:"), GF("ERROR" GSM_NL)) != 1) {
+      return false;
+    }
+    if (streamGetIntBefore(',') != 1) {
+      waitResponse();
+      return false;
+    }
+    streamSkipUntil(',');  // Skip domain name
+    streamSkipUntil('\"');
+    ip = streamGetIpBefore('\"');
+    waitResponse();
+    return ip != IPAddress(0, 0, 0, 0);
+  }
+
   /*
    * Battery functions
    */
@@ -513,8 +532,9 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
 
     // Establish a connection in multi-socket mode
     uint32_t timeout_ms = ((uint32_t)timeout_s) * 1000;
-    sendAT(GF("+CIPOPEN="), mux, ',', GF("\"TCP"), GF("\",\""), host, GF("\","),
-           port);
+    char ip[16];
+    sendAT(GF("+CIPOPEN="), mux, ',', GF("\"TCP"), GF("\",\""),
+           dnsConnectHost(host, ip), GF("\","), port);
     // The reply is +CIPOPEN: ## of socket created
     if (waitResponse(timeout_ms, GF(GSM_NL "+CIPOPEN:")) != 1) { return false; }
     return true;
@@ -550,10 +570,7 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
     for (int i = 0; i < len_requested; i++) {
       uint32_t startMillis = millis();
 #ifdef TINY_GSM_USE_HEX
-      while (stream.available() < 2 &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(2, startMillis, sockets[mux]->_timeout);
       char buf[4] = {
           0,
       };
@@ -561,10 +578,7 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
       buf[1] = stream.read();
       char c = strtol(buf, NULL, 16);
 #else
-      while (!stream.available() &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(1, startMillis, sockets[mux]->_timeout);
       char c = stream.read();
 #endif
       sockets[mux]->rx.put(c);
@@ -576,7 +590,22 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
     return len_requested;
   }
 
-  size_t modemGetAvailable(uint8_t mux) {
+  // Asks how much data is waiting on each flagged socket, but leaves the
+  // state check for the end because +CIPCLOSE? reports on every socket at once
+  void modemCheckAvailable() {
+    int8_t check_mux = -1;
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      GsmClientSim5360* sock = sockets[mux];
+      if (sock && sock->got_data) {
+        sock->got_data       = false;
+        sock->sock_available = modemGetAvailable(mux, false);
+        if (!sock->sock_available) { check_mux = mux; }
+      }
+    }
+    if (check_mux >= 0) { modemGetConnected(check_mux); }
+  }
+
+  size_t modemGetAvailable(uint8_t mux, bool check_state = true) {
     if (!sockets[mux]) return 0;
     sendAT(GF("+CIPRXGET=4,"), mux);
     size_t result = 0;
@@ -587,7 +616,9 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
       waitResponse();
     }
     // DBG("### Available:", result, "on", mux);
-    if (!result) { sockets[mux]->sock_connected = modemGetConnected(mux); }
+    if (!result && check_state) {
+      sockets[mux]->sock_connected = modemGetConnected(mux);
+    }
     return result;
   }
 
@@ -630,7 +661,7 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -656,6 +687,8 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF(GSM_NL "+CIPRXGET:"))) {
           int8_t mode = streamGetIntBefore(',');
           if (mode == 1) {
@@ -695,7 +728,8 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -714,8 +748,7 @@ class TinyGsmSim5360 : public TinyGsmModem<TinyGsmSim5360>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
@@ -16,13 +16,16 @@
 #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
 
 #include "TinyGsmClientSIM70xx.h"
+#include "TinyGsmDNS.tpp"
 #include "TinyGsmTCP.tpp"
 
 
 class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
-                       public TinyGsmTCP<TinyGsmSim7000, TINY_GSM_MUX_COUNT> {
+                       public TinyGsmTCP<TinyGsmSim7000, TINY_GSM_MUX_COUNT>,
+                       public TinyGsmDNS<TinyGsmSim7000> {
   friend class TinyGsmSim70xx<TinyGsmSim7000>;
   friend class TinyGsmTCP<TinyGsmSim7000, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmDNS<TinyGsmSim7000>;
 
   /*
    * Inner Client
@@ -39,11 +42,14 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
     }
 
     bool init(TinyGsmSim7000* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_available = 0;
-      prev_check     = 0;
-      sock_connected = false;
-      got_data       = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      check_backoff   = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
+      got_data        = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -116,7 +122,7 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     // Enable Local Time Stamp for getting network time
     sendAT(GF("+CLTS=1"));
@@ -148,14 +154,9 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
    * Generic network functions
    */
  protected:
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+CIFSR;E0"));
-    String res;
-    if (waitResponse(10000L, res) != 1) { return ""; }
-    res.replace(GSM_NL "OK" GSM_NL, "");
-    res.replace(GSM_NL, "");
-    res.trim();
-    return res;
+    return waitResponseText(10000L, buf, len);
   }
 
   /*
@@ -274,6 +275,26 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
    */
   // Can sync with server using CNTP as per template
 
+  /*
+   * DNS functions
+   */
+ protected:
+  bool dnsResolveImpl(const char* host, IPAddress& ip, uint32_t&) {
+    sendAT(GF("+CDNSGIP=\""), host, GF("\""));
+    if (waitResponse() != 1) { return false; }
+    // +CDNSGIP: 1,<domain name>,<IP1>[,<IP2>] or +CDNSGIP: 0,<dns error code>
+    if (waitResponse(30000L, GF(GSM_NL "+CDNSGIP:")) != 1) { return false; }
+    if (streamGetIntBefore(',') != 1) {
+      streamSkipUntil('\n');
+      return false;
+    }
+    streamSkipUntil(',');  // Skip domain name
+    streamSkipUntil('\"');
+    ip = streamGetIpBefore('\"');
+    streamSkipUntil('\n');
+    return ip != IPAddress(0, 0, 0, 0);
+  }
+
   /*
    * Battery functions
    */
@@ -290,8 +311,9 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
     uint32_t timeout_ms = ((uint32_t)timeout_s) * 1000;
 
     // when not using SSL, the TCP application toolkit is more stable
-    sendAT(GF("+CIPSTART="), mux, ',', GF("\"TCP"), GF("\",\""), host,
-           GF("\","), port);
+    char ip[16];
+    sendAT(GF("+CIPSTART="), mux, ',', GF("\"TCP"), GF("\",\""),
+           dnsConnectHost(host, ip), GF("\","), port);
     return (1 ==
             waitResponse(timeout_ms, GF("CONNECT OK" GSM_NL),
                          GF("CONNECT FAIL" GSM_NL),
@@ -334,10 +356,7 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
     for (int i = 0; i < len_requested; i++) {
       uint32_t startMillis = millis();
 #ifdef TINY_GSM_USE_HEX
-      while (stream.available() < 2 &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(2, startMillis, sockets[mux]->_timeout);
       char buf[4] = {
           0,
       };
@@ -345,10 +364,7 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
       buf[1] = stream.read();
       char c = strtol(buf, NULL, 16);
 #else
-      while (!stream.available() &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(1, startMillis, sockets[mux]->_timeout);
       char c = stream.read();
 #endif
       sockets[mux]->rx.put(c);
@@ -360,7 +376,22 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
     return len_requested;
   }
 
-  size_t modemGetAvailable(uint8_t mux) {
+  // Asks how much data is waiting on each flagged socket, but leaves the
+  // state check for the end because +CIPSTATUS reports on every socket at once
+  void modemCheckAvailable() {
+    int8_t check_mux = -1;
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      GsmClientSim7000* sock = sockets[mux];
+      if (sock && sock->got_data) {
+        sock->got_data       = false;
+        sock->sock_available = modemGetAvailable(mux, false);
+        if (!sock->sock_available) { check_mux = mux; }
+      }
+    }
+    if (check_mux >= 0) { modemGetConnected(check_mux); }
+  }
+
+  size_t modemGetAvailable(uint8_t mux, bool check_state = true) {
     if (!sockets[mux]) return 0;
 
     sendAT(GF("+CIPRXGET=4,"), mux);
@@ -372,18 +403,35 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
       waitResponse();
     }
     // DBG("### Available:", result, "on", mux);
-    if (!result) { sockets[mux]->sock_connected = modemGetConnected(mux); }
+    if (!result && check_state) {
+      sockets[mux]->sock_connected = modemGetConnected(mux);
+    }
     return result;
   }
 
   bool modemGetConnected(uint8_t mux) {
-    sendAT(GF("+CIPSTATUS="), mux);
-    waitResponse(GF("+CIPSTATUS"));
-    int8_t res = waitResponse(GF(",\"CONNECTED\""), GF(",\"CLOSED\""),
-                              GF(",\"CLOSING\""), GF(",\"REMOTE CLOSING\""),
-                              GF(",\"INITIAL\""));
-    waitResponse();
-    return 1 == res;
+    // Read the status of all sockets at once
+    // In multi-IP mode +CIPSTATUS gives the OK first, then the IP state, then
+    // one line for each connection:
+    // C: <n>,<bearer>,<TCP/UDP>,<IP address>,<port>,<client state>
+    sendAT(GF("+CIPSTATUS"));
+    if (waitResponse() != 1) { return false; }
+    for (int muxNo = 0; muxNo < TINY_GSM_MUX_COUNT; muxNo++) {
+      if (waitResponse(GF(GSM_NL "C: ")) != 1) { break; }
+      int8_t ret_mux = streamGetIntBefore(',');
+      streamSkipUntil(',');  // Skip bearer
+      streamSkipUntil(',');  // Skip TCP/UDP
+      streamSkipUntil(',');  // Skip IP address
+      streamSkipUntil(',');  // Skip port
+      int8_t res = waitResponse(GF("CONNECTED\""), GF("CLOSED\""),
+                                GF("CLOSING\""), GF("INITIAL\""),
+                                GF("CONNECTING\""));
+      if (ret_mux >= 0 && ret_mux < TINY_GSM_MUX_COUNT && sockets[ret_mux]) {
+        sockets[ret_mux]->sock_connected = (1 == res);
+      }
+    }
+    if (!sockets[mux]) { return false; }
+    return sockets[mux]->sock_connected;
   }
 
   /*
@@ -411,7 +459,7 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -437,6 +485,8 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF(GSM_NL "+CIPRXGET:"))) {
           int8_t mode = streamGetIntBefore(',');
           if (mode == 1) {
@@ -492,7 +542,8 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -511,8 +562,7 @@ class TinyGsmSim7000 : public TinyGsmSim70xx<TinyGsmSim7000>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
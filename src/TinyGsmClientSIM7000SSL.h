@@ -16,15 +16,18 @@
 #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
 
 #include "TinyGsmClientSIM70xx.h"
+#include "TinyGsmDNS.tpp"
 #include "TinyGsmTCP.tpp"
 #include "TinyGsmSSL.tpp"
 
 class TinyGsmSim7000SSL
     : public TinyGsmSim70xx<TinyGsmSim7000SSL>,
       public TinyGsmTCP<TinyGsmSim7000SSL, TINY_GSM_MUX_COUNT>,
-      public TinyGsmSSL<TinyGsmSim7000SSL> {
+      public TinyGsmSSL<TinyGsmSim7000SSL>,
+      public TinyGsmDNS<TinyGsmSim7000SSL> {
   friend class TinyGsmSim70xx<TinyGsmSim7000SSL>;
   friend class TinyGsmTCP<TinyGsmSim7000SSL, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmDNS<TinyGsmSim7000SSL>;
   friend class TinyGsmSSL<TinyGsmSim7000SSL>;
 
   /*
@@ -42,11 +45,14 @@ class TinyGsmSim7000SSL
     }
 
     bool init(TinyGsmSim7000SSL* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_available = 0;
-      prev_check     = 0;
-      sock_connected = false;
-      got_data       = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      check_backoff   = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
+      got_data        = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -143,7 +149,7 @@ class TinyGsmSim7000SSL
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     // Enable Local Time Stamp for getting network time
     sendAT(GF("+CLTS=1"));
@@ -165,23 +171,6 @@ class TinyGsmSim7000SSL
     }
   }
 
-  void maintainImpl() {
-    // Keep listening for modem URC's and proactively iterate through
-    // sockets asking if any data is avaiable
-    bool check_socks = false;
-    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
-      GsmClientSim7000SSL* sock = sockets[mux];
-      if (sock && sock->got_data) {
-        sock->got_data = false;
-        check_socks    = true;
-      }
-    }
-    // modemGetAvailable checks all socks, so we only want to do it once
-    // modemGetAvailable calls modemGetConnected(), which also checks allf
-    if (check_socks) { modemGetAvailable(0); }
-    while (stream.available()) { waitResponse(15, NULL, NULL); }
-  }
-
   /*
    * Power functions
    */
@@ -192,13 +181,13 @@ class TinyGsmSim7000SSL
    * Generic network functions
    */
  protected:
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+CNACT?"));
-    if (waitResponse(GF(GSM_NL "+CNACT:")) != 1) { return ""; }
+    if (waitResponse(GF(GSM_NL "+CNACT:")) != 1) { return 0; }
     streamSkipUntil('\"');
-    String res = stream.readStringUntil('\"');
+    size_t n = streamGetStringBefore('\"', buf, len);
     waitResponse();
-    return res;
+    return n;
   }
 
   /*
@@ -314,6 +303,26 @@ class TinyGsmSim7000SSL
    */
   // Can sync with server using CNTP as per template
 
+  /*
+   * DNS functions
+   */
+ protected:
+  bool dnsResolveImpl(const char* host, IPAddress& ip, uint32_t&) {
+    sendAT(GF("+CDNSGIP=\""), host, GF("\""));
+    if (waitResponse() != 1) { return false; }
+    // +CDNSGIP: 1,<domain name>,<IP1>[,<IP2>] or +CDNSGIP: 0,<dns error code>
+    if (waitResponse(30000L, GF(GSM_NL "+CDNSGIP:")) != 1) { return false; }
+    if (streamGetIntBefore(',') != 1) {
+      streamSkipUntil('\n');
+      return false;
+    }
+    streamSkipUntil(',');  // Skip domain name
+    streamSkipUntil('\"');
+    ip = streamGetIpBefore('\"');
+    streamSkipUntil('\n');
+    return ip != IPAddress(0, 0, 0, 0);
+  }
+
   /*
    * Battery functions
    */
@@ -392,7 +401,10 @@ class TinyGsmSim7000SSL
     // <cid> TCP/UDP identifier
     // <conn_type> "TCP" or "UDP"
     // NOTE:  the "TCP" can't be included
-    sendAT(GF("+CAOPEN="), mux, GF(",\""), host, GF("\","), port);
+    // SSL needs the name to check the certificate against
+    char ip[16];
+    sendAT(GF("+CAOPEN="), mux, GF(",\""),
+           ssl ? host : dnsConnectHost(host, ip), GF("\","), port);
     if (waitResponse(timeout_ms, GF(GSM_NL "+CAOPEN:")) != 1) { return 0; }
     // returns OK/r/n/r/n+CAOPEN: <cid>,<result>
     // <result> 0: Success
@@ -468,10 +480,7 @@ class TinyGsmSim7000SSL
 
     for (int i = 0; i < len_confirmed; i++) {
       uint32_t startMillis = millis();
-      while (!stream.available() &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(1, startMillis, sockets[mux]->_timeout);
       char c = stream.read();
       sockets[mux]->rx.put(c);
     }
@@ -484,6 +493,21 @@ class TinyGsmSim7000SSL
     return len_confirmed;
   }
 
+  void modemCheckAvailable() {
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      GsmClientSim7000SSL* sock = sockets[mux];
+      if (sock) { sock->got_data = false; }
+    }
+    // modemGetAvailable checks all socks, so we only want to do it once
+    // modemGetAvailable calls modemGetConnected(), which also checks all
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      if (sockets[mux]) {
+        modemGetAvailable(mux);
+        break;
+      }
+    }
+  }
+
   size_t modemGetAvailable(uint8_t mux) {
     // If the socket doesn't exist, just return
     if (!sockets[mux]) { return 0; }
@@ -609,7 +633,7 @@ class TinyGsmSim7000SSL
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -635,6 +659,8 @@ class TinyGsmSim7000SSL
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF("+CARECV:"))) {
           int8_t  mux = streamGetIntBefore(',');
           int16_t len = streamGetIntBefore('\n');
@@ -687,7 +713,8 @@ class TinyGsmSim7000SSL
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -706,8 +733,7 @@ class TinyGsmSim7000SSL
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
@@ -14,16 +14,27 @@
 
 #define TINY_GSM_MUX_COUNT 12
 #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+// Incoming data is reliably announced with +CADATAIND, so the fallback
+// check for unannounced data can start out slower
+#if !defined(TINY_GSM_DATA_CHECK_MS)
+#define TINY_GSM_DATA_CHECK_MS 2000
+#endif
 
 #include "TinyGsmClientSIM70xx.h"
+#include "TinyGsmDNS.tpp"
 #include "TinyGsmTCP.tpp"
 #include "TinyGsmSSL.tpp"
+#include "TinyGsmUDP.tpp"
 
 class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
                        public TinyGsmTCP<TinyGsmSim7080, TINY_GSM_MUX_COUNT>,
-                       public TinyGsmSSL<TinyGsmSim7080> {
+                       public TinyGsmUDP<TinyGsmSim7080, TINY_GSM_MUX_COUNT>,
+                       public TinyGsmSSL<TinyGsmSim7080>,
+                       public TinyGsmDNS<TinyGsmSim7080> {
   friend class TinyGsmSim70xx<TinyGsmSim7080>;
   friend class TinyGsmTCP<TinyGsmSim7080, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmDNS<TinyGsmSim7080>;
+  friend class TinyGsmUDP<TinyGsmSim7080, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmSSL<TinyGsmSim7080>;
 
   /*
@@ -41,11 +52,14 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
     }
 
     bool init(TinyGsmSim7080* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_available = 0;
-      prev_check     = 0;
-      sock_connected = false;
-      got_data       = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      check_backoff   = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
+      got_data        = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -111,6 +125,12 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
     TINY_GSM_CLIENT_CONNECT_OVERRIDES
   };
 
+  /*
+   * Inner UDP Client
+   */
+ public:
+  typedef GsmUDP<GsmClientSim7080> GsmUDPSim7080;
+
   /*
    * Constructor
    */
@@ -141,7 +161,7 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     // Enable Local Time Stamp for getting network time
     sendAT(GF("+CLTS=1"));
@@ -163,23 +183,6 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
     }
   }
 
-  void maintainImpl() {
-    // Keep listening for modem URC's and proactively iterate through
-    // sockets asking if any data is avaiable
-    bool check_socks = false;
-    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
-      GsmClientSim7080* sock = sockets[mux];
-      if (sock && sock->got_data) {
-        sock->got_data = false;
-        check_socks    = true;
-      }
-    }
-    // modemGetAvailable checks all socks, so we only want to do it once
-    // modemGetAvailable calls modemGetConnected(), which also checks allf
-    if (check_socks) { modemGetAvailable(0); }
-    while (stream.available()) { waitResponse(15, NULL, NULL); }
-  }
-
   /*
    * Power functions
    */
@@ -190,13 +193,13 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
    * Generic network functions
    */
  protected:
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+CNACT?"));
-    if (waitResponse(GF(GSM_NL "+CNACT:")) != 1) { return ""; }
+    if (waitResponse(GF(GSM_NL "+CNACT:")) != 1) { return 0; }
     streamSkipUntil('\"');
-    String res = stream.readStringUntil('\"');
+    size_t n = streamGetStringBefore('\"', buf, len);
     waitResponse();
-    return res;
+    return n;
   }
 
   /*
@@ -319,6 +322,26 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
    */
   // Can sync with server using CNTP as per template
 
+  /*
+   * DNS functions
+   */
+ protected:
+  bool dnsResolveImpl(const char* host, IPAddress& ip, uint32_t&) {
+    sendAT(GF("+CDNSGIP=\""), host, GF("\""));
+    if (waitResponse() != 1) { return false; }
+    // +CDNSGIP: 1,<domain name>,<IP1>[,<IP2>] or +CDNSGIP: 0,<dns error code>
+    if (waitResponse(30000L, GF(GSM_NL "+CDNSGIP:")) != 1) { return false; }
+    if (streamGetIntBefore(',') != 1) {
+      streamSkipUntil('\n');
+      return false;
+    }
+    streamSkipUntil(',');  // Skip domain name
+    streamSkipUntil('\"');
+    ip = streamGetIpBefore('\"');
+    streamSkipUntil('\n');
+    return ip != IPAddress(0, 0, 0, 0);
+  }
+
   /*
    * Battery functions
    */
@@ -400,7 +423,10 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
     //                +CAURC:
     //                "recv",<id>,<length>,<remoteIP>,<remote_port><CR><LF><data>
     // NOTE:  including the <recv_mode> fails
-    sendAT(GF("+CAOPEN="), mux, GF(",0,\"TCP\",\""), host, GF("\","), port);
+    // SSL needs the name to check the certificate against
+    char ip[16];
+    sendAT(GF("+CAOPEN="), mux, GF(",0,\"TCP\",\""),
+           ssl ? host : dnsConnectHost(host, ip), GF("\","), port);
     if (waitResponse(timeout_ms, GF(GSM_NL "+CAOPEN:")) != 1) { return 0; }
     // returns OK/r/n/r/n+CAOPEN: <cid>,<result>
     // <result> 0: Success
@@ -428,6 +454,23 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
     return 0 == res;
   }
 
+  // +CAOPEN always gives a UDP socket a fixed remote end
+  bool modemOpenUDP(const char* host, uint16_t port, uint8_t* mux, uint16_t) {
+    if (!host) { return false; }
+    sendAT(GF("+CACID="), *mux);
+    if (waitResponse() != 1) { return false; }
+    sendAT(GF("+CASSLCFG="), *mux, ',', GF("SSL,0"));
+    waitResponse();
+    char ip[16];
+    sendAT(GF("+CAOPEN="), *mux, GF(",0,\"UDP\",\""), dnsConnectHost(host, ip),
+           GF("\","), port);
+    if (waitResponse(75000L, GF(GSM_NL "+CAOPEN:")) != 1) { return false; }
+    streamSkipUntil(',');  // Skip mux
+    int8_t res = streamGetIntBefore('\n');
+    waitResponse();
+    return 0 == res;
+  }
+
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
     // send data on prompt
     sendAT(GF("+CASEND="), mux, ',', (uint16_t)len);
@@ -474,19 +517,35 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
 
     for (int i = 0; i < len_confirmed; i++) {
       uint32_t startMillis = millis();
-      while (!stream.available() &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(1, startMillis, sockets[mux]->_timeout);
       char c = stream.read();
       sockets[mux]->rx.put(c);
     }
+    // The modem doesn't keep datagrams apart or say who sent them
+    if (sockets[mux]->isDatagram()) {
+      sockets[mux]->datagramReceived(len_confirmed, IPAddress(0, 0, 0, 0), 0);
+    }
     waitResponse();
     // make sure the sock available number is accurate again
     sockets[mux]->sock_available = modemGetAvailable(mux);
     return len_confirmed;
   }
 
+  void modemCheckAvailable() {
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      GsmClientSim7080* sock = sockets[mux];
+      if (sock) { sock->got_data = false; }
+    }
+    // modemGetAvailable checks all socks, so we only want to do it once
+    // modemGetAvailable calls modemGetConnected(), which also checks all
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      if (sockets[mux]) {
+        modemGetAvailable(mux);
+        break;
+      }
+    }
+  }
+
   size_t modemGetAvailable(uint8_t mux) {
     // If the socket doesn't exist, just return
     if (!sockets[mux]) { return 0; }
@@ -608,7 +667,7 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -634,6 +693,8 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF("+CARECV:"))) {
           int8_t  mux = streamGetIntBefore(',');
           int16_t len = streamGetIntBefore('\n');
@@ -686,7 +747,8 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -705,8 +767,7 @@ class TinyGsmSim7080 : public TinyGsmSim70xx<TinyGsmSim7080>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
@@ -72,7 +72,8 @@ class TinyGsmSim70xx : public TinyGsmModem<TinyGsmSim70xx<modemType>>,
    * Constructor
    */
  public:
-  explicit TinyGsmSim70xx(Stream& stream) : stream(stream) {}
+  explicit TinyGsmSim70xx(Stream& stream)
+      : stream(this->tapStream(stream)) {}
 
   /*
    * Basic functions
@@ -82,18 +83,14 @@ class TinyGsmSim70xx : public TinyGsmModem<TinyGsmSim70xx<modemType>>,
     return thisModem().initImpl(pin);
   }
 
-  String getModemNameImpl() {
-    String name = "SIMCom SIM7000";
-
+  size_t getModemNameImpl(char* buf, size_t len) {
     thisModem().sendAT(GF("+GMM"));
-    String res2;
-    if (thisModem().waitResponse(5000L, res2) != 1) { return name; }
-    res2.replace(GSM_NL "OK" GSM_NL, "");
-    res2.replace("_", " ");
-    res2.trim();
-
-    name = res2;
-    return name;
+    size_t n = thisModem().waitResponseText(5000L, buf, len);
+    if (!n) { return TinyGsmCopyString(buf, len, "SIMCom SIM7000"); }
+    for (size_t i = 0; i < n; i++) {
+      if (buf[i] == '_') { buf[i] = ' '; }
+    }
+    return TinyGsmTrim(buf);
   }
 
   bool factoryDefaultImpl() {           // these commands aren't supported
@@ -235,8 +232,8 @@ class TinyGsmSim70xx : public TinyGsmModem<TinyGsmSim70xx<modemType>>,
     return thisModem().waitResponse() == 1;
   }
 
-  String getLocalIPImpl() {
-    return thisModem().getLocalIPImpl();
+  size_t getLocalIPImpl(char* buf, size_t len) {
+    return thisModem().getLocalIPImpl(buf, len);
   }
 
   /*
@@ -258,13 +255,12 @@ class TinyGsmSim70xx : public TinyGsmModem<TinyGsmSim70xx<modemType>>,
    */
  protected:
   // Doesn't return the "+CCID" before the number
-  String getSimCCIDImpl() {
+  size_t getSimCCIDImpl(char* buf, size_t len) {
     thisModem().sendAT(GF("+CCID"));
-    if (thisModem().waitResponse(GF(GSM_NL)) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (thisModem().waitResponse(GF(GSM_NL)) != 1) { return 0; }
+    thisModem().streamGetStringBefore('\n', buf, len);
     thisModem().waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -291,15 +287,14 @@ class TinyGsmSim70xx : public TinyGsmModem<TinyGsmSim70xx<modemType>>,
   }
 
   // get the RAW GPS output
-  String getGPSrawImpl() {
+  size_t getGPSrawImpl(char* buf, size_t len) {
     thisModem().sendAT(GF("+CGNSINF"));
     if (thisModem().waitResponse(10000L, GF(GSM_NL "+CGNSINF:")) != 1) {
-      return "";
+      return 0;
     }
-    String res = stream.readStringUntil('\n');
+    thisModem().streamGetStringBefore('\n', buf, len);
     thisModem().waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   // get GPS informations
@@ -433,8 +428,7 @@ class TinyGsmSim70xx : public TinyGsmModem<TinyGsmSim70xx<modemType>>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return thisModem().waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return thisModem().waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
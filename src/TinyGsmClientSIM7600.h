@@ -17,6 +17,7 @@
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmCalling.tpp"
+#include "TinyGsmDNS.tpp"
 #include "TinyGsmGPRS.tpp"
 #include "TinyGsmGPS.tpp"
 #include "TinyGsmGSMLocation.tpp"
@@ -25,6 +26,7 @@
 #include "TinyGsmTCP.tpp"
 #include "TinyGsmTemperature.tpp"
 #include "TinyGsmTime.tpp"
+#include "TinyGsmUDP.tpp"
 #include "TinyGsmNTP.tpp"
 
 
@@ -49,6 +51,8 @@ enum RegStatus {
 class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
                        public TinyGsmGPRS<TinyGsmSim7600>,
                        public TinyGsmTCP<TinyGsmSim7600, TINY_GSM_MUX_COUNT>,
+                       public TinyGsmUDP<TinyGsmSim7600, TINY_GSM_MUX_COUNT>,
+                       public TinyGsmDNS<TinyGsmSim7600>,
                        public TinyGsmSMS<TinyGsmSim7600>,
                        public TinyGsmGSMLocation<TinyGsmSim7600>,
                        public TinyGsmGPS<TinyGsmSim7600>,
@@ -60,6 +64,8 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
   friend class TinyGsmModem<TinyGsmSim7600>;
   friend class TinyGsmGPRS<TinyGsmSim7600>;
   friend class TinyGsmTCP<TinyGsmSim7600, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmDNS<TinyGsmSim7600>;
+  friend class TinyGsmUDP<TinyGsmSim7600, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmSMS<TinyGsmSim7600>;
   friend class TinyGsmGPS<TinyGsmSim7600>;
   friend class TinyGsmGSMLocation<TinyGsmSim7600>;
@@ -84,11 +90,14 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     }
 
     bool init(TinyGsmSim7600* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_available = 0;
-      prev_check     = 0;
-      sock_connected = false;
-      got_data       = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      check_backoff   = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
+      got_data        = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -153,11 +162,17 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
   };
   */
 
+  /*
+   * Inner UDP Client
+   */
+ public:
+  typedef GsmUDP<GsmClientSim7600> GsmUDPSim7600;
+
   /*
    * Constructor
    */
  public:
-  explicit TinyGsmSim7600(Stream& stream) : stream(stream) {
+  explicit TinyGsmSim7600(Stream& stream) : stream(tapStream(stream)) {
     memset(sockets, 0, sizeof(sockets));
   }
 
@@ -181,7 +196,7 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     // Disable time and time zone URC's
     sendAT(GF("+CTZR=0"));
@@ -203,19 +218,16 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     }
   }
 
-  String getModemNameImpl() {
-    String name = "SIMCom SIM7600";
-
+  size_t getModemNameImpl(char* buf, size_t len) {
     sendAT(GF("+CGMM"));
-    String res2;
-    if (waitResponse(1000L, res2) != 1) { return name; }
-    res2.replace(GSM_NL "OK" GSM_NL, "");
-    res2.replace("_", " ");
-    res2.trim();
-
-    name = res2;
-    DBG("### Modem:", name);
-    return name;
+    size_t n = waitResponseText(1000L, buf, len);
+    if (!n) { return TinyGsmCopyString(buf, len, "SIMCom SIM7600"); }
+    for (size_t i = 0; i < n; i++) {
+      if (buf[i] == '_') { buf[i] = ' '; }
+    }
+    n = TinyGsmTrim(buf);
+    DBG("### Modem:", buf);
+    return n;
   }
 
   bool factoryDefaultImpl() {  // these commands aren't supported
@@ -291,15 +303,10 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     return waitResponse() == 1;
   }
 
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+IPADDR"));  // Inquire Socket PDP address
     // sendAT(GF("+CGPADDR=1"));  // Show PDP address
-    String res;
-    if (waitResponse(10000L, res) != 1) { return ""; }
-    res.replace(GSM_NL "OK" GSM_NL, "");
-    res.replace(GSM_NL, "");
-    res.trim();
-    return res;
+    return waitResponseText(10000L, buf, len);
   }
 
   /*
@@ -397,13 +404,12 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
    */
  protected:
   // Gets the CCID of a sim card via AT+CCID
-  String getSimCCIDImpl() {
+  size_t getSimCCIDImpl(char* buf, size_t len) {
     sendAT(GF("+CICCID"));
-    if (waitResponse(GF(GSM_NL "+ICCID:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(GF(GSM_NL "+ICCID:")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -445,13 +451,12 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
   }
 
   // get the RAW GPS output
-  String getGPSrawImpl() {
+  size_t getGPSrawImpl(char* buf, size_t len) {
     sendAT(GF("+CGNSSINFO"));
-    if (waitResponse(GF(GSM_NL "+CGNSSINFO:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(GF(GSM_NL "+CGNSSINFO:")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   // get GPS informations
@@ -547,19 +552,16 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
    * mode. 0 : GLONASS 1 : BEIDOU 2 : GALILEO 3 : QZSS dpo_mode: 1 enable , 0
    * disable
    */
-  String setGNSSModeImpl(uint8_t mode, bool dpo) {
-    String res;
+  size_t setGNSSModeImpl(uint8_t mode, bool dpo, char* buf, size_t len) {
     sendAT(GF("+CGNSSMODE="), mode, ",", dpo);
-    if (waitResponse(10000L, res) != 1) { return ""; }
-    res.replace(GSM_NL, "");
-    res.trim();
-    return res;
+    if (waitResponse(10000L) != 1) { return 0; }
+    return TinyGsmCopyString(buf, len, "OK");
   }
 
   uint8_t getGNSSModeImpl() {
     sendAT(GF("+CGNSSMODE?"));
     if (waitResponse(GF(GSM_NL "+CGNSSMODE:")) != 1) { return 0; }
-    return stream.readStringUntil(',').toInt();
+    return streamGetIntBefore(',');
   }
 
 
@@ -574,6 +576,28 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
    */
   // Can sync with server using CNTP as per template
 
+  /*
+   * DNS functions
+   */
+ protected:
+  bool dnsResolveImpl(const char* host, IPAddress& ip, uint32_t&) {
+    sendAT(GF("+CDNSGIP=\""), host, GF("\""));
+    // +CDNSGIP: 1,<domain name>,<IP1>[,<IP2>] then OK, or
+    // +CDNSGIP: 0,<dns error code> then ERROR
+    if (waitResponse(30000L, GF("+CDNSGIP:"), GF("ERROR" GSM_NL)) != 1) {
+      return false;
+    }
+    if (streamGetIntBefore(',') != 1) {
+      waitResponse();
+      return false;
+    }
+    streamSkipUntil(',');  // Skip domain name
+    streamSkipUntil('\"');
+    ip = streamGetIpBefore('\"');
+    waitResponse();
+    return ip != IPAddress(0, 0, 0, 0);
+  }
+
   /*
    * Battery functions
    */
@@ -632,8 +656,9 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
 
     // Establish a connection in multi-socket mode
     uint32_t timeout_ms = ((uint32_t)timeout_s) * 1000;
-    sendAT(GF("+CIPOPEN="), mux, ',', GF("\"TCP"), GF("\",\""), host, GF("\","),
-           port);
+    char ip[16];
+    sendAT(GF("+CIPOPEN="), mux, ',', GF("\"TCP"), GF("\",\""),
+           dnsConnectHost(host, ip), GF("\","), port);
     // The reply is OK followed by +CIPOPEN: <link_num>,<err> where <link_num>
     // is the mux number and <err> should be 0 if there's no error
     if (waitResponse(timeout_ms, GF(GSM_NL "+CIPOPEN:")) != 1) { return false; }
@@ -643,6 +668,35 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     return true;
   }
 
+  // UDP sockets are always opened without a fixed remote end; every datagram
+  // is addressed with +CIPSEND instead
+  bool modemOpenUDP(const char*, uint16_t, uint8_t* mux, uint16_t localPort) {
+    sendAT(GF("+CIPRXGET=1"));
+    if (waitResponse() != 1) { return false; }
+    // The modem needs a local port, so pick one for each mux if none is given
+    if (!localPort) { localPort = 49152 + *mux; }
+    // AT+CIPOPEN=<link_num>,"UDP",,,<localPort>
+    sendAT(GF("+CIPOPEN="), *mux, GF(",\"UDP\",,,"), localPort);
+    if (waitResponse(15000L, GF(GSM_NL "+CIPOPEN:")) != 1) { return false; }
+    uint8_t opened_mux    = streamGetIntBefore(',');
+    uint8_t opened_result = streamGetIntBefore('\n');
+    return opened_mux == *mux && opened_result == 0;
+  }
+
+  int16_t modemSendTo(const void* buff, size_t len, uint8_t mux,
+                      const char* host, uint16_t port) {
+    char ip[16];
+    sendAT(GF("+CIPSEND="), mux, ',', (uint16_t)len, GF(",\""),
+           dnsConnectHost(host, ip), GF("\","), port);
+    if (waitResponse(GF(">")) != 1) { return 0; }
+    stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+    stream.flush();
+    if (waitResponse(GF(GSM_NL "+CIPSEND:")) != 1) { return 0; }
+    streamSkipUntil(',');  // Skip mux
+    streamSkipUntil(',');  // Skip requested bytes to send
+    return streamGetIntBefore('\n');
+  }
+
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
     sendAT(GF("+CIPSEND="), mux, ',', (uint16_t)len);
     if (waitResponse(GF(">")) != 1) { return 0; }
@@ -673,10 +727,7 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     for (int i = 0; i < len_requested; i++) {
       uint32_t startMillis = millis();
 #ifdef TINY_GSM_USE_HEX
-      while (stream.available() < 2 &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(2, startMillis, sockets[mux]->_timeout);
       char buf[4] = {
           0,
       };
@@ -684,14 +735,15 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
       buf[1] = stream.read();
       char c = strtol(buf, NULL, 16);
 #else
-      while (!stream.available() &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(1, startMillis, sockets[mux]->_timeout);
       char c = stream.read();
 #endif
       sockets[mux]->rx.put(c);
     }
+    // The modem doesn't keep datagrams apart or say who sent them
+    if (sockets[mux]->isDatagram()) {
+      sockets[mux]->datagramReceived(len_requested, IPAddress(0, 0, 0, 0), 0);
+    }
     // DBG("### READ:", len_requested, "from", mux);
     // sockets[mux]->sock_available = modemGetAvailable(mux);
     sockets[mux]->sock_available = len_confirmed;
@@ -699,7 +751,22 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     return len_requested;
   }
 
-  size_t modemGetAvailable(uint8_t mux) {
+  // Asks how much data is waiting on each flagged socket, but leaves the
+  // state check for the end because +CIPCLOSE? reports on every socket at once
+  void modemCheckAvailable() {
+    int8_t check_mux = -1;
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      GsmClientSim7600* sock = sockets[mux];
+      if (sock && sock->got_data) {
+        sock->got_data       = false;
+        sock->sock_available = modemGetAvailable(mux, false);
+        if (!sock->sock_available) { check_mux = mux; }
+      }
+    }
+    if (check_mux >= 0) { modemGetConnected(check_mux); }
+  }
+
+  size_t modemGetAvailable(uint8_t mux, bool check_state = true) {
     if (!sockets[mux]) return 0;
     sendAT(GF("+CIPRXGET=4,"), mux);
     size_t result = 0;
@@ -710,7 +777,9 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
       waitResponse();
     }
     // DBG("### Available:", result, "on", mux);
-    if (!result) { sockets[mux]->sock_connected = modemGetConnected(mux); }
+    if (!result && check_state) {
+      sockets[mux]->sock_connected = modemGetConnected(mux);
+    }
     return result;
   }
 
@@ -755,7 +824,7 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -781,6 +850,8 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF(GSM_NL "+CIPRXGET:"))) {
           int8_t mode = streamGetIntBefore(',');
           if (mode == 1) {
@@ -820,7 +891,8 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -839,8 +911,7 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
@@ -18,13 +18,16 @@
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmCalling.tpp"
+#include "TinyGsmDNS.tpp"
 #include "TinyGsmGPRS.tpp"
 #include "TinyGsmGSMLocation.tpp"
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSMS.tpp"
 #include "TinyGsmSSL.tpp"
+#include "TinyGsmServer.tpp"
 #include "TinyGsmTCP.tpp"
 #include "TinyGsmTime.tpp"
+#include "TinyGsmUDP.tpp"
 #include "TinyGsmNTP.tpp"
 
 #define GSM_NL "\r\n"
@@ -47,6 +50,9 @@ enum RegStatus {
 class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
                       public TinyGsmGPRS<TinyGsmSim800>,
                       public TinyGsmTCP<TinyGsmSim800, TINY_GSM_MUX_COUNT>,
+                      public TinyGsmUDP<TinyGsmSim800, TINY_GSM_MUX_COUNT>,
+                      public TinyGsmServer<TinyGsmSim800, TINY_GSM_MUX_COUNT>,
+                      public TinyGsmDNS<TinyGsmSim800>,
                       public TinyGsmSSL<TinyGsmSim800>,
                       public TinyGsmCalling<TinyGsmSim800>,
                       public TinyGsmSMS<TinyGsmSim800>,
@@ -57,6 +63,9 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
   friend class TinyGsmModem<TinyGsmSim800>;
   friend class TinyGsmGPRS<TinyGsmSim800>;
   friend class TinyGsmTCP<TinyGsmSim800, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmUDP<TinyGsmSim800, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmServer<TinyGsmSim800, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmDNS<TinyGsmSim800>;
   friend class TinyGsmSSL<TinyGsmSim800>;
   friend class TinyGsmCalling<TinyGsmSim800>;
   friend class TinyGsmSMS<TinyGsmSim800>;
@@ -80,11 +89,14 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     }
 
     bool init(TinyGsmSim800* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_available = 0;
-      prev_check     = 0;
-      sock_connected = false;
-      got_data       = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      check_backoff   = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
+      got_data        = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -106,10 +118,26 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     }
     TINY_GSM_CLIENT_CONNECT_OVERRIDES
 
+    // In multi-connection mode +CIPSTART answers OK straight away and the
+    // result follows as "<mux>, CONNECT OK", so sockets can open in parallel
+    int connectAsync(const char* host, uint16_t port) override {
+      return connectAsync(host, port, 75);
+    }
+    int connectAsync(const char* host, uint16_t port, int timeout_s) {
+      stop();
+      TINY_GSM_YIELD();
+      rx.clear();
+      connect_start      = millis();
+      connect_timeout_ms = ((uint32_t)timeout_s) * 1000;
+      sock_connecting    = at->modemConnectStart(host, port, mux, false);
+      return sock_connecting;
+    }
+
     void stop(uint32_t maxWaitMs) {
       dumpModemBuffer(maxWaitMs);
       at->sendAT(GF("+CIPCLOSE="), mux, GF(",1"));  // Quick close
-      sock_connected = false;
+      sock_connected  = false;
+      sock_connecting = false;
       at->waitResponse();
     }
     void stop() override {
@@ -143,13 +171,38 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
       return sock_connected;
     }
     TINY_GSM_CLIENT_CONNECT_OVERRIDES
+
+    int connectAsync(const char* host, uint16_t port) override {
+      return connectAsync(host, port, 75);
+    }
+    int connectAsync(const char* host, uint16_t port, int timeout_s) {
+      stop();
+      TINY_GSM_YIELD();
+      rx.clear();
+      connect_start      = millis();
+      connect_timeout_ms = ((uint32_t)timeout_s) * 1000;
+      sock_connecting    = at->modemConnectStart(host, port, mux, true);
+      return sock_connecting;
+    }
   };
 
+  /*
+   * Inner UDP Client
+   */
+ public:
+  typedef GsmUDP<GsmClientSim800> GsmUDPSim800;
+
+  /*
+   * Inner Server
+   */
+ public:
+  typedef GsmServer<GsmClientSim800> GsmServerSim800;
+
   /*
    * Constructor
    */
  public:
-  explicit TinyGsmSim800(Stream& stream) : stream(stream) {
+  explicit TinyGsmSim800(Stream& stream) : stream(tapStream(stream)) {
     memset(sockets, 0, sizeof(sockets));
   }
 
@@ -176,7 +229,7 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     // Enable Local Time Stamp for getting network time
     sendAT(GF("+CLTS=1"));
@@ -198,8 +251,8 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     }
   }
 
-  String getModemNameImpl() {
-    String name = "";
+  size_t getModemNameImpl(char* buf, size_t len) {
+    const char* name = "";
 #if defined(TINY_GSM_MODEM_SIM800)
     name = "SIMCom SIM800";
 #elif defined(TINY_GSM_MODEM_SIM808)
@@ -211,15 +264,14 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
 #endif
 
     sendAT(GF("+GMM"));
-    String res2;
-    if (waitResponse(1000L, res2) != 1) { return name; }
-    res2.replace(GSM_NL "OK" GSM_NL, "");
-    res2.replace("_", " ");
-    res2.trim();
-
-    name = res2;
-    DBG("### Modem:", name);
-    return name;
+    size_t n = waitResponseText(1000L, buf, len);
+    if (!n) { return TinyGsmCopyString(buf, len, name); }
+    for (size_t i = 0; i < n; i++) {
+      if (buf[i] == '_') { buf[i] = ' '; }
+    }
+    n = TinyGsmTrim(buf);
+    DBG("### Modem:", buf);
+    return n;
   }
 
   bool factoryDefaultImpl() {
@@ -300,14 +352,9 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     return (s == REG_OK_HOME || s == REG_OK_ROAMING);
   }
 
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+CIFSR;E0"));
-    String res;
-    if (waitResponse(10000L, res) != 1) { return ""; }
-    res.replace(GSM_NL "OK" GSM_NL, "");
-    res.replace(GSM_NL, "");
-    res.trim();
-    return res;
+    return waitResponseText(10000L, buf, len);
   }
 
   /*
@@ -316,7 +363,124 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
  protected:
   bool gprsConnectImpl(const char* apn, const char* user = NULL,
                        const char* pwd = NULL) {
+    // Calling this again with the connection already up costs only the
+    // state queries
+    if (gprsIsUp(apn, user, pwd)) { return true; }
+
     gprsDisconnect();
+    memset(gprsStepMs, 0, sizeof(gprsStepMs));
+
+    if (!gprsOpenBearer(apn, user, pwd)) { return false; }
+    if (!gprsAttach()) { return false; }
+    return gprsStartIP(apn, user, pwd);
+  }
+
+ public:
+  // The steps of bringing up GPRS, see getGprsStepTime()
+  enum GprsStep {
+    GPRS_STEP_BEARER,
+    GPRS_STEP_ATTACH,
+    GPRS_STEP_IP_SETUP,
+    GPRS_STEP_CIICR,
+    GPRS_STEP_CIFSR,
+    GPRS_STEP_COUNT
+  };
+
+  // How long a step of the last gprsConnect() or gprsResume() took, in ms;
+  // 0 for a step it didn't need
+  uint32_t getGprsStepTime(GprsStep step) {
+    return step < GPRS_STEP_COUNT ? gprsStepMs[step] : 0;
+  }
+
+  // Like gprsConnect(), but keeps whatever is still up instead of starting
+  // again from a detach.  Meant for getting back online after a socket or
+  // bearer drops.
+  bool gprsResume(const char* apn, const char* user = NULL,
+                  const char* pwd = NULL) {
+    memset(gprsStepMs, 0, sizeof(gprsStepMs));
+    if (!gprsBearerOpen() && !gprsOpenBearer(apn, user, pwd)) {
+      return false;
+    }
+    if (!gprsAttached() && !gprsAttach()) { return false; }
+
+    char state[24];
+    gprsIPState(state, sizeof(state));
+    if (!strcmp(state, "IP STATUS") || !strcmp(state, "IP PROCESSING")) {
+      return true;
+    }
+    if (!strcmp(state, "IP GPRSACT")) { return gprsGetIP(); }
+    if (!strcmp(state, "IP START")) {
+      return gprsBringUpIP() && gprsGetIP() && gprsSetDNS();
+    }
+    if (strcmp(state, "IP INITIAL")) {
+      // PDP DEACT or stuck part way, the IP application must be shut first
+      sendAT(GF("+CIPSHUT"));
+      if (waitResponse(60000L) != 1) { return false; }
+    }
+    return gprsStartIP(apn, user, pwd);
+  }
+
+ protected:
+  bool gprsIsUp(const char* apn, const char* user, const char* pwd) {
+    char state[24];
+    gprsIPState(state, sizeof(state));
+    if (strcmp(state, "IP STATUS") && strcmp(state, "IP PROCESSING")) {
+      return false;
+    }
+    // +CSTT: "<apn>","<user>","<pwd>"
+    sendAT(GF("+CSTT?"));
+    if (waitResponse(GF("+CSTT:")) != 1) { return false; }
+    bool same = streamQuotedIs(apn) && streamQuotedIs(user) &&
+                streamQuotedIs(pwd);
+    waitResponse();
+    return same && gprsBearerOpen() && gprsAttached();
+  }
+
+  // Whether the next quoted field of a reply is text, NULL taken as ""
+  bool streamQuotedIs(const char* text) {
+    char field[64];
+    streamSkipUntil('"');
+    streamGetStringBefore('"', field, sizeof(field));
+    return !strcmp(field, text ? text : "");
+  }
+
+  // Reads the state of the IP application, ie "IP INITIAL" or "IP STATUS"
+  size_t gprsIPState(char* buf, size_t len) {
+    buf[0] = '\0';
+    // In multi-IP mode a line for each connection follows the state
+    sendAT(GF("+CIPMUX?"));
+    if (waitResponse(GF("+CIPMUX:")) != 1) { return 0; }
+    bool multi = streamGetIntBefore('\n') == 1;
+    waitResponse();
+    sendAT(GF("+CIPSTATUS"));
+    if (waitResponse(GF("STATE: ")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
+    // Read up to the end of the line for the last connection, anything the
+    // modem sends after it is left for the next reply
+    if (multi && waitResponse(GF("C: 5,")) == 1) { streamSkipUntil('\n'); }
+    return TinyGsmTrim(buf);
+  }
+
+  // Whether the bearer for applications based on IP is open
+  bool gprsBearerOpen() {
+    sendAT(GF("+SAPBR=2,1"));
+    if (waitResponse(30000L, GF("+SAPBR:")) != 1) { return false; }
+    streamSkipUntil(',');  // Skip bearer profile id
+    int8_t status = streamGetIntBefore(',');
+    waitResponse();
+    return 1 == status;
+  }
+
+  bool gprsAttached() {
+    sendAT(GF("+CGATT?"));
+    if (waitResponse(GF("+CGATT:")) != 1) { return false; }
+    int8_t res = streamGetIntBefore('\n');
+    waitResponse();
+    return 1 == res;
+  }
+
+  bool gprsOpenBearer(const char* apn, const char* user, const char* pwd) {
+    uint32_t startMillis = millis();
 
     // Bearer settings for applications based on IP
     // Set the connection type to GPRS
@@ -351,11 +515,23 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     waitResponse(85000L);
     // Query the GPRS bearer context status
     sendAT(GF("+SAPBR=2,1"));
-    if (waitResponse(30000L) != 1) { return false; }
+    bool ok = waitResponse(30000L) == 1;
+    gprsStepDone(GPRS_STEP_BEARER, startMillis);
+    return ok;
+  }
 
+  bool gprsAttach() {
+    uint32_t startMillis = millis();
     // Attach to GPRS
     sendAT(GF("+CGATT=1"));
-    if (waitResponse(60000L) != 1) { return false; }
+    bool ok = waitResponse(60000L) == 1;
+    gprsStepDone(GPRS_STEP_ATTACH, startMillis);
+    return ok;
+  }
+
+  // Sets up and starts the IP application from the IP INITIAL state
+  bool gprsStartIP(const char* apn, const char* user, const char* pwd) {
+    uint32_t startMillis = millis();
 
     // Set to multi-IP
     sendAT(GF("+CIPMUX=1"));
@@ -372,21 +548,103 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     // Start Task and Set APN, USER NAME, PASSWORD
     sendAT(GF("+CSTT=\""), apn, GF("\",\""), user, GF("\",\""), pwd, GF("\""));
     if (waitResponse(60000L) != 1) { return false; }
+    gprsStepDone(GPRS_STEP_IP_SETUP, startMillis);
+
+    return gprsBringUpIP() && gprsGetIP() && gprsSetDNS();
+  }
 
+  bool gprsBringUpIP() {
+    uint32_t startMillis = millis();
     // Bring Up Wireless Connection with GPRS or CSD
     sendAT(GF("+CIICR"));
-    if (waitResponse(60000L) != 1) { return false; }
+    bool ok = waitResponse(60000L) == 1;
+    gprsStepDone(GPRS_STEP_CIICR, startMillis);
+    return ok;
+  }
 
+  bool gprsGetIP() {
+    uint32_t startMillis = millis();
     // Get Local IP Address, only assigned after connection
     sendAT(GF("+CIFSR;E0"));
-    if (waitResponse(10000L) != 1) { return false; }
+    bool ok = waitResponse(10000L) == 1;
+    gprsStepDone(GPRS_STEP_CIFSR, startMillis);
+    return ok;
+  }
+
+  void gprsStepDone(GprsStep step, uint32_t startMillis) {
+    gprsStepMs[step] = millis() - startMillis;
+#if defined(TINY_GSM_DEBUG)
+    static const char* const names[GPRS_STEP_COUNT] = {
+        "bearer:", "attach:", "IP setup:", "CIICR:", "CIFSR:"};
+    DBG("### GPRS", names[step], gprsStepMs[step], "ms");
+#endif
+  }
 
+  bool gprsSetDNS() {
     // Configure Domain Name Server (DNS)
     sendAT(GF("+CDNSCFG=\"8.8.8.8\",\"8.8.4.4\""));
-    if (waitResponse() != 1) { return false; }
+    return waitResponse() == 1;
+  }
 
+#if TINY_GSM_COMMAND_QUEUE_SIZE > 0
+  // For sockets reconnecting on their own; the state of the IP application
+  // also tells how far back the resume has to start
+  bool queueDataCheck() {
+    // The OK comes ahead of the state, the line for the last connection
+    // ends the reply
+    return sendATAsync(GF("+CIPSTATUS"), dataStatus, this, 1000L,
+                       GF("C: 5,"));
+  }
+  static void dataStatus(int8_t, String& data, void* arg) {
+    TinyGsmSim800* modem = static_cast<TinyGsmSim800*>(arg);
+    if (data.indexOf(GF("IP STATUS")) >= 0 ||
+        data.indexOf(GF("IP PROCESSING")) >= 0) {
+      modem->restoreState = RESTORE_UP;
+      return;
+    }
+    // How many of CIPSHUT, CSTT, CIICR and CIFSR are needed
+    if (data.indexOf(GF("IP GPRSACT")) >= 0) {
+      modem->resumeSteps = 1;
+    } else if (data.indexOf(GF("IP START")) >= 0) {
+      modem->resumeSteps = 2;
+    } else if (data.indexOf(GF("IP INITIAL")) >= 0) {
+      modem->resumeSteps = 3;
+    } else {
+      modem->resumeSteps = 4;
+    }
+    modem->restoreState = RESTORE_DOWN;
+  }
+
+  // Like gprsResume(), it picks up from where the IP application is, so
+  // sockets still open are left alone.  Unlike gprsConnect() it leaves the
+  // +SAPBR bearer, only needed for HTTP and location, as it is.
+  bool queueDataResume() {
+    if (TINY_GSM_COMMAND_QUEUE_SIZE - commandsPending() < resumeSteps) {
+      return false;
+    }
+    void* gprs = static_cast<TinyGsmGPRS<TinyGsmSim800>*>(this);
+    if (resumeSteps >= 4) {
+      // PDP DEACT or stuck part way, the IP application must be shut first
+      sendATAsync(GF("+CIPSHUT"), dataStepDone, gprs, 60000L);
+    }
+    if (resumeSteps >= 3) {
+      // From IP INITIAL, set up as gprsStartIP() does in the same line
+      String cstt(GF("+CIPMUX=1;+CIPQSEND=1;+CIPRXGET=1;+CSTT=\""));
+      cstt += gprsApn();
+      cstt += GF("\",\"");
+      cstt += gprsUser();
+      cstt += GF("\",\"");
+      cstt += gprsPwd();
+      cstt += '"';
+      sendATAsync(cstt, dataStepDone, gprs, 60000L);
+    }
+    if (resumeSteps >= 2) {
+      sendATAsync(GF("+CIICR"), dataStepDone, gprs, 60000L);
+    }
+    sendATAsync(GF("+CIFSR;E0"), dataResumed, gprs, 10000L);
     return true;
   }
+#endif
 
   bool gprsDisconnectImpl() {
     // Shut the TCP/IP connection
@@ -405,15 +663,15 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
    */
  protected:
   // May not return the "+CCID" before the number
-  String getSimCCIDImpl() {
+  size_t getSimCCIDImpl(char* buf, size_t len) {
     sendAT(GF("+CCID"));
-    if (waitResponse(GF(GSM_NL)) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(GF(GSM_NL)) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
     // Trim out the CCID header in case it is there
-    res.replace("CCID:", "");
-    res.trim();
-    return res;
+    char* header = strstr(buf, "CCID:");
+    if (header) { memmove(header, header + 5, strlen(header + 5) + 1); }
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -506,17 +764,103 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
    */
   // Can sync with server using CNTP as per template
 
+  /*
+   * DNS functions
+   */
+ protected:
+  bool dnsResolveImpl(const char* host, IPAddress& ip, uint32_t&) {
+    sendAT(GF("+CDNSGIP=\""), host, GF("\""));
+    if (waitResponse() != 1) { return false; }
+    // +CDNSGIP: 1,<domain name>,<IP1>[,<IP2>] or +CDNSGIP: 0,<dns error code>
+    if (waitResponse(30000L, GF(GSM_NL "+CDNSGIP:")) != 1) { return false; }
+    if (streamGetIntBefore(',') != 1) {
+      streamSkipUntil('\n');
+      return false;
+    }
+    streamSkipUntil(',');  // Skip domain name
+    streamSkipUntil('\"');
+    ip = streamGetIpBefore('\"');
+    streamSkipUntil('\n');
+    return ip != IPAddress(0, 0, 0, 0);
+  }
+
   /*
    * Client related functions
    */
  protected:
+  bool setKeepAliveImpl(bool enable, uint16_t idle_s, uint16_t interval_s,
+                        uint8_t count) {
+    // AT+CIPTKA=<mode>,<keepIdle>(30-7200 s),<keepInterval>(30-600 s),
+    // <keepCount>(1-9)
+    if (!enable) {
+      sendAT(GF("+CIPTKA=0"));
+      return waitResponse() == 1;
+    }
+    sendAT(GF("+CIPTKA=1,"),
+           TinyGsmMax(TinyGsmMin(idle_s, (uint16_t)7200), (uint16_t)30), ',',
+           TinyGsmMax(TinyGsmMin(interval_s, (uint16_t)600), (uint16_t)30),
+           ',', TinyGsmMax(TinyGsmMin(count, (uint8_t)9), (uint8_t)1));
+    return waitResponse() == 1;
+  }
+
   bool modemConnect(const char* host, uint16_t port, uint8_t mux,
                     bool ssl = false, int timeout_s = 75) {
     int8_t   rsp;
     uint32_t timeout_ms = ((uint32_t)timeout_s) * 1000;
+    // SSL needs the name to check the certificate against
+    char        ip[16];
+    const char* target = ssl ? host : dnsConnectHost(host, ip);
+    if (!modemSetSSL(ssl)) { return false; }
+    sendAT(GF("+CIPSTART="), mux, ',', GF("\"TCP"), GF("\",\""), target,
+           GF("\","), port);
+    rsp = waitResponse(
+        timeout_ms, GF("CONNECT OK" GSM_NL), GF("CONNECT FAIL" GSM_NL),
+        GF("ALREADY CONNECT" GSM_NL), GF("ERROR" GSM_NL),
+        GF("CLOSE OK" GSM_NL));  // Happens when HTTPS handshake fails
+    return (1 == rsp);
+  }
+
+  // Sends +CIPSTART and leaves "<mux>, CONNECT OK" to waitResponse()
+  bool modemConnectStart(const char* host, uint16_t port, uint8_t mux,
+                         bool ssl = false) {
+    char        ip[16];
+    const char* target = ssl ? host : dnsConnectHost(host, ip);
+    if (!modemSetSSL(ssl)) { return false; }
+    sendAT(GF("+CIPSTART="), mux, ',', GF("\"TCP"), GF("\",\""), target,
+           GF("\","), port);
+    return waitResponse() == 1;
+  }
+
+  // True while a socket opened by connectAsync() waits for its result
+  bool modemConnectPending() {
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      if (sockets[mux] && sockets[mux]->sock_connecting) { return true; }
+    }
+    return false;
+  }
+
+  // Picks out "<mux>, CONNECT OK" or "<mux>, CONNECT FAIL" for a socket
+  // opened by connectAsync(); a blocking connect matches them itself
+  bool modemConnectResult(const String& data) {
+    bool ok = data.endsWith(GF("CONNECT OK" GSM_NL));
+    if (!ok && !data.endsWith(GF("CONNECT FAIL" GSM_NL))) { return false; }
+    int coma = data.lastIndexOf(',');
+    if (coma < 0) { return false; }
+    int    nl  = data.lastIndexOf('\n', coma);
+    int8_t mux = atoi(data.c_str() + nl + 1);  // stops at the comma
+    if (mux < 0 || mux >= TINY_GSM_MUX_COUNT || !sockets[mux] ||
+        !sockets[mux]->sock_connecting) {
+      return false;
+    }
+    sockets[mux]->sock_connecting = false;
+    sockets[mux]->sock_connected  = ok;
+    return true;
+  }
+
+  bool modemSetSSL(bool ssl) {
 #if !defined(TINY_GSM_MODEM_SIM900)
     sendAT(GF("+CIPSSL="), ssl);
-    rsp = waitResponse();
+    int8_t rsp = waitResponse();
     if (ssl && rsp != 1) { return false; }
 #ifdef TINY_GSM_SSL_CLIENT_AUTHENTICATION
     // set SSL options
@@ -531,13 +875,37 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     if (waitResponse() != 1) return false;
 #endif
 #endif
-    sendAT(GF("+CIPSTART="), mux, ',', GF("\"TCP"), GF("\",\""), host,
+    return true;
+  }
+
+  // In multi-connection mode a UDP socket always has a fixed remote end
+  bool modemOpenUDP(const char* host, uint16_t port, uint8_t* mux,
+                    uint16_t localPort) {
+    if (!host) { return false; }
+    char        ip[16];
+    const char* target = dnsConnectHost(host, ip);
+    if (!modemSetSSL(false)) { return false; }
+    if (localPort) {
+      // AT+CLPORT=<n>,<mode>,<port>
+      sendAT(GF("+CLPORT="), *mux, GF(",\"UDP\","), localPort);
+      waitResponse();
+    }
+    sendAT(GF("+CIPSTART="), *mux, ',', GF("\"UDP"), GF("\",\""), target,
            GF("\","), port);
-    rsp = waitResponse(
-        timeout_ms, GF("CONNECT OK" GSM_NL), GF("CONNECT FAIL" GSM_NL),
-        GF("ALREADY CONNECT" GSM_NL), GF("ERROR" GSM_NL),
-        GF("CLOSE OK" GSM_NL));  // Happens when HTTPS handshake fails
-    return (1 == rsp);
+    return waitResponse(75000L, GF("CONNECT OK" GSM_NL),
+                        GF("CONNECT FAIL" GSM_NL), GF("ALREADY CONNECT" GSM_NL),
+                        GF("ERROR" GSM_NL)) == 1;
+  }
+
+  // Incoming connections are reported as "<mux>, REMOTE IP: <ip>"
+  bool modemListen(uint16_t port) {
+    sendAT(GF("+CIPSERVER=1,"), port);
+    return waitResponse(GF("SERVER OK" GSM_NL), GFP(GSM_ERROR)) == 1;
+  }
+
+  void modemStopListening() {
+    sendAT(GF("+CIPSERVER=0"));
+    waitResponse(GF("SERVER CLOSE" GSM_NL), GFP(GSM_ERROR));
   }
 
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
@@ -572,10 +940,7 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     for (int i = 0; i < len_requested; i++) {
       uint32_t startMillis = millis();
 #ifdef TINY_GSM_USE_HEX
-      while (stream.available() < 2 &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(2, startMillis, sockets[mux]->_timeout);
       char buf[4] = {
           0,
       };
@@ -583,14 +948,15 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
       buf[1] = stream.read();
       char c = strtol(buf, NULL, 16);
 #else
-      while (!stream.available() &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(1, startMillis, sockets[mux]->_timeout);
       char c = stream.read();
 #endif
       sockets[mux]->rx.put(c);
     }
+    // The modem doesn't keep datagrams apart or say who sent them
+    if (sockets[mux]->isDatagram()) {
+      sockets[mux]->datagramReceived(len_requested, IPAddress(0, 0, 0, 0), 0);
+    }
     // DBG("### READ:", len_requested, "from", mux);
     // sockets[mux]->sock_available = modemGetAvailable(mux);
     sockets[mux]->sock_available = len_confirmed;
@@ -598,7 +964,22 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     return len_requested;
   }
 
-  size_t modemGetAvailable(uint8_t mux) {
+  // Asks how much data is waiting on each flagged socket, but leaves the
+  // state check for the end because +CIPSTATUS reports on every socket at once
+  void modemCheckAvailable() {
+    int8_t check_mux = -1;
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      GsmClientSim800* sock = sockets[mux];
+      if (sock && sock->got_data) {
+        sock->got_data       = false;
+        sock->sock_available = modemGetAvailable(mux, false);
+        if (!sock->sock_available) { check_mux = mux; }
+      }
+    }
+    if (check_mux >= 0) { modemGetConnected(check_mux); }
+  }
+
+  size_t modemGetAvailable(uint8_t mux, bool check_state = true) {
     if (!sockets[mux]) return 0;
     sendAT(GF("+CIPRXGET=4,"), mux);
     size_t result = 0;
@@ -609,18 +990,40 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
       waitResponse();
     }
     // DBG("### Available:", result, "on", mux);
-    if (!result) { sockets[mux]->sock_connected = modemGetConnected(mux); }
+    if (!result && check_state) {
+      sockets[mux]->sock_connected = modemGetConnected(mux);
+    }
     return result;
   }
 
   bool modemGetConnected(uint8_t mux) {
-    sendAT(GF("+CIPSTATUS="), mux);
-    waitResponse(GF("+CIPSTATUS"));
-    int8_t res = waitResponse(GF(",\"CONNECTED\""), GF(",\"CLOSED\""),
-                              GF(",\"CLOSING\""), GF(",\"REMOTE CLOSING\""),
-                              GF(",\"INITIAL\""));
-    waitResponse();
-    return 1 == res;
+    // Read the status of all sockets at once
+    // In multi-IP mode +CIPSTATUS gives the OK first, then the IP state, then
+    // one line for every connection the module supports:
+    // C: <n>,<bearer>,<TCP/UDP>,<IP address>,<port>,<client state>
+#if defined(TINY_GSM_MODEM_SIM900)
+    const int8_t connCount = 8;
+#else
+    const int8_t connCount = 6;
+#endif
+    sendAT(GF("+CIPSTATUS"));
+    if (waitResponse() != 1) { return false; }
+    for (int muxNo = 0; muxNo < connCount; muxNo++) {
+      if (waitResponse(GF(GSM_NL "C: ")) != 1) { break; }
+      int8_t ret_mux = streamGetIntBefore(',');
+      streamSkipUntil(',');  // Skip bearer
+      streamSkipUntil(',');  // Skip TCP/UDP
+      streamSkipUntil(',');  // Skip IP address
+      streamSkipUntil(',');  // Skip port
+      int8_t res = waitResponse(GF("CONNECTED\""), GF("CLOSED\""),
+                                GF("CLOSING\""), GF("INITIAL\""),
+                                GF("CONNECTING\""));
+      if (ret_mux >= 0 && ret_mux < TINY_GSM_MUX_COUNT && sockets[ret_mux]) {
+        sockets[ret_mux]->sock_connected = (1 == res);
+      }
+    }
+    if (!sockets[mux]) { return false; }
+    return sockets[mux]->sock_connected;
   }
 
   /*
@@ -648,13 +1051,16 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
         if (a <= 0) continue;  // Skip 0x00 bytes, just in case
         data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
+        // The result of a connectAsync() is only looked for at a line end
+        if (a == '\n' && modemConnectPending() && modemConnectResult(data)) {
+          data = "";
+        } else if (r1 && data.endsWith(r1)) {
           index = 1;
           goto finish;
         } else if (r2 && data.endsWith(r2)) {
@@ -674,6 +1080,8 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF(GSM_NL "+CIPRXGET:"))) {
           int8_t mode = streamGetIntBefore(',');
           if (mode == 1) {
@@ -704,6 +1112,12 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
           }
           data = "";
           DBG("### Closed: ", mux);
+        } else if (data.endsWith(GF("REMOTE IP:"))) {
+          int    coma = data.lastIndexOf(',');
+          int    nl   = data.lastIndexOf('\n', coma);
+          int8_t mux  = data.substring(nl + 1, coma).toInt();
+          serverIncoming(mux, streamGetIpBefore('\n'));
+          data = "";
         } else if (data.endsWith(GF("*PSNWID:"))) {
           streamSkipUntil('\n');  // Refresh network name by network
           data = "";
@@ -725,7 +1139,8 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -744,8 +1159,7 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
@@ -766,6 +1180,10 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
  protected:
   GsmClientSim800* sockets[TINY_GSM_MUX_COUNT];
   const char*      gsmNL = GSM_NL;
+  uint32_t         gprsStepMs[GPRS_STEP_COUNT] = {};
+#if TINY_GSM_COMMAND_QUEUE_SIZE > 0
+  uint8_t          resumeSteps                 = 4;
+#endif
 };
 
 #endif  // SRC_TINYGSMCLIENTSIM800_H_
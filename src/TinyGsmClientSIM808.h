@@ -41,13 +41,12 @@ class TinyGsmSim808 : public TinyGsmSim800, public TinyGsmGPS<TinyGsmSim808>, pu
 
   // get the RAW GPS output
   // works only with ans SIM808 V2
-  String getGPSrawImpl() {
+  size_t getGPSrawImpl(char* buf, size_t len) {
     sendAT(GF("+CGNSINF"));
-    if (waitResponse(10000L, GF(GSM_NL "+CGNSINF:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(10000L, GF(GSM_NL "+CGNSINF:")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   // get GPS informations
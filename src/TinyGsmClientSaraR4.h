@@ -16,6 +16,7 @@
 #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
 
 #include "TinyGsmBattery.tpp"
+#include "TinyGsmDNS.tpp"
 #include "TinyGsmGPRS.tpp"
 #include "TinyGsmGPS.tpp"
 #include "TinyGsmGSMLocation.tpp"
@@ -47,6 +48,7 @@ enum RegStatus {
 class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
                       public TinyGsmGPRS<TinyGsmSaraR4>,
                       public TinyGsmTCP<TinyGsmSaraR4, TINY_GSM_MUX_COUNT>,
+                      public TinyGsmDNS<TinyGsmSaraR4>,
                       public TinyGsmSSL<TinyGsmSaraR4>,
                       public TinyGsmBattery<TinyGsmSaraR4>,
                       public TinyGsmGSMLocation<TinyGsmSaraR4>,
@@ -57,6 +59,7 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
   friend class TinyGsmModem<TinyGsmSaraR4>;
   friend class TinyGsmGPRS<TinyGsmSaraR4>;
   friend class TinyGsmTCP<TinyGsmSaraR4, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmDNS<TinyGsmSaraR4>;
   friend class TinyGsmSSL<TinyGsmSaraR4>;
   friend class TinyGsmBattery<TinyGsmSaraR4>;
   friend class TinyGsmGSMLocation<TinyGsmSaraR4>;
@@ -80,11 +83,14 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
     }
 
     bool init(TinyGsmSaraR4* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_available = 0;
-      prev_check     = 0;
-      sock_connected = false;
-      got_data       = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      check_backoff   = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
+      got_data        = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -114,7 +120,9 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
       return sock_connected;
     }
     virtual int connect(IPAddress ip, uint16_t port, int timeout_s) {
-      return connect(TinyGsmStringFromIp(ip).c_str(), port, timeout_s);
+      TINY_GSM_ALLOC_SCOPE("connect(IPAddress)");
+      char host[16];
+      return connect(TinyGsmCharsFromIp(ip, host), port, timeout_s);
     }
     int connect(const char* host, uint16_t port) override {
       return connect(host, port, 120);
@@ -192,7 +200,9 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
       return sock_connected;
     }
     int connect(IPAddress ip, uint16_t port, int timeout_s) override {
-      return connect(TinyGsmStringFromIp(ip).c_str(), port, timeout_s);
+      TINY_GSM_ALLOC_SCOPE("connect(IPAddress)");
+      char host[16];
+      return connect(TinyGsmCharsFromIp(ip, host), port, timeout_s);
     }
     int connect(const char* host, uint16_t port) override {
       return connect(host, port, 120);
@@ -207,7 +217,7 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
    */
  public:
   explicit TinyGsmSaraR4(Stream& stream)
-      : stream(stream),
+      : stream(tapStream(stream)),
         has2GFallback(false),
         supportsAsyncSockets(false) {
     memset(sockets, 0, sizeof(sockets));
@@ -233,15 +243,16 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
 #endif
     waitResponse();
 
-    String modemName = getModemName();
+    char modemName[64];
+    getModemName(modemName, sizeof(modemName));
     DBG(GF("### Modem:"), modemName);
-    if (modemName.startsWith("u-blox SARA-R412")) {
+    if (!strncmp(modemName, "u-blox SARA-R412", 16)) {
       has2GFallback = true;
     } else {
       has2GFallback = false;
     }
-    if (modemName.startsWith("u-blox SARA-R404M") ||
-        modemName.startsWith("u-blox SARA-R410M-01B")) {
+    if (!strncmp(modemName, "u-blox SARA-R404M", 17) ||
+        !strncmp(modemName, "u-blox SARA-R410M-01B", 21)) {
       supportsAsyncSockets = false;
     } else {
       supportsAsyncSockets = true;
@@ -264,27 +275,26 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
   }
 
   // only difference in implementation is the warning on the wrong type
-  String getModemNameImpl() {
+  size_t getModemNameImpl(char* buf, size_t len) {
     sendAT(GF("+CGMI"));
-    String res1;
-    if (waitResponse(1000L, res1) != 1) { return "u-blox Cellular Modem"; }
-    res1.replace(GSM_NL "OK" GSM_NL, "");
-    res1.trim();
+    size_t n = waitResponseText(1000L, buf, len);
+    if (!n || n + 2 >= len) {
+      return TinyGsmCopyString(buf, len, "u-blox Cellular Modem");
+    }
+    buf[n++] = ' ';
 
     sendAT(GF("+GMM"));
-    String res2;
-    if (waitResponse(1000L, res2) != 1) { return "u-blox Cellular Modem"; }
-    res2.replace(GSM_NL "OK" GSM_NL, "");
-    res2.trim();
-
-    String name = res1 + String(' ') + res2;
-    DBG("### Modem:", name);
-    if (!name.startsWith("u-blox SARA-R4") &&
-        !name.startsWith("u-blox SARA-N4")) {
+    size_t n2 = waitResponseText(1000L, buf + n, len - n);
+    if (!n2) { return TinyGsmCopyString(buf, len, "u-blox Cellular Modem"); }
+    n += n2;
+
+    DBG("### Modem:", buf);
+    if (strncmp(buf, "u-blox SARA-R4", 14) &&
+        strncmp(buf, "u-blox SARA-N4", 14)) {
       DBG("### WARNING:  You are using the wrong TinyGSM modem!");
     }
 
-    return name;
+    return n;
   }
 
   bool factoryDefaultImpl() {
@@ -408,13 +418,12 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
    */
  protected:
   // This uses "CGSN" instead of "GSN"
-  String getIMEIImpl() {
+  size_t getIMEIImpl(char* buf, size_t len) {
     sendAT(GF("+CGSN"));
-    if (waitResponse(GF(GSM_NL)) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(GF(GSM_NL)) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -448,7 +457,7 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
     if (waitResponse(10000L, GF(GSM_NL "+UGPS:")) != 1) { return false; }
     return waitResponse(10000L) == 1;
   }
-  String inline getUbloxLocationRaw(int8_t sensor) {
+  size_t inline getUbloxLocationRaw(int8_t sensor, char* buf, size_t len) {
     // AT+ULOC=<mode>,<sensor>,<response_type>,<timeout>,<accuracy>
     // <mode> - 2: single shot position
     // <sensor> - 0: use the last fix in the internal database and stop the GNSS
@@ -463,19 +472,18 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
     // <accuracy> - Target accuracy in meters (1 - 999999)
     sendAT(GF("+ULOC=2,"), sensor, GF(",0,120,1"));
     // wait for first "OK"
-    if (waitResponse(10000L) != 1) { return ""; }
+    if (waitResponse(10000L) != 1) { return 0; }
     // wait for the final result - wait full timeout time
-    if (waitResponse(120000L, GF(GSM_NL "+UULOC:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(120000L, GF(GSM_NL "+UULOC:")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
-  String getGsmLocationRawImpl() {
-    return getUbloxLocationRaw(2);
+  size_t getGsmLocationRawImpl(char* buf, size_t len) {
+    return getUbloxLocationRaw(2, buf, len);
   }
-  String getGPSrawImpl() {
-    return getUbloxLocationRaw(1);
+  size_t getGPSrawImpl(char* buf, size_t len) {
+    return getUbloxLocationRaw(1, buf, len);
   }
 
   inline bool getUbloxLocation(int8_t sensor, float* lat, float* lon,
@@ -633,6 +641,20 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
     return temp;
   }
 
+  /*
+   * DNS functions
+   */
+ protected:
+  bool dnsResolveImpl(const char* host, IPAddress& ip, uint32_t&) {
+    // AT+UDNSRN=<resolution_type>,<domain_ip_string>; 0 = name to address
+    sendAT(GF("+UDNSRN=0,\""), host, GF("\""));
+    if (waitResponse(70000L, GF(GSM_NL "+UDNSRN:")) != 1) { return false; }
+    streamSkipUntil('\"');
+    ip = streamGetIpBefore('\"');
+    waitResponse();
+    return ip != IPAddress(0, 0, 0, 0);
+  }
+
   /*
    * Client related functions
    */
@@ -641,6 +663,9 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
                     bool ssl = false, int timeout_s = 120) {
     uint32_t timeout_ms  = ((uint32_t)timeout_s) * 1000;
     uint32_t startMillis = millis();
+    // SSL needs the name to check the certificate against
+    char        ip[16];
+    const char* target = ssl ? host : dnsConnectHost(host, ip);
 
     // create a socket
     sendAT(GF("+USOCR=6"));
@@ -677,7 +702,7 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
     if (supportsAsyncSockets) {
       DBG("### Opening socket asynchronously!  Socket cannot be used until "
           "the URC '+UUSOCO' appears.");
-      sendAT(GF("+USOCO="), *mux, ",\"", host, "\",", port, ",1");
+      sendAT(GF("+USOCO="), *mux, ",\"", target, "\",", port, ",1");
       if (waitResponse(timeout_ms - (millis() - startMillis),
                        GF(GSM_NL "+UUSOCO:")) == 1) {
         streamGetIntBefore(',');  // skip repeated mux
@@ -691,7 +716,7 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
       }
     } else {
       // use synchronous open
-      sendAT(GF("+USOCO="), *mux, ",\"", host, "\",", port);
+      sendAT(GF("+USOCO="), *mux, ",\"", target, "\",", port);
       int8_t rsp = waitResponse(timeout_ms - (millis() - startMillis));
       return (1 == rsp);
     }
@@ -727,6 +752,59 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
     return len;
   }
 
+  // The +UUSORD URC already says how much data is waiting, so a +USORD query
+  // is only needed for sockets flagged by the check for unannounced data.
+  // +USORD and +USOCTL only report on one socket, but the modem runs several
+  // commands given on one line, so all of those sockets are asked at once.
+  void modemCheckAvailable() {
+    uint8_t flagged = 0;
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      GsmClientSaraR4* sock = sockets[mux];
+      if (sock && sock->got_data) {
+        sock->got_data = false;
+        if (sock->sock_available) { continue; }
+        flagged |= 1 << mux;
+      }
+    }
+    if (!flagged) { return; }
+
+    // +USORD: <socket>,<length> for each, then OK
+    uint8_t empty = flagged;
+    sendATEachSocket(GF("+USORD="), GF(",0"), flagged);
+    for (int i = 0; i <= TINY_GSM_MUX_COUNT; i++) {
+      if (waitEachSocket(GF(GSM_NL "+USORD:")) != 1) { break; }
+      int8_t  mux = streamGetIntBefore(',');
+      int16_t len = streamGetIntBefore('\n');
+      if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && (flagged & (1 << mux)) &&
+          len > 0) {
+        sockets[mux]->sock_available = len;
+        empty &= ~(1 << mux);
+      }
+    }
+    if (!empty) { return; }
+
+    // +USOCTL: <socket>,10,<tcp state> for each of the rest, then OK
+    uint8_t unknown = empty;
+    sendATEachSocket(GF("+USOCTL="), GF(",10"), empty);
+    for (int i = 0; i <= TINY_GSM_MUX_COUNT; i++) {
+      if (waitEachSocket(GF(GSM_NL "+USOCTL:")) != 1) { break; }
+      int8_t mux = streamGetIntBefore(',');
+      streamSkipUntil(',');  // Skip type
+      int8_t state = streamGetIntBefore('\n');
+      if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && (empty & (1 << mux))) {
+        sockets[mux]->sock_connected = (state != 0);
+        unknown &= ~(1 << mux);
+      }
+    }
+    // A socket that has closed ends the line with an error, and the modem
+    // skips the commands after it; those sockets are asked one at a time
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      if (unknown & (1 << mux)) {
+        sockets[mux]->sock_connected = modemGetConnected(mux);
+      }
+    }
+  }
+
   size_t modemGetAvailable(uint8_t mux) {
     if (!sockets[mux]) return 0;
     // NOTE:  Querying a closed socket gives an error "operation not allowed"
@@ -796,7 +874,7 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -822,6 +900,8 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF("+UUSORD:"))) {
           int8_t  mux = streamGetIntBefore(',');
           int16_t len = streamGetIntBefore('\n');
@@ -852,7 +932,8 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -871,8 +952,7 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
@@ -85,11 +85,14 @@ class TinyGsmSequansMonarch
     }
 
     bool init(TinyGsmSequansMonarch* modem, uint8_t mux = 1) {
-      this->at       = modem;
-      sock_available = 0;
-      prev_check     = 0;
-      sock_connected = false;
-      got_data       = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      check_backoff   = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
+      got_data        = false;
 
       // adjust for zero indexed socket array vs Sequans' 1 indexed mux numbers
       // using modulus will force 6 back to 0
@@ -183,7 +186,8 @@ class TinyGsmSequansMonarch
    * Constructor
    */
  public:
-  explicit TinyGsmSequansMonarch(Stream& stream) : stream(stream) {
+  explicit TinyGsmSequansMonarch(Stream& stream)
+      : stream(tapStream(stream)) {
     memset(sockets, 0, sizeof(sockets));
   }
 
@@ -207,7 +211,7 @@ class TinyGsmSequansMonarch
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     // Make sure the module is enabled. Unlike others, the VZN20Q powers on
     // with CFUN=0 not CFUN=1 (that is, at minimum functionality instead of full
@@ -237,24 +241,19 @@ class TinyGsmSequansMonarch
     }
   }
 
-  String getModemNameImpl() {
+  size_t getModemNameImpl(char* buf, size_t len) {
     sendAT(GF("+CGMI"));
-    String res1;
-    if (waitResponse(1000L, res1) != 1) { return "unknown"; }
-    res1.replace("\r\nOK\r\n", "");
-    res1.replace("\rOK\r", "");
-    res1.trim();
+    size_t n = waitResponseText(1000L, buf, len);
+    if (!n || n + 2 >= len) { return TinyGsmCopyString(buf, len, "unknown"); }
+    buf[n++] = ' ';
 
     sendAT(GF("+CGMM"));
-    String res2;
-    if (waitResponse(1000L, res2) != 1) { return "unknown"; }
-    res2.replace("\r\nOK\r\n", "");
-    res2.replace("\rOK\r", "");
-    res2.trim();
-
-    String name = res1 + String(' ') + res2;
-    DBG("### Modem:", name);
-    return name;
+    size_t n2 = waitResponseText(1000L, buf + n, len - n);
+    if (!n2) { return TinyGsmCopyString(buf, len, "unknown"); }
+    n += n2;
+
+    DBG("### Modem:", buf);
+    return n;
   }
 
   bool factoryDefaultImpl() {
@@ -266,19 +265,6 @@ class TinyGsmSequansMonarch
     return waitResponse() == 1;
   }
 
-  void maintainImpl() {
-    for (int mux = 1; mux <= TINY_GSM_MUX_COUNT; mux++) {
-      GsmClientSequansMonarch* sock = sockets[mux % TINY_GSM_MUX_COUNT];
-      if (sock && sock->got_data) {
-        sock->got_data       = false;
-        sock->sock_available = modemGetAvailable(mux);
-        // modemGetConnected() always checks the state of ALL socks
-        modemGetConnected();
-      }
-    }
-    while (stream.available()) { waitResponse(15, NULL, NULL); }
-  }
-
   /*
    * Power functions
    */
@@ -332,12 +318,12 @@ class TinyGsmSequansMonarch
     RegStatus s = getRegistrationStatus();
     return (s == REG_OK_HOME || s == REG_OK_ROAMING);
   }
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+CGPADDR=3"));
-    if (waitResponse(10000L, GF("+CGPADDR: 3,\"")) != 1) { return ""; }
-    String res = stream.readStringUntil('\"');
+    if (waitResponse(10000L, GF("+CGPADDR: 3,\"")) != 1) { return 0; }
+    size_t n = streamGetStringBefore('\"', buf, len);
     waitResponse();
-    return res;
+    return n;
   }
 
   /*
@@ -384,13 +370,12 @@ class TinyGsmSequansMonarch
    * SIM card functions
    */
  protected:
-  String getSimCCIDImpl() {
+  size_t getSimCCIDImpl(char* buf, size_t len) {
     sendAT(GF("+SQNCCID"));
-    if (waitResponse(GF(GSM_NL "+SQNCCID:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(GF(GSM_NL "+SQNCCID:")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -552,11 +537,8 @@ class TinyGsmSequansMonarch
     int16_t len = streamGetIntBefore('\n');
     for (int i = 0; i < len; i++) {
       uint32_t startMillis = millis();
-      while (!stream.available() &&
-             ((millis() - startMillis) <
-              sockets[mux % TINY_GSM_MUX_COUNT]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(1, startMillis,
+                          sockets[mux % TINY_GSM_MUX_COUNT]->_timeout);
       char c = stream.read();
       sockets[mux % TINY_GSM_MUX_COUNT]->rx.put(c);
     }
@@ -566,6 +548,21 @@ class TinyGsmSequansMonarch
     return len;
   }
 
+  void modemCheckAvailable() {
+    bool check_state = false;
+    for (int mux = 1; mux <= TINY_GSM_MUX_COUNT; mux++) {
+      GsmClientSequansMonarch* sock = sockets[mux % TINY_GSM_MUX_COUNT];
+      if (sock && sock->got_data) {
+        sock->got_data       = false;
+        sock->sock_available = modemGetAvailable(mux);
+        check_state          = true;
+      }
+    }
+    // modemGetConnected() always checks the state of ALL socks, so it only
+    // needs to be asked once
+    if (check_state) { modemGetConnected(); }
+  }
+
   size_t modemGetAvailable(uint8_t mux) {
     sendAT(GF("+SQNSI="), mux);
     size_t result = 0;
@@ -638,7 +635,7 @@ class TinyGsmSequansMonarch
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -664,6 +661,8 @@ class TinyGsmSequansMonarch
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
         } else if (data.endsWith(GF(GSM_NL "+SQNSRING:"))) {
           int8_t  mux = streamGetIntBefore(',');
           int16_t len = streamGetIntBefore('\n');
@@ -686,7 +685,8 @@ class TinyGsmSequansMonarch
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -705,8 +705,7 @@ class TinyGsmSequansMonarch
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
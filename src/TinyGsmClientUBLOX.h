@@ -17,14 +17,17 @@
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmCalling.tpp"
+#include "TinyGsmDNS.tpp"
 #include "TinyGsmGPRS.tpp"
 #include "TinyGsmGPS.tpp"
 #include "TinyGsmGSMLocation.tpp"
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSMS.tpp"
 #include "TinyGsmSSL.tpp"
+#include "TinyGsmServer.tpp"
 #include "TinyGsmTCP.tpp"
 #include "TinyGsmTime.tpp"
+#include "TinyGsmUDP.tpp"
 
 #define GSM_NL "\r\n"
 static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
@@ -47,6 +50,9 @@ enum RegStatus {
 class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
                      public TinyGsmGPRS<TinyGsmUBLOX>,
                      public TinyGsmTCP<TinyGsmUBLOX, TINY_GSM_MUX_COUNT>,
+                     public TinyGsmUDP<TinyGsmUBLOX, TINY_GSM_MUX_COUNT>,
+                     public TinyGsmServer<TinyGsmUBLOX, TINY_GSM_MUX_COUNT>,
+                     public TinyGsmDNS<TinyGsmUBLOX>,
                      public TinyGsmSSL<TinyGsmUBLOX>,
                      public TinyGsmCalling<TinyGsmUBLOX>,
                      public TinyGsmSMS<TinyGsmUBLOX>,
@@ -57,6 +63,9 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
   friend class TinyGsmModem<TinyGsmUBLOX>;
   friend class TinyGsmGPRS<TinyGsmUBLOX>;
   friend class TinyGsmTCP<TinyGsmUBLOX, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmUDP<TinyGsmUBLOX, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmServer<TinyGsmUBLOX, TINY_GSM_MUX_COUNT>;
+  friend class TinyGsmDNS<TinyGsmUBLOX>;
   friend class TinyGsmSSL<TinyGsmUBLOX>;
   friend class TinyGsmCalling<TinyGsmUBLOX>;
   friend class TinyGsmSMS<TinyGsmUBLOX>;
@@ -80,11 +89,14 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
     }
 
     bool init(TinyGsmUBLOX* modem, uint8_t mux = 0) {
-      this->at       = modem;
-      sock_available = 0;
-      prev_check     = 0;
-      sock_connected = false;
-      got_data       = false;
+      this->at        = modem;
+      sock_available  = 0;
+      prev_check      = 0;
+      check_backoff   = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
+      got_data        = false;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -161,11 +173,23 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
     TINY_GSM_CLIENT_CONNECT_OVERRIDES
   };
 
+  /*
+   * Inner UDP Client
+   */
+ public:
+  typedef GsmUDP<GsmClientUBLOX> GsmUDPUBLOX;
+
+  /*
+   * Inner Server
+   */
+ public:
+  typedef GsmServer<GsmClientUBLOX> GsmServerUBLOX;
+
   /*
    * Constructor
    */
  public:
-  explicit TinyGsmUBLOX(Stream& stream) : stream(stream) {
+  explicit TinyGsmUBLOX(Stream& stream) : stream(tapStream(stream)) {
     memset(sockets, 0, sizeof(sockets));
   }
 
@@ -189,7 +213,7 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
 #endif
     waitResponse();
 
-    DBG(GF("### Modem:"), getModemName());
+    dbgModemName();
 
     // Enable automatic time zome update
     sendAT(GF("+CTZU=1"));
@@ -210,28 +234,27 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
   }
 
   // only difference in implementation is the warning on the wrong type
-  String getModemNameImpl() {
+  size_t getModemNameImpl(char* buf, size_t len) {
     sendAT(GF("+CGMI"));
-    String res1;
-    if (waitResponse(1000L, res1) != 1) { return "u-blox Cellular Modem"; }
-    res1.replace(GSM_NL "OK" GSM_NL, "");
-    res1.trim();
+    size_t n = waitResponseText(1000L, buf, len);
+    if (!n || n + 2 >= len) {
+      return TinyGsmCopyString(buf, len, "u-blox Cellular Modem");
+    }
+    buf[n++] = ' ';
 
     sendAT(GF("+GMM"));
-    String res2;
-    if (waitResponse(1000L, res2) != 1) { return "u-blox Cellular Modem"; }
-    res2.replace(GSM_NL "OK" GSM_NL, "");
-    res2.trim();
-
-    String name = res1 + String(' ') + res2;
-    if (name.startsWith("u-blox SARA-R4") ||
-        name.startsWith("u-blox SARA-N4")) {
+    size_t n2 = waitResponseText(1000L, buf + n, len - n);
+    if (!n2) { return TinyGsmCopyString(buf, len, "u-blox Cellular Modem"); }
+    n += n2;
+
+    if (!strncmp(buf, "u-blox SARA-R4", 14) ||
+        !strncmp(buf, "u-blox SARA-N4", 14)) {
       DBG("### WARNING:  You are using the wrong TinyGSM modem!");
-    } else if (name.startsWith("u-blox SARA-N2")) {
+    } else if (!strncmp(buf, "u-blox SARA-N2", 14)) {
       DBG("### SARA N2 NB-IoT modems not supported!");
     }
 
-    return name;
+    return n;
   }
 
   bool factoryDefaultImpl() {
@@ -305,14 +328,17 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
       return false;
   }
 
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     sendAT(GF("+UPSND=0,0"));
-    if (waitResponse(GF(GSM_NL "+UPSND:")) != 1) { return ""; }
+    if (waitResponse(GF(GSM_NL "+UPSND:")) != 1) { return 0; }
     streamSkipUntil(',');   // Skip PSD profile
     streamSkipUntil('\"');  // Skip request type
-    String res = stream.readStringUntil('\"');
-    if (waitResponse() != 1) { return ""; }
-    return res;
+    size_t n = streamGetStringBefore('\"', buf, len);
+    if (waitResponse() != 1) {
+      buf[0] = '\0';
+      return 0;
+    }
+    return n;
   }
 
   /*
@@ -404,13 +430,12 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
    */
  protected:
   // This uses "CGSN" instead of "GSN"
-  String getIMEIImpl() {
+  size_t getIMEIImpl(char* buf, size_t len) {
     sendAT(GF("+CGSN"));
-    if (waitResponse(GF(GSM_NL)) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(GF(GSM_NL)) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   /*
@@ -448,7 +473,7 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
     if (waitResponse(10000L, GF(GSM_NL "+UGPS:")) != 1) { return false; }
     return waitResponse(10000L) == 1;
   }
-  String inline getUbloxLocationRaw(int8_t sensor) {
+  size_t inline getUbloxLocationRaw(int8_t sensor, char* buf, size_t len) {
     // AT+ULOC=<mode>,<sensor>,<response_type>,<timeout>,<accuracy>
     // <mode> - 2: single shot position
     // <sensor> - 0: use the last fix in the internal database and stop the GNSS
@@ -463,19 +488,18 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
     // <accuracy> - Target accuracy in meters (1 - 999999)
     sendAT(GF("+ULOC=2,"), sensor, GF(",0,120,1"));
     // wait for first "OK"
-    if (waitResponse(10000L) != 1) { return ""; }
+    if (waitResponse(10000L) != 1) { return 0; }
     // wait for the final result - wait full timeout time
-    if (waitResponse(120000L, GF(GSM_NL "+UULOC:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    if (waitResponse(120000L, GF(GSM_NL "+UULOC:")) != 1) { return 0; }
+    streamGetStringBefore('\n', buf, len);
     waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
-  String getGsmLocationRawImpl() {
-    return getUbloxLocationRaw(2);
+  size_t getGsmLocationRawImpl(char* buf, size_t len) {
+    return getUbloxLocationRaw(2, buf, len);
   }
-  String getGPSrawImpl() {
-    return getUbloxLocationRaw(1);
+  size_t getGPSrawImpl(char* buf, size_t len) {
+    return getUbloxLocationRaw(1, buf, len);
   }
 
   inline bool getUbloxLocation(int8_t sensor, float* lat, float* lon,
@@ -623,6 +647,20 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
   // (TOBY-L)
   float getTemperatureImpl() TINY_GSM_ATTR_NOT_IMPLEMENTED;
 
+  /*
+   * DNS functions
+   */
+ protected:
+  bool dnsResolveImpl(const char* host, IPAddress& ip, uint32_t&) {
+    // AT+UDNSRN=<resolution_type>,<domain_ip_string>; 0 = name to address
+    sendAT(GF("+UDNSRN=0,\""), host, GF("\""));
+    if (waitResponse(70000L, GF(GSM_NL "+UDNSRN:")) != 1) { return false; }
+    streamSkipUntil('\"');
+    ip = streamGetIpBefore('\"');
+    waitResponse();
+    return ip != IPAddress(0, 0, 0, 0);
+  }
+
   /*
    * Client related functions
    */
@@ -631,6 +669,9 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
                     bool ssl = false, int timeout_s = 120) {
     uint32_t timeout_ms  = ((uint32_t)timeout_s) * 1000;
     uint32_t startMillis = millis();
+    // SSL needs the name to check the certificate against
+    char        ip[16];
+    const char* target = ssl ? host : dnsConnectHost(host, ip);
 
     // create a socket
     sendAT(GF("+USOCR=6"));
@@ -657,11 +698,79 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
     // waitResponse();
 
     // connect on the allocated socket
-    sendAT(GF("+USOCO="), *mux, ",\"", host, "\",", port);
+    sendAT(GF("+USOCO="), *mux, ",\"", target, "\",", port);
     int8_t rsp = waitResponse(timeout_ms - (millis() - startMillis));
     return (1 == rsp);
   }
 
+  // The listener takes a socket of its own, picked by the modem.  Incoming
+  // connections are reported with +UUSOLI.
+  bool modemListen(uint16_t port) {
+    sendAT(GF("+USOCR=6"));
+    if (waitResponse(GF(GSM_NL "+USOCR:")) != 1) { return false; }
+    serverMux = streamGetIntBefore('\n');
+    waitResponse();
+    // AT+USOLI=<socket>,<port>
+    sendAT(GF("+USOLI="), serverMux, ',', port);
+    return waitResponse() == 1;
+  }
+
+  void modemStopListening() {
+    sendAT(GF("+USOCL="), serverMux);
+    waitResponse();
+  }
+
+  // UDP sockets are always opened without a fixed remote end; every datagram
+  // is addressed with +USOST instead.  The modem picks the socket number.
+  bool modemOpenUDP(const char*, uint16_t, uint8_t* mux, uint16_t localPort) {
+    // AT+USOCR=17[,<local_port>]
+    if (localPort) {
+      sendAT(GF("+USOCR=17,"), localPort);
+    } else {
+      sendAT(GF("+USOCR=17"));
+    }
+    if (waitResponse(GF(GSM_NL "+USOCR:")) != 1) { return false; }
+    *mux = streamGetIntBefore('\n');
+    return waitResponse() == 1;
+  }
+
+  int16_t modemSendTo(const void* buff, size_t len, uint8_t mux,
+                      const char* host, uint16_t port) {
+    char ip[16];
+    sendAT(GF("+USOST="), mux, GF(",\""), dnsConnectHost(host, ip), GF("\","),
+           port, ',', (uint16_t)len);
+    if (waitResponse(GF("@")) != 1) { return 0; }
+    // 50ms delay, see AT manual section 25.10.4
+    delay(50);
+    stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+    stream.flush();
+    if (waitResponse(GF(GSM_NL "+USOST:")) != 1) { return 0; }
+    streamSkipUntil(',');  // Skip mux
+    int16_t sent = streamGetIntBefore('\n');
+    waitResponse();
+    return sent;
+  }
+
+  // +USORF reads one whole datagram, along with who sent it
+  size_t modemReadFrom(size_t size, uint8_t mux) {
+    sendAT(GF("+USORF="), mux, ',', (uint16_t)size);
+    if (waitResponse(GF(GSM_NL "+USORF:")) != 1) { return 0; }
+    streamSkipUntil(',');  // Skip mux
+    streamSkipUntil('\"');
+    IPAddress ip = streamGetIpBefore('\"');
+    streamSkipUntil(',');
+    uint16_t port = streamGetIntBefore(',');
+    int16_t  len  = streamGetIntBefore(',');
+    streamSkipUntil('\"');
+
+    for (int i = 0; i < len; i++) { moveCharFromStreamToFifo(mux); }
+    streamSkipUntil('\"');
+    waitResponse();
+    sockets[mux]->datagramReceived(len, ip, port);
+    sockets[mux]->sock_available = modemGetAvailable(mux);
+    return len;
+  }
+
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
     sendAT(GF("+USOWR="), mux, ',', (uint16_t)len);
     if (waitResponse(GF("@")) != 1) { return 0; }
@@ -678,6 +787,7 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
 
   size_t modemRead(size_t size, uint8_t mux) {
     if (!sockets[mux]) return 0;
+    if (sockets[mux]->isDatagram()) { return modemReadFrom(size, mux); }
     sendAT(GF("+USORD="), mux, ',', (uint16_t)size);
     if (waitResponse(GF(GSM_NL "+USORD:")) != 1) { return 0; }
     streamSkipUntil(',');  // Skip mux
@@ -692,8 +802,75 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
     return len;
   }
 
+  // The +UUSORD URC already says how much data is waiting, so a +USORD query
+  // is only needed for sockets flagged by the check for unannounced data.
+  // +USORD and +USOCTL only report on one socket, but the modem runs several
+  // commands given on one line, so all of those sockets are asked at once.
+  void modemCheckAvailable() {
+    uint8_t flagged = 0;
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      GsmClientUBLOX* sock = sockets[mux];
+      if (sock && sock->got_data) {
+        sock->got_data = false;
+        if (sock->sock_available) { continue; }
+        if (sock->isDatagram()) {
+          sock->sock_available = modemGetAvailable(mux);
+          continue;
+        }
+        flagged |= 1 << mux;
+      }
+    }
+    if (!flagged) { return; }
+
+    // +USORD: <socket>,<length> for each, then OK
+    uint8_t empty = flagged;
+    sendATEachSocket(GF("+USORD="), GF(",0"), flagged);
+    for (int i = 0; i <= TINY_GSM_MUX_COUNT; i++) {
+      if (waitEachSocket(GF(GSM_NL "+USORD:")) != 1) { break; }
+      int8_t  mux = streamGetIntBefore(',');
+      int16_t len = streamGetIntBefore('\n');
+      if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && (flagged & (1 << mux)) &&
+          len > 0) {
+        sockets[mux]->sock_available = len;
+        empty &= ~(1 << mux);
+      }
+    }
+    if (!empty) { return; }
+
+    // +USOCTL: <socket>,10,<tcp state> for each of the rest, then OK
+    uint8_t unknown = empty;
+    sendATEachSocket(GF("+USOCTL="), GF(",10"), empty);
+    for (int i = 0; i <= TINY_GSM_MUX_COUNT; i++) {
+      if (waitEachSocket(GF(GSM_NL "+USOCTL:")) != 1) { break; }
+      int8_t mux = streamGetIntBefore(',');
+      streamSkipUntil(',');  // Skip type
+      int8_t state = streamGetIntBefore('\n');
+      if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && (empty & (1 << mux))) {
+        sockets[mux]->sock_connected = (state != 0);
+        unknown &= ~(1 << mux);
+      }
+    }
+    // A socket that has closed ends the line with an error, and the modem
+    // skips the commands after it; those sockets are asked one at a time
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      if (unknown & (1 << mux)) {
+        sockets[mux]->sock_connected = modemGetConnected(mux);
+      }
+    }
+  }
+
   size_t modemGetAvailable(uint8_t mux) {
     if (!sockets[mux]) return 0;
+    if (sockets[mux]->isDatagram()) {
+      // A UDP socket stays open until it is closed, so only the size of the
+      // next datagram is of interest
+      sendAT(GF("+USORF="), mux, ",0");
+      if (waitResponse(GF(GSM_NL "+USORF:")) != 1) { return 0; }
+      streamSkipUntil(',');  // Skip mux
+      size_t result = streamGetIntBefore('\n');
+      waitResponse();
+      return result;
+    }
     // NOTE:  Querying a closed socket gives an error "operation not allowed"
     sendAT(GF("+USORD="), mux, ",0");
     size_t  result = 0;
@@ -761,7 +938,7 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
     uint8_t  index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -787,7 +964,10 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
         } else if (r5 && data.endsWith(r5)) {
           index = 5;
           goto finish;
-        } else if (data.endsWith(GF("+UUSORD:"))) {
+        } else if (data.endsWith(GF("REG:")) && streamRegistrationURC(data)) {
+          data = "";
+        } else if (data.endsWith(GF("+UUSORD:")) ||
+                   data.endsWith(GF("+UUSORF:"))) {
           int8_t  mux = streamGetIntBefore(',');
           int16_t len = streamGetIntBefore('\n');
           if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
@@ -797,6 +977,15 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
           }
           data = "";
           // DBG("### URC Data Received:", len, "on", mux);
+        } else if (data.endsWith(GF("+UUSOLI:"))) {
+          // +UUSOLI: <socket>,"<ip>",<port>,<listening_socket>,
+          // "<local_ip>",<listening_port>
+          int8_t mux = streamGetIntBefore(',');
+          streamSkipUntil('\"');
+          IPAddress ip = streamGetIpBefore('\"');
+          streamSkipUntil('\n');
+          serverIncoming(mux, ip);
+          data = "";
         } else if (data.endsWith(GF("+UUSOCL:"))) {
           int8_t mux = streamGetIntBefore('\n');
           if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
@@ -808,7 +997,8 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       if (data.length()) { DBG("### Unhandled:", data); }
       data = "";
@@ -827,8 +1017,7 @@ class TinyGsmUBLOX : public TinyGsmModem<TinyGsmUBLOX>,
                       GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
 #endif
                       GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
@@ -98,9 +98,11 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     }
 
     bool init(TinyGsmXBee* modem, uint8_t = 0) {
-      this->at       = modem;
-      this->mux      = 0;
-      sock_connected = false;
+      this->at        = modem;
+      this->mux       = 0;
+      sock_connected  = false;
+      sock_connecting = false;
+      auto_reconnect  = false;
 
       at->sockets[0] = this;
 
@@ -125,6 +127,7 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     }
 
     virtual int connect(IPAddress ip, uint16_t port, int timeout_s) {
+      TINY_GSM_ALLOC_SCOPE("connect(IPAddress)");
       if (timeout_s != 0) {
         DBG("Timeout [", timeout_s, "] doesn't apply here.");
       }
@@ -268,6 +271,7 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     }
 
     int connect(IPAddress ip, uint16_t port, int timeout_s) override {
+      TINY_GSM_ALLOC_SCOPE("connect(IPAddress)");
       if (timeout_s != 0) {
         DBG("Timeout [", timeout_s, "] doesn't apply here.");
       }
@@ -286,7 +290,7 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
    */
  public:
   explicit TinyGsmXBee(Stream& stream)
-      : stream(stream),
+      : stream(tapStream(stream)),
         guardTime(TINY_GSM_XBEE_GUARD_TIME),
         beeType(XBEE_UNKNOWN),
         resetPin(-1),
@@ -302,7 +306,7 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
   }
 
   TinyGsmXBee(Stream& stream, int8_t resetPin)
-      : stream(stream),
+      : stream(tapStream(stream)),
         guardTime(TINY_GSM_XBEE_GUARD_TIME),
         beeType(XBEE_UNKNOWN),
         resetPin(resetPin),
@@ -374,8 +378,8 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     return ret_val;
   }
 
-  String getModemNameImpl() {
-    return getBeeName();
+  size_t getModemNameImpl(char* buf, size_t len) {
+    return TinyGsmCopyString(buf, len, beeName());
   }
 
   void setBaudImpl(uint32_t baud) {
@@ -436,6 +440,12 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     // }
   }
 
+  size_t maintainImpl(uint32_t) {
+    // Outside of command mode anything waiting is socket data, which is read
+    // straight from the stream
+    return 0;
+  }
+
   bool factoryDefaultImpl() {
     XBEE_COMMAND_START_DECORATOR(5, false)
     sendAT(GF("RE"));
@@ -448,8 +458,8 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     return ret_val;
   }
 
-  String getModemInfoImpl() {
-    return sendATGetString(GF("HS"));
+  size_t getModemInfoImpl(char* buf, size_t len) {
+    return sendATGetString(GF("HS"), buf, len);
   }
 
   /*
@@ -481,6 +491,11 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
   }
 
   String getBeeName() {
+    return beeName();
+  }
+
+ protected:
+  const char* beeName() {
     switch (beeType) {
       case XBEE_S6B_WIFI: return "Digi XBee Wi-Fi";
       case XBEE_LTE1_VZN: return "Digi XBee Cellular LTE Cat 1";
@@ -576,7 +591,11 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     sendAT(GF("SD"));
     bool ret_val = waitResponse(120000L) == 1;
     // make sure we're really shut down
-    if (ret_val) { ret_val &= (sendATGetString(GF("AI")) == "2D"); }
+    if (ret_val) {
+      char ai[4];
+      sendATGetString(GF("AI"), ai, sizeof(ai));
+      ret_val &= !strcmp(ai, "2D");
+    }
     XBEE_COMMAND_END_DECORATOR
     return ret_val;
   }
@@ -749,16 +768,13 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     return retVal;
   }
 
-  String getLocalIPImpl() {
-    XBEE_COMMAND_START_DECORATOR(5, "")
+  size_t getLocalIPImpl(char* buf, size_t len) {
+    XBEE_COMMAND_START_DECORATOR(5, 0)
     sendAT(GF("MY"));
-    String IPaddr;
-    IPaddr.reserve(16);
     // wait for the response - this response can be very slow
-    IPaddr = readResponseString(30000);
+    size_t n = readResponseString(buf, len, 30000);
     XBEE_COMMAND_END_DECORATOR
-    IPaddr.trim();
-    return IPaddr;
+    return n;
   }
 
   /*
@@ -839,7 +855,7 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
         changesMade = true;
       }
     }
-    changesMade |= changeSettingIfNeeded(GF("AN"), String(apn));  // Set the APN
+    changesMade |= changeSettingIfNeeded(GF("AN"), apn);  // Set the APN
 
     changesMade |= changeSettingIfNeeded(GF("AM"), 0x0,
                                          5000L);  // Airplane mode off
@@ -864,8 +880,25 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     return isNetworkConnected();
   }
 
-  String getOperatorImpl() {
-    return sendATGetString(GF("MN"));
+  // For gprsConnectAsync() and sockets reconnecting on their own.  The
+  // module joins the network by itself once it has the settings, so this
+  // hands them over once and then reports 0 until it has joined.
+  int8_t restoreDataConnectionImpl() {
+    if (isNetworkConnected()) {
+      restoreState = RESTORE_IDLE;
+      return 1;
+    }
+    if (restoreState == RESTORE_RESUMING) { return 0; }
+    if (beeType == XBEE_S6B_WIFI || !*gprsApn() ||
+        !gprsConnectImpl(gprsApn(), gprsUser(), gprsPwd())) {
+      return -1;
+    }
+    restoreState = RESTORE_RESUMING;
+    return 0;
+  }
+
+  size_t getOperatorImpl(char* buf, size_t len) {
+    return sendATGetString(GF("MN"), buf, len);
   }
 
   /*
@@ -880,16 +913,16 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     return false;
   }
 
-  String getSimCCIDImpl() {
-    return sendATGetString(GF("S#"));
+  size_t getSimCCIDImpl(char* buf, size_t len) {
+    return sendATGetString(GF("S#"), buf, len);
   }
 
-  String getIMEIImpl() {
-    return sendATGetString(GF("IM"));
+  size_t getIMEIImpl(char* buf, size_t len) {
+    return sendATGetString(GF("IM"), buf, len);
   }
 
-  String getIMSIImpl() {
-    return sendATGetString(GF("II"));
+  size_t getIMSIImpl(char* buf, size_t len) {
+    return sendATGetString(GF("II"), buf, len);
   }
 
   SimStatus getSimStatusImpl(uint32_t) {
@@ -900,7 +933,8 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
    * Messaging functions
    */
  protected:
-  String sendUSSDImpl(const String& code) TINY_GSM_ATTR_NOT_AVAILABLE;
+  size_t sendUSSDImpl(const char* code, char* buf,
+                      size_t len) TINY_GSM_ATTR_NOT_AVAILABLE;
 
   bool sendSMSImpl(const String& number, const String& text) {
     bool changesMade = false;
@@ -984,12 +1018,10 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
 
   float getTemperatureImpl() {
     XBEE_COMMAND_START_DECORATOR(5, static_cast<float>(-9999))
-    String res = sendATGetString(GF("TP"));
-    if (res == "") { return static_cast<float>(-9999); }
-    char buf[5] = {
-        0,
-    };
-    res.toCharArray(buf, 5);
+    char buf[5];
+    if (!sendATGetString(GF("TP"), buf, sizeof(buf))) {
+      return static_cast<float>(-9999);
+    }
     int8_t intRes = (int8_t)strtol(
         buf, 0,
         16);  // degrees Celsius displayed in 8-bit two's complement format.
@@ -1010,16 +1042,15 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
   }
 
   IPAddress getOperatingIP() {
-    String strIP;
-    strIP.reserve(16);
+    char strIP[24];
 
     XBEE_COMMAND_START_DECORATOR(5, IPAddress(0, 0, 0, 0))
     sendAT(GF("OD"));
-    strIP = stream.readStringUntil('\r');  // read result
-    strIP.trim();
+    streamGetStringBefore('\r', strIP, sizeof(strIP));  // read result
+    TinyGsmTrim(strIP);
     XBEE_COMMAND_END_DECORATOR
 
-    if (strIP != "" && strIP != GF("ERROR")) {
+    if (strIP[0] && strcmp(strIP, "ERROR")) {
       return TinyGsmIpFromString(strIP);
     } else {
       return IPAddress(0, 0, 0, 0);
@@ -1027,8 +1058,7 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
   }
 
   IPAddress lookupHostIP(const char* host, int timeout_s = 45) {
-    String strIP;
-    strIP.reserve(16);
+    char     strIP[24];
     uint32_t startMillis = millis();
     uint32_t timeout_ms  = ((uint32_t)timeout_s) * 1000;
     bool     gotIP       = false;
@@ -1042,9 +1072,9 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
       while (stream.available() < 4 && (millis() - startMillis < timeout_ms)) {
         TINY_GSM_YIELD()
       }
-      strIP = stream.readStringUntil('\r');  // read result
-      strIP.trim();
-      if (strIP != "" && strIP != GF("ERROR")) {
+      streamGetStringBefore('\r', strIP, sizeof(strIP));  // read result
+      TinyGsmTrim(strIP);
+      if (strIP[0] && strcmp(strIP, "ERROR")) {
         gotIP = true;
         break;
       }
@@ -1067,8 +1097,8 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
 
     // If this is a new host name, replace the saved host and wipe out the saved
     // host IP
-    if (this->savedHost != String(host)) {
-      this->savedHost = String(host);
+    if (this->savedHost != host) {
+      this->savedHost = host;
       savedHostIP     = IPAddress(0, 0, 0, 0);
     }
 
@@ -1106,15 +1136,18 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     if (ip != savedIP) {  // Can skip almost everything if there's no
                           // change in the IP address
       savedIP = ip;       // Set the newly requested IP address
-      String host;
-      host.reserve(16);
-      host += ip[0];
-      host += ".";
-      host += ip[1];
-      host += ".";
-      host += ip[2];
-      host += ".";
-      host += ip[3];
+      char host[16];
+      char portHex[5];
+      GsmClient::TinyGsmCharsFromIp(ip, host);
+      // The port goes in as hex, in capitals as the XBee reads it back
+      int8_t digits = 0;
+      for (int8_t shift = 12; shift >= 0; shift -= 4) {
+        uint8_t nibble = (port >> shift) & 0xF;
+        if (nibble || digits || !shift) {
+          portHex[digits++] = "0123456789ABCDEF"[nibble];
+        }
+      }
+      portHex[digits] = '\0';
 
       if (ssl) {
         // Put in SSL over TCP communication mode
@@ -1125,9 +1158,9 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
       }
 
       changesMade |= changeSettingIfNeeded(
-          GF("DL"), String(host));  // Set the "Destination Address Low"
+          GF("DL"), host);  // Set the "Destination Address Low"
       changesMade |= changeSettingIfNeeded(
-          GF("DE"), String(port, HEX));  // Set the destination port
+          GF("DE"), portHex);  // Set the destination port
 
       if (changesMade) { success &= writeChanges(); }
     }
@@ -1154,7 +1187,8 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
 
     // Get the current socket timeout
     sendAT(GF("TM"));
-    String timeoutUsed = readResponseString(5000L);
+    char timeoutUsed[8];
+    readResponseString(timeoutUsed, sizeof(timeoutUsed), 5000L);
 
     // For WiFi models, there's no direct way to close the socket.  This is a
     // hack to shut the socket by setting the timeout to zero.
@@ -1299,7 +1333,8 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
           case 0x21:
           case 0x27: {
             sendAT(GF("TM"));  // Get socket timeout
-            String timeoutUsed = readResponseString(5000L);
+            char timeoutUsed[8];
+            readResponseString(timeoutUsed, sizeof(timeoutUsed), 5000L);
             sendAT(GF("TM"), timeoutUsed);  // Re-set socket timeout
             waitResponse(5000L);            // This response can be slow
           }
@@ -1356,7 +1391,7 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     int8_t   index       = 0;
     uint32_t startMillis = millis();
     do {
-      TINY_GSM_YIELD();
+      streamWaitAvailable(1, startMillis, timeout_ms);
       while (stream.available() > 0) {
         TINY_GSM_YIELD();
         int8_t a = stream.read();
@@ -1381,7 +1416,8 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
       }
     } while (millis() - startMillis < timeout_ms);
   finish:
-    if (!index) {
+    atStatsResponse(index, data.length());
+    if (!index && !replyContinues(data)) {
       data.trim();
       data.replace(GSM_NL GSM_NL, GSM_NL);
       data.replace(GSM_NL, "\r\n    ");
@@ -1403,8 +1439,7 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
   int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
                       GsmConstStr r2 = GFP(GSM_ERROR), GsmConstStr r3 = NULL,
                       GsmConstStr r4 = NULL, GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return waitResponseReused(timeout_ms, r1, r2, r3, r4, r5);
   }
 
   int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
@@ -1474,7 +1509,7 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     sendAT(GF("HS"));  // Get the "Hardware Series";
     int16_t intRes = readResponseInt();
     beeType        = (XBeeType)intRes;
-    DBG(GF("### Modem: "), getModemName());
+    dbgModemName();
   }
 
   String readResponseString(uint32_t timeout_ms = 1000) {
@@ -1487,27 +1522,33 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     return res;
   }
 
+  size_t readResponseString(char* buf, size_t len,
+                            uint32_t timeout_ms = 1000) {
+    TINY_GSM_YIELD();
+    uint32_t startMillis = millis();
+    while (!stream.available() && millis() - startMillis < timeout_ms) {}
+    streamGetStringBefore('\r', buf, len);  // lines end with carriage returns
+    return TinyGsmTrim(buf);
+  }
+
   int16_t readResponseInt(uint32_t timeout_ms = 1000) {
-    String res = readResponseString(
-        timeout_ms);  // it just works better reading a string first
-    if (res == "") res = "FF";
-    char buf[5] = {
-        0,
-    };
-    res.toCharArray(buf, 5);
+    char buf[16];
+    // it just works better reading a string first
+    if (!readResponseString(buf, sizeof(buf), timeout_ms)) { return 0xFF; }
+    buf[4]         = '\0';
     int16_t intRes = strtol(buf, 0, 16);
     return intRes;
   }
 
-  String sendATGetString(GsmConstStr cmd) {
-    XBEE_COMMAND_START_DECORATOR(5, "")
+  size_t sendATGetString(GsmConstStr cmd, char* buf, size_t len) {
+    XBEE_COMMAND_START_DECORATOR(5, 0)
     sendAT(cmd);
-    String res = readResponseString();
+    size_t n = readResponseString(buf, len);
     XBEE_COMMAND_END_DECORATOR
-    return res;
+    return n;
   }
 
-  bool changeSettingIfNeeded(GsmConstStr cmd, int16_t newValue,
+  bool changeSettingIfNeeded(GsmConstStr cmd, int newValue,
                              uint32_t timeout_ms = 1000L) {
     sendAT(cmd);
     if (readResponseInt() != newValue) {
@@ -1521,10 +1562,13 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     return false;
   }
 
-  bool changeSettingIfNeeded(GsmConstStr cmd, String newValue,
+  // A value too long for current is simply written again each time
+  bool changeSettingIfNeeded(GsmConstStr cmd, const char* newValue,
                              uint32_t timeout_ms = 1000L) {
+    char current[64];
     sendAT(cmd);
-    if (readResponseString() != newValue) {
+    readResponseString(current, sizeof(current));
+    if (strcmp(current, newValue)) {
       sendAT(cmd, newValue);
       // return false if we attempted to change but failed
       if (waitResponse(timeout_ms) != 1) { return false; }
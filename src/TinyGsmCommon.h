@@ -28,6 +28,28 @@
 #include <Client.h>
 #endif
 
+// How many commands sendATAsync() can hold, including the one waiting for
+// its reply.  The queue, and the Strings it and the short waitResponse()
+// forms keep their replies in, take RAM on every modem; 0 leaves them out,
+// which is the default on AVR and with TINY_GSM_NO_HEAP.  Without the queue
+// sendATAsync() fails and everything else blocks as it always has.
+#if !defined(TINY_GSM_COMMAND_QUEUE_SIZE)
+#if defined(__AVR__) || defined(TINY_GSM_NO_HEAP)
+#define TINY_GSM_COMMAND_QUEUE_SIZE 0
+#else
+#define TINY_GSM_COMMAND_QUEUE_SIZE 4
+#endif
+#endif
+#if defined(TINY_GSM_NO_HEAP) && TINY_GSM_COMMAND_QUEUE_SIZE > 0
+#error "The command queue keeps its commands and replies in Strings"
+#endif
+
+// Longest host name kept by the DNS cache, socket pools and UDP clients,
+// including the terminating null.  Longer ones still work, but aren't kept.
+#if !defined(TINY_GSM_HOST_LEN)
+#define TINY_GSM_HOST_LEN 64
+#endif
+
 #ifndef TINY_GSM_YIELD_MS
 #define TINY_GSM_YIELD_MS 0
 #endif
@@ -41,6 +63,13 @@
   __attribute__((error("Not available on this modem type")))
 #define TINY_GSM_ATTR_NOT_IMPLEMENTED __attribute__((error("Not implemented")))
 
+// With TINY_GSM_NO_HEAP defined, the public functions handing back a String
+// are left out; each has an overload filling a buffer instead.  So is the
+// command queue, which keeps Strings of its own: asking for one is a compile
+// error.  What is still put on the heap is the text of a reply while
+// waitResponse() reads it, and the copy of its host kept by a socket
+// reconnecting on its own.
+
 #if defined(__AVR__) && !defined(__AVR_ATmega4809__)
 #define TINY_GSM_PROGMEM PROGMEM
 typedef const __FlashStringHelper* GsmConstStr;
@@ -90,6 +119,51 @@ const T& TinyGsmMax(const T& a, const T& b) {
   return (b < a) ? a : b;
 }
 
+// Empties a buffer about to be filled with a C string; false if it has no room
+// even for that
+inline bool TinyGsmClearBuffer(char* buf, size_t len) {
+  if (!buf || !len) { return false; }
+  buf[0] = '\0';
+  return true;
+}
+
+// Copies str into buf, cut to fit; returns the length copied
+inline size_t TinyGsmCopyString(char* buf, size_t len, const char* str) {
+  if (!len) { return 0; }
+  size_t n = TinyGsmMin(strlen(str), len - 1);
+  memmove(buf, str, n);
+  buf[n] = '\0';
+  return n;
+}
+
+// Copies str into buf only if all of it fits, otherwise empties buf; false
+// if it didn't fit
+inline bool TinyGsmKeepString(char* buf, size_t len, const char* str) {
+  if (!len) { return false; }
+  if (strlen(str) >= len) {
+    buf[0] = '\0';
+    return false;
+  }
+  TinyGsmCopyString(buf, len, str);
+  return true;
+}
+
+// Strips white space from both ends of a C string in place, like
+// String::trim(); returns the new length
+inline size_t TinyGsmTrim(char* buf) {
+  size_t start = 0;
+  size_t end   = strlen(buf);
+  while (start < end && isspace(static_cast<unsigned char>(buf[start]))) {
+    start++;
+  }
+  while (end > start && isspace(static_cast<unsigned char>(buf[end - 1]))) {
+    end--;
+  }
+  if (start) { memmove(buf, buf + start, end - start); }
+  buf[end - start] = '\0';
+  return end - start;
+}
+
 template <class T>
 uint32_t TinyGsmAutoBaud(T& SerialAT, uint32_t minimum = 9600,
                          uint32_t maximum = 115200) {
@@ -116,4 +190,10 @@ uint32_t TinyGsmAutoBaud(T& SerialAT, uint32_t minimum = 9600,
   return 0;
 }
 
+#if defined(TINY_GSM_ALLOC_STATS)
+#include "TinyGsmAllocStats.h"
+#else
+#define TINY_GSM_ALLOC_SCOPE(call)
+#endif
+
 #endif  // SRC_TINYGSMCOMMON_H_
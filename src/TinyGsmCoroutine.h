@@ -0,0 +1,319 @@
+/**
+ * @file       TinyGsmCoroutine.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef SRC_TINYGSMCOROUTINE_H_
+#define SRC_TINYGSMCOROUTINE_H_
+
+// C++20 coroutine front-end for host builds.  Include it after
+// TinyGsmClient.h.  One TinyGsmEventLoop drives any number of modems and
+// the coroutines using them from a single thread:
+//
+//   TinyGsmTask session(TinyGsmEventLoop& loop, TinyGsm& modem,
+//                       TinyGsmClient& client) {
+//     if (!co_await loop.gprsConnectAsync(modem, "apn")) { co_return; }
+//     TinyGsmCommandResult csq = co_await loop.command(modem, "+CSQ");
+//     uint8_t buf[64];
+//     int     len = co_await loop.read(client, buf, sizeof(buf));
+//   }
+//
+//   loop.addModem(modem);
+//   session(loop, modem, client);
+//   loop.run();
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "TinyGsmCommon.h"
+
+// Longest run() sleeps between passes when no coroutine can go on, so those
+// waiting on something other than the modem are still checked
+#if !defined(TINY_GSM_LOOP_IDLE_MS)
+#define TINY_GSM_LOOP_IDLE_MS 10
+#endif
+
+// Return type for coroutines started on the event loop.  The coroutine runs
+// straight away up to its first co_await and cleans up after itself when it
+// finishes.
+struct TinyGsmTask {
+  struct promise_type {
+    TinyGsmTask get_return_object() {
+      return {};
+    }
+    std::suspend_never initial_suspend() noexcept {
+      return {};
+    }
+    std::suspend_never final_suspend() noexcept {
+      return {};
+    }
+    void return_void() {}
+    void unhandled_exception() {
+      std::terminate();
+    }
+  };
+};
+
+struct TinyGsmCommandResult {
+  int8_t index;  // the response that matched, 0 on a timeout
+  String data;
+};
+
+class TinyGsmEventLoop {
+ public:
+  // Awaited by co_await until(); resumes true once ready() holds, or false
+  // after timeout_ms
+  class Condition {
+   public:
+    Condition(TinyGsmEventLoop& loop, std::function<bool()> ready,
+              uint32_t timeout_ms)
+        : loop(loop),
+          ready(std::move(ready)),
+          timeout_ms(timeout_ms) {}
+
+    bool await_ready() {
+      return ready();
+    }
+    void await_suspend(std::coroutine_handle<> handle) {
+      loop.waitFor(ready, handle, timeout_ms, &timed_out);
+    }
+    bool await_resume() {
+      return !timed_out;
+    }
+
+   protected:
+    TinyGsmEventLoop&     loop;
+    std::function<bool()> ready;
+    uint32_t              timeout_ms;
+    bool                  timed_out = false;
+  };
+
+  // Awaited by co_await command(); queues the command with sendATAsync()
+  // as soon as there is room and resumes with its result
+  template <class Modem>
+  class Command {
+   public:
+    Command(TinyGsmEventLoop& loop, Modem& modem, const String& cmd,
+            uint32_t timeout_ms, GsmConstStr r1, GsmConstStr r2)
+        : loop(loop),
+          modem(modem),
+          cmd(cmd),
+          timeout_ms(timeout_ms),
+          r1(r1),
+          r2(r2) {}
+
+    bool await_ready() {
+      return false;
+    }
+    void await_suspend(std::coroutine_handle<> handle) {
+      // The command has its own timeout, so the loop doesn't need one
+      loop.waitFor(
+          [this]() {
+            if (!queued) {
+              queued = modem.sendATAsync(cmd, onReply, this, timeout_ms, r1,
+                                         r2);
+              // The next pass sends it, so that one mustn't sleep
+              loop.progress |= queued;
+            }
+            return done;
+          },
+          handle, 0xFFFFFFFF, NULL);
+    }
+    TinyGsmCommandResult await_resume() {
+      return std::move(result);
+    }
+
+   protected:
+    static void onReply(int8_t index, String& data, void* arg) {
+      Command* self      = static_cast<Command*>(arg);
+      self->result.index = index;
+      self->result.data  = data;
+      self->done         = true;
+    }
+
+    TinyGsmEventLoop&    loop;
+    Modem&               modem;
+    String               cmd;
+    uint32_t             timeout_ms;
+    GsmConstStr          r1;
+    GsmConstStr          r2;
+    bool                 queued = false;
+    bool                 done   = false;
+    TinyGsmCommandResult result = {0, String()};
+  };
+
+  // Awaited by co_await read(); resumes with the number of bytes read once
+  // some have arrived, or -1 if the socket closed or timeout_ms passed first
+  template <class Client>
+  class Read : public Condition {
+   public:
+    Read(TinyGsmEventLoop& loop, Client& client, uint8_t* buf, size_t size,
+         uint32_t timeout_ms)
+        : Condition(
+              loop,
+              [&client]() {
+                return client.available() > 0 || !client.connected();
+              },
+              timeout_ms),
+          client(client),
+          buf(buf),
+          size(size) {}
+
+    int await_resume() {
+      int waiting = client.available();
+      if (timed_out || waiting <= 0) { return -1; }
+      return client.read(buf, TinyGsmMin(size, static_cast<size_t>(waiting)));
+    }
+
+   protected:
+    Client&  client;
+    uint8_t* buf;
+    size_t   size;
+  };
+
+  // Awaited by co_await gprsConnectAsync(); starts the modem's
+  // gprsConnectAsync() and resumes true once the connection is up, or false
+  // if it couldn't be made or timeout_ms passed first
+  template <class Modem>
+  class GprsConnect : public Condition {
+   public:
+    GprsConnect(TinyGsmEventLoop& loop, Modem& modem, const char* apn,
+                const char* user, const char* pwd, uint32_t timeout_ms)
+        : Condition(
+              loop,
+              [&modem]() { return modem.gprsConnectStatus() != 0; },
+              timeout_ms),
+          modem(modem) {
+      modem.gprsConnectAsync(apn, user, pwd);
+    }
+
+    bool await_resume() {
+      return !timed_out && modem.gprsConnectStatus() == 1;
+    }
+
+   protected:
+    Modem& modem;
+  };
+
+  // Has the loop call maintain() on the modem each pass, spending at most
+  // budget_us on it.  Between passes with nothing to do run() waits on the
+  // modem through its wait strategy (setWaitStrategy()), so give it one
+  // that sleeps, such as TinyGsmPollWait, to keep the thread idle.
+  template <class Modem>
+  void addModem(Modem& modem, uint32_t budget_us = 1000) {
+    pollers.push_back([&modem, budget_us]() { modem.maintain(budget_us); });
+    idlers.push_back([&modem](uint32_t timeout_ms) {
+      return modem.waitForData(timeout_ms);
+    });
+  }
+
+  Condition until(std::function<bool()> ready,
+                  uint32_t               timeout_ms = 0xFFFFFFFF) {
+    return Condition(*this, std::move(ready), timeout_ms);
+  }
+  Condition sleep(uint32_t ms) {
+    return Condition(*this, []() { return false; }, ms);
+  }
+  template <class Modem>
+  Command<Modem> command(Modem& modem, const String& cmd,
+                         uint32_t timeout_ms = 1000L, GsmConstStr r1 = NULL,
+                         GsmConstStr r2 = NULL) {
+    return Command<Modem>(*this, modem, cmd, timeout_ms, r1, r2);
+  }
+  template <class Modem>
+  GprsConnect<Modem> gprsConnectAsync(Modem& modem, const char* apn,
+                                      const char* user       = NULL,
+                                      const char* pwd        = NULL,
+                                      uint32_t    timeout_ms = 0xFFFFFFFF) {
+    return GprsConnect<Modem>(*this, modem, apn, user, pwd, timeout_ms);
+  }
+  template <class Client>
+  Read<Client> read(Client& client, uint8_t* buf, size_t size,
+                    uint32_t timeout_ms = 0xFFFFFFFF) {
+    return Read<Client>(*this, client, buf, size, timeout_ms);
+  }
+
+  // Maintains every modem once and resumes the coroutines that can go on.
+  // Returns false once no coroutine is waiting any more.
+  bool runOnce() {
+    progress = false;
+    for (auto& poll : pollers) { poll(); }
+    std::vector<Waiter> waiting;
+    waiting.swap(waiters);
+    for (auto& waiter : waiting) {
+      if (waiter.ready()) {
+        progress = true;
+        waiter.handle.resume();
+      } else if (waiter.timed_out &&
+                 millis() - waiter.start >= waiter.timeout_ms) {
+        progress          = true;
+        *waiter.timed_out = true;
+        waiter.handle.resume();
+      } else {
+        waiters.push_back(std::move(waiter));
+      }
+    }
+    return !waiters.empty();
+  }
+  void run() {
+    while (runOnce()) {
+      if (!progress) { idle(); }
+    }
+  }
+
+ protected:
+  struct Waiter {
+    std::function<bool()>   ready;
+    std::coroutine_handle<> handle;
+    uint32_t                start;
+    uint32_t                timeout_ms;
+    bool*                   timed_out;
+  };
+
+  // Sleeps until a modem sends something or the earliest timeout is due, at
+  // most TINY_GSM_LOOP_IDLE_MS
+  void idle() {
+    uint32_t wait_ms = TINY_GSM_LOOP_IDLE_MS;
+    uint32_t now     = millis();
+    for (auto& waiter : waiters) {
+      if (!waiter.timed_out) { continue; }
+      uint32_t elapsed = now - waiter.start;
+      if (elapsed >= waiter.timeout_ms) { return; }
+      wait_ms = TinyGsmMin(wait_ms, waiter.timeout_ms - elapsed);
+    }
+    if (idlers.empty()) {
+      delay(wait_ms);
+      return;
+    }
+    // With several modems each gets its share of the wait in turn
+    uint32_t share = TinyGsmMax(wait_ms / static_cast<uint32_t>(idlers.size()),
+                                static_cast<uint32_t>(1));
+    for (auto& wait : idlers) {
+      if (wait(share)) { return; }
+    }
+  }
+
+  void waitFor(std::function<bool()> ready, std::coroutine_handle<> handle,
+               uint32_t timeout_ms, bool* timed_out) {
+    waiters.push_back({std::move(ready), handle,
+                       static_cast<uint32_t>(millis()), timeout_ms,
+                       timed_out});
+  }
+
+  std::vector<std::function<void()>>         pollers;
+  std::vector<std::function<bool(uint32_t)>> idlers;
+  std::vector<Waiter>                        waiters;
+  bool progress = false;  // a coroutine went on, or a command was queued
+};
+
+#endif
+
+#endif  // SRC_TINYGSMCOROUTINE_H_
@@ -0,0 +1,154 @@
+/**
+ * @file       TinyGsmDNS.tpp
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef SRC_TINYGSMDNS_H_
+#define SRC_TINYGSMDNS_H_
+
+#include "TinyGsmCommon.h"
+
+#define TINY_GSM_MODEM_HAS_DNS
+
+// Number of host names to remember; the least recently used one is dropped
+// to make room for a new one.  Each takes TINY_GSM_HOST_LEN bytes for the
+// name; names longer than that are resolved every time.
+#if !defined(TINY_GSM_DNS_CACHE_SIZE)
+#if defined(__AVR__)
+#define TINY_GSM_DNS_CACHE_SIZE 2
+#else
+#define TINY_GSM_DNS_CACHE_SIZE 4
+#endif
+#endif
+
+// How long to trust an address when the modem doesn't give the record's TTL
+#if !defined(TINY_GSM_DNS_TTL_MS)
+#define TINY_GSM_DNS_TTL_MS 300000L
+#endif
+
+// How long to remember that a name could not be resolved
+#if !defined(TINY_GSM_DNS_NEGATIVE_TTL_MS)
+#define TINY_GSM_DNS_NEGATIVE_TTL_MS 30000L
+#endif
+
+template <class modemType>
+class TinyGsmDNS {
+ public:
+  /*
+   * DNS functions
+   */
+  // Returns the address of host, asking the modem only if it isn't cached.
+  // Returns 0.0.0.0 if the name can't be resolved.
+  IPAddress resolve(const char* host) {
+    TINY_GSM_ALLOC_SCOPE("resolve");
+    DNSEntry* entry = dnsLookup(host);
+    if (entry) { return entry->ip; }
+    return dnsResolve(host)->ip;
+  }
+  // Resolves host ahead of time if it isn't cached or will expire soon, so
+  // a later connect doesn't have to wait for it
+  bool prefetchHost(const char* host) {
+    DNSEntry* entry = dnsLookup(host);
+    // Refresh entries in the last quarter of their lifetime
+    if (!entry ||
+        millis() - entry->stamp > entry->ttl_ms - entry->ttl_ms / 4) {
+      entry = dnsResolve(host);
+    }
+    return entry->ip != IPAddress(0, 0, 0, 0);
+  }
+  void clearDNSCache() {
+    for (uint8_t i = 0; i < TINY_GSM_DNS_CACHE_SIZE; i++) {
+      dnsCache[i].host[0] = '\0';
+    }
+  }
+
+  /*
+   * CRTP Helper
+   */
+ protected:
+  inline const modemType& thisModem() const {
+    return static_cast<const modemType&>(*this);
+  }
+  inline modemType& thisModem() {
+    return static_cast<modemType&>(*this);
+  }
+
+  /*
+   * DNS functions
+   */
+ protected:
+  struct DNSEntry {
+    char      host[TINY_GSM_HOST_LEN];  // empty for an unused entry
+    IPAddress ip;  // 0.0.0.0 for a name that didn't resolve
+    uint32_t  stamp;
+    uint32_t  ttl_ms;
+    uint32_t  used;
+  };
+
+  // The host to give the modem's connect command: the cached address as a
+  // literal, written into ip, when there is one, otherwise the name itself
+  // for the modem to resolve
+  const char* dnsConnectHost(const char* host, char (&ip)[16]) {
+    for (const char* c = host; *c; c++) {
+      if (*c != '.' && (*c < '0' || *c > '9')) {
+        IPAddress addr = resolve(host);
+        if (addr == IPAddress(0, 0, 0, 0)) { break; }
+        return modemType::GsmClient::TinyGsmCharsFromIp(addr, ip);
+      }
+    }
+    return host;
+  }
+
+  DNSEntry* dnsLookup(const char* host) {
+    for (uint8_t i = 0; i < TINY_GSM_DNS_CACHE_SIZE; i++) {
+      DNSEntry& entry = dnsCache[i];
+      if (entry.host[0] && !strcmp(entry.host, host)) {
+        if (millis() - entry.stamp >= entry.ttl_ms) {
+          entry.host[0] = '\0';
+          return NULL;
+        }
+        entry.used = millis();
+        return &entry;
+      }
+    }
+    return NULL;
+  }
+
+  DNSEntry* dnsResolve(const char* host) {
+    DNSEntry* entry = &dnsCache[0];
+    for (uint8_t i = 0; i < TINY_GSM_DNS_CACHE_SIZE; i++) {
+      if (!dnsCache[i].host[0] || !strcmp(dnsCache[i].host, host)) {
+        entry = &dnsCache[i];
+        break;
+      }
+      if (millis() - dnsCache[i].used > millis() - entry->used) {
+        entry = &dnsCache[i];
+      }
+    }
+    IPAddress ip(0, 0, 0, 0);
+    uint32_t  ttl_ms = TINY_GSM_DNS_TTL_MS;
+    if (!thisModem().dnsResolveImpl(host, ip, ttl_ms)) {
+      ip     = IPAddress(0, 0, 0, 0);
+      ttl_ms = TINY_GSM_DNS_NEGATIVE_TTL_MS;
+    }
+    // A name too long to keep leaves the entry unused
+    TinyGsmKeepString(entry->host, sizeof(entry->host), host);
+    entry->ip     = ip;
+    entry->stamp  = millis();
+    entry->ttl_ms = ttl_ms;
+    entry->used   = entry->stamp;
+    return entry;
+  }
+
+  // Asks the modem for the address of host.  May lower ttl_ms if the modem
+  // reports the record's TTL.
+  bool dnsResolveImpl(const char* host, IPAddress& ip,
+                      uint32_t& ttl_ms) TINY_GSM_ATTR_NOT_IMPLEMENTED;
+
+  DNSEntry dnsCache[TINY_GSM_DNS_CACHE_SIZE] = {};
+};
+
+#endif  // SRC_TINYGSMDNS_H_
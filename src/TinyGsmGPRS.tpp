@@ -13,6 +13,12 @@
 
 #define TINY_GSM_MODEM_HAS_GPRS
 
+// Room kept on the modem for the last gprsConnect() settings, the APN, user
+// and password together, each with its terminating 0
+#if !defined(TINY_GSM_GPRS_SETTINGS_LEN)
+#define TINY_GSM_GPRS_SETTINGS_LEN 64
+#endif
+
 enum SimStatus {
   SIM_ERROR            = 0,
   SIM_READY            = 1,
@@ -31,16 +37,43 @@ class TinyGsmGPRS {
     return thisModem().simUnlockImpl(pin);
   }
   // Gets the CCID of a sim card via AT+CCID
+#if !defined(TINY_GSM_NO_HEAP)
   String getSimCCID() {
-    return thisModem().getSimCCIDImpl();
+    TINY_GSM_ALLOC_SCOPE("getSimCCID");
+    char buf[32];
+    getSimCCID(buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t getSimCCID(char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().getSimCCIDImpl(buf, len);
   }
   // Asks for TA Serial Number Identification (IMEI)
+#if !defined(TINY_GSM_NO_HEAP)
   String getIMEI() {
-    return thisModem().getIMEIImpl();
+    TINY_GSM_ALLOC_SCOPE("getIMEI");
+    char buf[32];
+    getIMEI(buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t getIMEI(char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().getIMEIImpl(buf, len);
   }
   // Asks for International Mobile Subscriber Identity IMSI
+#if !defined(TINY_GSM_NO_HEAP)
   String getIMSI() {
-    return thisModem().getIMSIImpl();
+    TINY_GSM_ALLOC_SCOPE("getIMSI");
+    char buf[32];
+    getIMSI(buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t getIMSI(char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().getIMSIImpl(buf, len);
   }
   SimStatus getSimStatus(uint32_t timeout_ms = 10000L) {
     return thisModem().getSimStatusImpl(timeout_ms);
@@ -49,10 +82,32 @@ class TinyGsmGPRS {
   /*
    * GPRS functions
    */
+  // A copy of the settings is kept so sockets set to reconnect on their own
+  // can bring the connection back
   bool gprsConnect(const char* apn, const char* user = NULL,
                    const char* pwd = NULL) {
+    keepCredentials(apn, user, pwd);
     return thisModem().gprsConnectImpl(apn, user, pwd);
   }
+  // Starts bringing the data connection up and returns straight away; check
+  // on it with gprsConnectStatus().  Modems that step through it with the
+  // command queue (SIM800, BG96) carry on from maintain(), the rest connect
+  // right here.  A connection already up is kept as it is.  A blocking call
+  // made meanwhile first waits for the answer to the step on the line.
+  void gprsConnectAsync(const char* apn, const char* user = NULL,
+                        const char* pwd = NULL) {
+    keepCredentials(apn, user, pwd);
+    connectStatus = thisModem().restoreDataConnectionImpl();
+  }
+  // 1 once the connection gprsConnectAsync() started is up, -1 if it
+  // couldn't be made, 0 while still working on it
+  int8_t gprsConnectStatus() {
+    if (!connectStatus) {
+      thisModem().pollCommands();
+      connectStatus = thisModem().restoreDataConnectionImpl();
+    }
+    return connectStatus;
+  }
   bool gprsDisconnect() {
     return thisModem().gprsDisconnectImpl();
   }
@@ -61,8 +116,17 @@ class TinyGsmGPRS {
     return thisModem().isGprsConnectedImpl();
   }
   // Gets the current network operator
+#if !defined(TINY_GSM_NO_HEAP)
   String getOperator() {
-    return thisModem().getOperatorImpl();
+    TINY_GSM_ALLOC_SCOPE("getOperator");
+    char buf[64];
+    getOperator(buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t getOperator(char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().getOperatorImpl(buf, len);
   }
 
   /*
@@ -90,35 +154,32 @@ class TinyGsmGPRS {
   }
 
   // Gets the CCID of a sim card via AT+CCID
-  String getSimCCIDImpl() {
+  size_t getSimCCIDImpl(char* buf, size_t len) {
     thisModem().sendAT(GF("+CCID"));
-    if (thisModem().waitResponse(GF("+CCID:")) != 1) { return ""; }
-    String res = thisModem().stream.readStringUntil('\n');
+    if (thisModem().waitResponse(GF("+CCID:")) != 1) { return 0; }
+    thisModem().streamGetStringBefore('\n', buf, len);
     thisModem().waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   // Asks for TA Serial Number Identification (IMEI) via the V.25TER standard
   // AT+GSN command
-  String getIMEIImpl() {
+  size_t getIMEIImpl(char* buf, size_t len) {
     thisModem().sendAT(GF("+GSN"));
     thisModem().streamSkipUntil('\n');  // skip first newline
-    String res = thisModem().stream.readStringUntil('\n');
+    thisModem().streamGetStringBefore('\n', buf, len);
     thisModem().waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   // Asks for International Mobile Subscriber Identity IMSI via the AT+CIMI
   // command
-  String getIMSIImpl() {
+  size_t getIMSIImpl(char* buf, size_t len) {
     thisModem().sendAT(GF("+CIMI"));
     thisModem().streamSkipUntil('\n');  // skip first newline
-    String res = thisModem().stream.readStringUntil('\n');
+    thisModem().streamGetStringBefore('\n', buf, len);
     thisModem().waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   SimStatus getSimStatusImpl(uint32_t timeout_ms = 10000L) {
@@ -157,15 +218,121 @@ class TinyGsmGPRS {
     return thisModem().localIP() != IPAddress(0, 0, 0, 0);
   }
 
+  enum RestoreState {
+    RESTORE_IDLE,
+    RESTORE_CHECKING,
+    RESTORE_DOWN,
+    RESTORE_RESUMING,
+    RESTORE_UP,
+    RESTORE_FAILED
+  };
+
+  // Brings the data connection back with the last gprsConnect() settings for
+  // sockets reconnecting on their own.  It goes a step at a time through the
+  // command queue, so maintain() never waits on it: 1 once the connection is
+  // up, 0 while still working on it, -1 if it couldn't be brought back.
+  int8_t restoreDataConnectionImpl() {
+#if TINY_GSM_COMMAND_QUEUE_SIZE == 0
+    // Without the queue there is nothing to spread the steps over
+    if (thisModem().isGprsConnected()) { return 1; }
+    if (!*gprsApn()) { return -1; }
+    return thisModem().gprsConnectImpl(gprsApn(), gprsUser(), gprsPwd()) ? 1
+                                                                          : -1;
+#endif
+    switch (restoreState) {
+      case RESTORE_IDLE:
+        restoreState = RESTORE_CHECKING;
+        if (!thisModem().queueDataCheck()) { restoreState = RESTORE_IDLE; }
+        return 0;
+      case RESTORE_DOWN:
+        if (!*gprsApn()) {
+          restoreState = RESTORE_IDLE;
+          return -1;
+        }
+        restoreState = RESTORE_RESUMING;
+        if (!thisModem().queueDataResume()) { restoreState = RESTORE_DOWN; }
+        return 0;
+      case RESTORE_UP: restoreState = RESTORE_IDLE; return 1;
+      case RESTORE_FAILED: restoreState = RESTORE_IDLE; return -1;
+      default: return 0;
+    }
+  }
+
+  // Queues the query for whether the data connection is still up; its
+  // callback moves restoreState on to RESTORE_UP or RESTORE_DOWN
+  bool queueDataCheck() {
+    return thisModem().sendATAsync(GF("+CGACT?"), dataChecked, this);
+  }
+  static void dataChecked(int8_t result, String& data, void* arg) {
+    // Up if any context is active, ie a line reads "+CGACT: <cid>,1"
+    bool up = result == 1 && data.indexOf(GF(",1\r")) >= 0;
+    static_cast<TinyGsmGPRS*>(arg)->restoreState = up ? RESTORE_UP
+                                                      : RESTORE_DOWN;
+  }
+
+  // Queues what it takes to bring the data connection back, false if there
+  // is no room for it yet.  Modems without steps of their own block here
+  // for a full connect instead.
+  bool queueDataResume() {
+    bool ok = thisModem().gprsConnectImpl(gprsApn(), gprsUser(), gprsPwd());
+    restoreState = ok ? RESTORE_UP : RESTORE_FAILED;
+    return true;
+  }
+  // For modems whose steps go through the queue; any step that fails
+  // fails the whole resume, the last one reports it done
+  static void dataStepDone(int8_t result, String&, void* arg) {
+    TinyGsmGPRS* gprs = static_cast<TinyGsmGPRS*>(arg);
+    if (result != 1 && gprs->restoreState == RESTORE_RESUMING) {
+      gprs->restoreState = RESTORE_FAILED;
+    }
+  }
+  static void dataResumed(int8_t result, String&, void* arg) {
+    TinyGsmGPRS* gprs = static_cast<TinyGsmGPRS*>(arg);
+    if (gprs->restoreState != RESTORE_RESUMING) { return; }
+    gprs->restoreState = result == 1 ? RESTORE_UP : RESTORE_FAILED;
+  }
+
+  // A copy of the settings is kept so the connection can be brought back,
+  // none if they don't fit in TINY_GSM_GPRS_SETTINGS_LEN
+  void keepCredentials(const char* apn, const char* user, const char* pwd) {
+    const char* parts[3] = {apn, user, pwd};
+    size_t      n        = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+      const char* part = parts[i] ? parts[i] : "";
+      size_t      size = strlen(part) + 1;
+      if (n + size > sizeof(gprsSettings)) {
+        DBG("### GPRS settings too long to keep");
+        memset(gprsSettings, 0, sizeof(gprsSettings));
+        return;
+      }
+      memcpy(gprsSettings + n, part, size);
+      n += size;
+    }
+  }
+  const char* gprsApn() const {
+    return gprsSettings;
+  }
+  const char* gprsUser() const {
+    return gprsApn() + strlen(gprsApn()) + 1;
+  }
+  const char* gprsPwd() const {
+    return gprsUser() + strlen(gprsUser()) + 1;
+  }
+
   // Gets the current network operator via the 3GPP TS command AT+COPS
-  String getOperatorImpl() {
+  size_t getOperatorImpl(char* buf, size_t len) {
     thisModem().sendAT(GF("+COPS?"));
-    if (thisModem().waitResponse(GF("+COPS:")) != 1) { return ""; }
+    if (thisModem().waitResponse(GF("+COPS:")) != 1) { return 0; }
     thisModem().streamSkipUntil('"'); /* Skip mode and format */
-    String res = thisModem().stream.readStringUntil('"');
+    size_t n = thisModem().streamGetStringBefore('"', buf, len);
     thisModem().waitResponse();
-    return res;
+    return n;
   }
+
+  // "<apn>\0<user>\0<pwd>\0"
+  char         gprsSettings[TINY_GSM_GPRS_SETTINGS_LEN] = {};
+  RestoreState restoreState                             = RESTORE_IDLE;
+  int8_t       connectStatus                            = -1;
 };
 
 #endif  // SRC_TINYGSMGPRS_H_
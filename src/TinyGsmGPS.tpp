@@ -25,8 +25,18 @@ class TinyGsmGPS {
   bool disableGPS() {
     return thisModem().disableGPSImpl();
   }
+#if !defined(TINY_GSM_NO_HEAP)
   String getGPSraw() {
-    return thisModem().getGPSrawImpl();
+    TINY_GSM_ALLOC_SCOPE("getGPSraw");
+    // A full +CGNSINF or +CGNSSINFO line with every field filled in
+    char buf[256];
+    getGPSraw(buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t getGPSraw(char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().getGPSrawImpl(buf, len);
   }
   bool getGPS(float* lat, float* lon, float* speed = 0, float* alt = 0,
               int* vsat = 0, int* usat = 0, float* accuracy = 0, int* year = 0,
@@ -43,8 +53,17 @@ class TinyGsmGPS {
                                   hour, minute, second);
   }
 
+#if !defined(TINY_GSM_NO_HEAP)
   String setGNSSMode(uint8_t mode, bool dpo) {
-    return thisModem().setGNSSModeImpl(mode, dpo);
+    TINY_GSM_ALLOC_SCOPE("setGNSSMode");
+    char buf[64];
+    setGNSSMode(mode, dpo, buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t setGNSSMode(uint8_t mode, bool dpo, char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().setGNSSModeImpl(mode, dpo, buf, len);
   }
 
   uint8_t getGNSSMode() {
@@ -68,13 +87,14 @@ class TinyGsmGPS {
 
   bool    enableGPSImpl() TINY_GSM_ATTR_NOT_IMPLEMENTED;
   bool    disableGPSImpl() TINY_GSM_ATTR_NOT_IMPLEMENTED;
-  String  getGPSrawImpl() TINY_GSM_ATTR_NOT_IMPLEMENTED;
+  size_t  getGPSrawImpl(char* buf, size_t len) TINY_GSM_ATTR_NOT_IMPLEMENTED;
   bool    getGPSImpl(float* lat, float* lon, float* speed = 0, float* alt = 0,
                      int* vsat = 0, int* usat = 0, float* accuracy = 0,
                      int* year = 0, int* month = 0, int* day = 0, int* hour = 0,
                      int* minute = 0,
                      int* second = 0) TINY_GSM_ATTR_NOT_IMPLEMENTED;
-  String  setGNSSModeImpl(uint8_t mode, bool dpo) TINY_GSM_ATTR_NOT_IMPLEMENTED;
+  size_t  setGNSSModeImpl(uint8_t mode, bool dpo, char* buf,
+                          size_t len) TINY_GSM_ATTR_NOT_IMPLEMENTED;
   uint8_t getGNSSModeImpl() TINY_GSM_ATTR_NOT_IMPLEMENTED;
 };
 
@@ -19,12 +19,29 @@ class TinyGsmGSMLocation {
   /*
    * GSM Location functions
    */
+#if !defined(TINY_GSM_NO_HEAP)
   String getGsmLocationRaw() {
-    return thisModem().getGsmLocationRawImpl();
+    TINY_GSM_ALLOC_SCOPE("getGsmLocationRaw");
+    char buf[64];
+    getGsmLocationRaw(buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t getGsmLocationRaw(char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().getGsmLocationRawImpl(buf, len);
   }
 
+#if !defined(TINY_GSM_NO_HEAP)
   String getGsmLocation() {
-    return thisModem().getGsmLocationRawImpl();
+    TINY_GSM_ALLOC_SCOPE("getGsmLocation");
+    char buf[64];
+    getGsmLocationRaw(buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t getGsmLocation(char* buf, size_t len) {
+    return getGsmLocationRaw(buf, len);
   }
 
   bool getGsmLocation(float* lat, float* lon, float* accuracy = 0,
@@ -68,24 +85,23 @@ class TinyGsmGSMLocation {
   //   return res;
   // }
 
-  String getGsmLocationRawImpl() {
+  size_t getGsmLocationRawImpl(char* buf, size_t len) {
     // AT+CLBS=<type>,<cid>
     // <type> 1 = location using 3 cell's information
     //        3 = get number of times location has been accessed
     //        4 = Get longitude latitude and date time
     thisModem().sendAT(GF("+CLBS=1,1"));
     // Should get a location code of "0" indicating success
-    if (thisModem().waitResponse(120000L, GF("+CLBS: ")) != 1) { return ""; }
+    if (thisModem().waitResponse(120000L, GF("+CLBS: ")) != 1) { return 0; }
     int8_t locationCode = thisModem().streamGetIntLength(2);
     // 0 = success, else, error
     if (locationCode != 0) {
       thisModem().waitResponse();  // should be an ok after the error
-      return "";
+      return 0;
     }
-    String res = thisModem().stream.readStringUntil('\n');
+    thisModem().streamGetStringBefore('\n', buf, len);
     thisModem().waitResponse();
-    res.trim();
-    return res;
+    return TinyGsmTrim(buf);
   }
 
   bool getGsmLocationImpl(float* lat, float* lon, float* accuracy = 0,
@@ -10,6 +10,47 @@
 #define SRC_TINYGSMMODEM_H_
 
 #include "TinyGsmCommon.h"
+#include "TinyGsmWait.h"
+#if defined(TINY_GSM_AT_STATS)
+#include "TinyGsmATStats.h"
+#endif
+
+// The per-socket counters and the trace need to see every byte to and from
+// the modem
+#if (defined(TINY_GSM_SOCKET_STATS) || defined(TINY_GSM_AT_TRACE)) && \
+    !defined(TINY_GSM_STREAM_TAP)
+#define TINY_GSM_STREAM_TAP
+#endif
+
+#if defined(TINY_GSM_STREAM_TAP)
+#include "TinyGsmStreamTap.h"
+#endif
+
+// Once the reply to a queued command starts to arrive, how long maintain()
+// gives the rest of it to come in before going back to the application
+#if !defined(TINY_GSM_COMMAND_SLICE_MS)
+#define TINY_GSM_COMMAND_SLICE_MS 100
+#endif
+
+// How long a registration state kept from the URC's is trusted before it is
+// checked with the modem again, in case the reports stopped
+#if !defined(TINY_GSM_REG_CACHE_MS)
+#define TINY_GSM_REG_CACHE_MS 60000L
+#endif
+
+// Called with the index of the response that matched (0 on a timeout) and
+// whatever the modem sent ahead of it
+typedef void (*TinyGsmCommandCallback)(int8_t result, String& data,
+                                       void* arg);
+
+struct TinyGsmCommand {
+  String                 cmd;
+  uint32_t               timeout_ms;
+  GsmConstStr            r1;
+  GsmConstStr            r2;
+  TinyGsmCommandCallback callback;
+  void*                  arg;
+};
 
 template <class modemType>
 class TinyGsmModem {
@@ -18,13 +59,19 @@ class TinyGsmModem {
    * Basic functions
    */
   bool begin(const char* pin = NULL) {
-    return thisModem().initImpl(pin);
+    forgetRegistration();
+    return restoreRegistrationURC(thisModem().initImpl(pin));
   }
   bool init(const char* pin = NULL) {
-    return thisModem().initImpl(pin);
+    forgetRegistration();
+    return restoreRegistrationURC(thisModem().initImpl(pin));
   }
   template <typename... Args>
   inline void sendAT(Args... cmd) {
+    thisModem().finishCommand();
+#if defined(TINY_GSM_AT_STATS)
+    atStats.commandSent(cmd...);
+#endif
     thisModem().streamWrite("AT", cmd..., thisModem().gsmNL);
     thisModem().stream.flush();
     TINY_GSM_YIELD(); /* DBG("### AT:", cmd...); */
@@ -32,6 +79,80 @@ class TinyGsmModem {
   void setBaud(uint32_t baud) {
     thisModem().setBaudImpl(baud);
   }
+  // Sets how to wait for the modem to send something; NULL goes back to
+  // spinning on TINY_GSM_YIELD()
+  void setWaitStrategy(TinyGsmWaitStrategy* strategy) {
+    waitStrategy = strategy;
+  }
+  // Queues "AT<cmd>" to be sent once the commands ahead of it are answered.
+  // maintain() sends it and watches for the reply without blocking, then
+  // hands the result to the callback.  Leaving r1 NULL matches the driver's
+  // usual OK and ERROR responses.  Returns false if the queue is full.
+  bool sendATAsync(const String& cmd, TinyGsmCommandCallback callback = NULL,
+                   void* arg = NULL, uint32_t timeout_ms = 1000L,
+                   GsmConstStr r1 = NULL, GsmConstStr r2 = NULL) {
+#if TINY_GSM_COMMAND_QUEUE_SIZE > 0
+    if (commandCount >= TINY_GSM_COMMAND_QUEUE_SIZE) { return false; }
+    TinyGsmCommand& command = commandQueue[(commandHead + commandCount) %
+                                           TINY_GSM_COMMAND_QUEUE_SIZE];
+    command.cmd        = cmd;
+    command.timeout_ms = timeout_ms;
+    command.r1         = r1;
+    command.r2         = r2;
+    command.callback   = callback;
+    command.arg        = arg;
+    commandCount++;
+    return true;
+#else
+    (void)cmd;
+    (void)callback;
+    (void)arg;
+    (void)timeout_ms;
+    (void)r1;
+    (void)r2;
+    return false;
+#endif
+  }
+  // Number of queued commands, including one waiting for its reply
+  uint8_t commandsPending() {
+#if TINY_GSM_COMMAND_QUEUE_SIZE > 0
+    return commandCount;
+#else
+    return 0;
+#endif
+  }
+  // Waits up to timeout_ms for the modem to send something, through the
+  // wait strategy when there is one; true once something has come in
+  bool waitForData(uint32_t timeout_ms) {
+    uint32_t startMillis = millis();
+    if (waitStrategy) {
+      return waitStrategy->waitAvailable(thisModem().stream, 1, startMillis,
+                                         timeout_ms);
+    }
+    while (!thisModem().stream.available() &&
+           millis() - startMillis < timeout_ms) {
+      delay(1);
+    }
+    return thisModem().stream.available() > 0;
+  }
+#if defined(TINY_GSM_AT_STATS)
+  // Timing collected for each AT command; see TinyGsmATStats.h
+  TinyGsmATStats& getATStats() {
+    return atStats;
+  }
+#endif
+#if defined(TINY_GSM_ALLOC_STATS)
+  // Heap use of the calls that allocate; see TinyGsmAllocStats.h
+  TinyGsmAllocStats& getAllocStats() {
+    return TinyGsmAllocStats::global();
+  }
+#endif
+#if defined(TINY_GSM_AT_TRACE)
+  // The last bytes to and from the modem; see TinyGsmATTrace.h
+  TinyGsmATTrace& getATTrace() {
+    return streamTap.trace;
+  }
+#endif
   // Test response to AT commands
   bool testAT(uint32_t timeout_ms = 10000L) {
     return thisModem().testATImpl(timeout_ms);
@@ -39,12 +160,35 @@ class TinyGsmModem {
 
   // Asks for modem information via the V.25TER standard ATI command
   // NOTE:  The actual value and style of the response is quite varied
+#if !defined(TINY_GSM_NO_HEAP)
   String getModemInfo() {
-    return thisModem().getModemInfoImpl();
+    TINY_GSM_ALLOC_SCOPE("getModemInfo");
+    // Some modules answer with several lines, some with two ATI's worth.
+    // Read on the stack, so the heap only takes the text itself.
+    char buf[512];
+    getModemInfo(buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  // The calls handing back text also come in a form filling buf instead,
+  // which leaves the heap alone.  The text is cut to fit and its length
+  // returned, 0 if there was none.
+  size_t getModemInfo(char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().getModemInfoImpl(buf, len);
   }
   // Gets the modem name (as it calls itself)
+#if !defined(TINY_GSM_NO_HEAP)
   String getModemName() {
-    return thisModem().getModemNameImpl();
+    TINY_GSM_ALLOC_SCOPE("getModemName");
+    char buf[64];
+    getModemName(buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t getModemName(char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().getModemNameImpl(buf, len);
   }
   bool factoryDefault() {
     return thisModem().factoryDefaultImpl();
@@ -54,7 +198,8 @@ class TinyGsmModem {
    * Power functions
    */
   bool restart(const char* pin = NULL) {
-    return thisModem().restartImpl(pin);
+    forgetRegistration();
+    return restoreRegistrationURC(thisModem().restartImpl(pin));
   }
   bool poweroff() {
     return thisModem().powerOffImpl();
@@ -80,15 +225,46 @@ class TinyGsmModem {
   bool waitForNetwork(uint32_t timeout_ms = 60000L, bool check_signal = false) {
     return thisModem().waitForNetworkImpl(timeout_ms, check_signal);
   }
+  // Has the modem report registration changes by itself (+CxREG=2), after
+  // which isNetworkConnected() answers from memory, asking the modem again
+  // only every TINY_GSM_REG_CACHE_MS.  It is set again after an init() or
+  // restart().
+  bool enableRegistrationURC() {
+    regURC = true;
+    return thisModem().enableRegistrationURCImpl();
+  }
+  // Location area (or tracking area) code, cell id and access technology
+  // from the last registration report, -1 for the technology if unknown
+  uint32_t getLocationAreaCode() {
+    return regLac;
+  }
+  uint32_t getCellId() {
+    return regCellId;
+  }
+  int8_t getAccessTechnology() {
+    return regAct;
+  }
   // Gets signal quality report
   int16_t getSignalQuality() {
     return thisModem().getSignalQualityImpl();
   }
+#if !defined(TINY_GSM_NO_HEAP)
   String getLocalIP() {
-    return thisModem().getLocalIPImpl();
+    TINY_GSM_ALLOC_SCOPE("getLocalIP");
+    char buf[64];
+    getLocalIP(buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t getLocalIP(char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().getLocalIPImpl(buf, len);
   }
   IPAddress localIP() {
-    return thisModem().TinyGsmIpFromString(thisModem().getLocalIP());
+    TINY_GSM_ALLOC_SCOPE("localIP");
+    char ip[32];
+    getLocalIP(ip, sizeof(ip));
+    return thisModem().TinyGsmIpFromString(ip);
   }
 
   /*
@@ -106,6 +282,25 @@ class TinyGsmModem {
    * Basic functions
    */
  protected:
+  // Drivers bind their stream through this, so a TinyGsmStreamTap can be put
+  // in front of it when one is compiled in
+  inline Stream& tapStream(Stream& stream) {
+#if defined(TINY_GSM_STREAM_TAP)
+    return streamTap.attach(stream);
+#else
+    return stream;
+#endif
+  }
+
+  // Shows the modem's name on the debug stream, as drivers do on init
+  inline void dbgModemName() {
+#if defined(TINY_GSM_DEBUG)
+    char name[64];
+    thisModem().getModemName(name, sizeof(name));
+    DBG(GF("### Modem:"), name);
+#endif
+  }
+
   void setBaudImpl(uint32_t baud) {
     thisModem().sendAT(GF("+IPR="), baud);
     thisModem().waitResponse();
@@ -120,37 +315,23 @@ class TinyGsmModem {
     return false;
   }
 
-  String getModemInfoImpl() {
+  size_t getModemInfoImpl(char* buf, size_t len) {
     thisModem().sendAT(GF("I"));
-    String res;
-    if (thisModem().waitResponse(1000L, res) != 1) { return ""; }
-    // Do the replaces twice so we cover both \r and \r\n type endings
-    res.replace("\r\nOK\r\n", "");
-    res.replace("\rOK\r", "");
-    res.replace("\r\n", " ");
-    res.replace("\r", " ");
-    res.trim();
-    return res;
+    return thisModem().waitResponseText(1000L, buf, len);
   }
 
-  String getModemNameImpl() {
+  size_t getModemNameImpl(char* buf, size_t len) {
     thisModem().sendAT(GF("+CGMI"));
-    String res1;
-    if (thisModem().waitResponse(1000L, res1) != 1) { return "unknown"; }
-    res1.replace("\r\nOK\r\n", "");
-    res1.replace("\rOK\r", "");
-    res1.trim();
+    size_t n = thisModem().waitResponseText(1000L, buf, len);
+    if (!n || n + 2 >= len) { return TinyGsmCopyString(buf, len, "unknown"); }
+    buf[n++] = ' ';
 
     thisModem().sendAT(GF("+GMM"));
-    String res2;
-    if (thisModem().waitResponse(1000L, res2) != 1) { return "unknown"; }
-    res2.replace("\r\nOK\r\n", "");
-    res2.replace("\rOK\r", "");
-    res2.trim();
+    size_t n2 = thisModem().waitResponseText(1000L, buf + n, len - n);
+    if (!n2) { return TinyGsmCopyString(buf, len, "unknown"); }
 
-    String name = res1 + String(' ') + res2;
-    DBG("### Modem:", name);
-    return name;
+    DBG("### Modem:", buf);
+    return n + n2;
   }
 
   bool factoryDefaultImpl() {
@@ -186,27 +367,107 @@ class TinyGsmModem {
   // CGREG = GPRS service registration
   // CEREG = EPS registration for LTE modules
   int8_t getRegistrationStatusXREG(const char* regCommand) {
+    uint8_t type = regCommand[1] == 'R' ? 0 : (regCommand[1] == 'G' ? 1 : 2);
+    if (regTracking && regStatus[type] >= 0 &&
+        millis() - regStamp[type] < TINY_GSM_REG_CACHE_MS) {
+      // Let any waiting URC's update the state first
+      thisModem().streamClear();
+      return regStatus[type];
+    }
     thisModem().sendAT('+', regCommand, '?');
     // check for any of the three for simplicity
     int8_t resp = thisModem().waitResponse(GF("+CREG:"), GF("+CGREG:"),
                                            GF("+CEREG:"));
     if (resp != 1 && resp != 2 && resp != 3) { return -1; }
-    thisModem().streamSkipUntil(','); /* Skip format (0) */
-    int status = thisModem().stream.parseInt();
+    int8_t status = streamRegistration(resp - 1, true);
     thisModem().waitResponse();
     return status;
   }
 
+  bool enableRegistrationURCImpl() {
+    bool creg  = false;
+    bool cgreg = false;
+    bool cereg = false;
+    // 2 = report status changes along with the location
+    thisModem().sendAT(GF("+CREG=2"));
+    creg = thisModem().waitResponse() == 1;
+    thisModem().sendAT(GF("+CGREG=2"));
+    cgreg = thisModem().waitResponse() == 1;
+    thisModem().sendAT(GF("+CEREG=2"));
+    cereg = thisModem().waitResponse() == 1;
+    if (!creg && !cgreg && !cereg) { return false; }
+    // Start from the current state, the URC's keep it up to date from here
+    // unless a reply shows the reports didn't get turned on after all
+    for (uint8_t i = 0; i < 3; i++) { regStatus[i] = -1; }
+    regTracking = true;
+    if (creg) { getRegistrationStatusXREG("CREG"); }
+    if (cgreg) { getRegistrationStatusXREG("CGREG"); }
+    if (cereg) { getRegistrationStatusXREG("CEREG"); }
+    return regTracking;
+  }
+
   bool waitForNetworkImpl(uint32_t timeout_ms   = 60000L,
                           bool     check_signal = false) {
     for (uint32_t start = millis(); millis() - start < timeout_ms;) {
       if (check_signal) { thisModem().getSignalQuality(); }
       if (thisModem().isNetworkConnected()) { return true; }
-      delay(250);
+      if (regTracking) {
+        // Check again as soon as the modem says anything
+        streamWaitAvailable(1, millis(), 250);
+      } else {
+        delay(250);
+      }
     }
     return false;
   }
 
+  // Reads "[<n>,]<stat>[,<lac>,<ci>[,<AcT>]]", the rest of a +CREG, +CGREG
+  // or +CEREG line, into the cached state.  The reply to a query starts with
+  // the reporting mode, a URC doesn't; a mode other than 2 means the modem
+  // stopped reporting, so the cached state can't be trusted any more.
+  int8_t streamRegistration(uint8_t type, bool query) {
+    char line[48];
+    thisModem().streamGetStringBefore('\n', line, sizeof(line));
+    int8_t field  = query ? -1 : 0;
+    int8_t status = -1;
+    for (char* value = line; value; field++) {
+      char* next = strchr(value, ',');
+      if (next) { *next++ = '\0'; }
+      while (*value == ' ' || *value == '"') { value++; }
+      bool given = *value && *value != '"' && *value != '\r';
+      if (field == -1) {
+        if (atoi(value) != 2) { regTracking = false; }
+      } else if (field == 0) {
+        status = atoi(value);
+      } else if (field == 1 && given) {
+        regLac = strtoul(value, NULL, 16);
+      } else if (field == 2 && given) {
+        regCellId = strtoul(value, NULL, 16);
+      } else if (field == 3 && given) {
+        regAct = atoi(value);
+      }
+      value = next;
+    }
+    regStatus[type] = status;
+    regStamp[type]  = millis();
+    return status;
+  }
+
+  // Whatever was cached from before an init or restart is stale, and the
+  // modem has forgotten +CxREG=2
+  inline void forgetRegistration() {
+    for (uint8_t i = 0; i < 3; i++) { regStatus[i] = -1; }
+    regTracking = false;
+  }
+  // Turns the reports asked for with enableRegistrationURC() back on after
+  // an init or restart, unless the driver's restart went through init()
+  inline bool restoreRegistrationURC(bool ok) {
+    if (ok && regURC && !regTracking) {
+      thisModem().enableRegistrationURCImpl();
+    }
+    return ok;
+  }
+
   // Gets signal quality report according to 3GPP TS command AT+CSQ
   int8_t getSignalQualityImpl() {
     thisModem().sendAT(GF("+CSQ"));
@@ -216,22 +477,29 @@ class TinyGsmModem {
     return res;
   }
 
-  String getLocalIPImpl() {
+  size_t getLocalIPImpl(char* buf, size_t len) {
     thisModem().sendAT(GF("+CGPADDR=1"));
-    if (thisModem().waitResponse(GF("+CGPADDR:")) != 1) { return ""; }
+    if (thisModem().waitResponse(GF("+CGPADDR:")) != 1) { return 0; }
     thisModem().streamSkipUntil(',');  // Skip context id
-    String res = thisModem().stream.readStringUntil('\r');
-    if (thisModem().waitResponse() != 1) { return ""; }
-    return res;
+    size_t n = thisModem().streamGetStringBefore('\r', buf, len);
+    if (thisModem().waitResponse() != 1) {
+      buf[0] = '\0';
+      return 0;
+    }
+    return n;
   }
 
   static inline IPAddress TinyGsmIpFromString(const String& strIP) {
+    return TinyGsmIpFromString(strIP.c_str());
+  }
+
+  static inline IPAddress TinyGsmIpFromString(const char* strIP) {
     int Parts[4] = {
         0,
     };
     int Part = 0;
-    for (uint8_t i = 0; i < strIP.length(); i++) {
-      char c = strIP[i];
+    for (; *strIP; strIP++) {
+      char c = *strIP;
       if (c == '.') {
         Part++;
         if (Part > 3) { return IPAddress(0, 0, 0, 0); }
@@ -268,19 +536,114 @@ class TinyGsmModem {
     }
   }
 
+  // Waits until at least count characters are available or timeout_ms has
+  // passed since startMillis
+  inline bool streamWaitAvailable(int count, uint32_t startMillis,
+                                  uint32_t timeout_ms) {
+    bool ready;
+    if (waitStrategy) {
+      ready = waitStrategy->waitAvailable(thisModem().stream, count,
+                                          startMillis, timeout_ms);
+    } else {
+      while (thisModem().stream.available() < count &&
+             millis() - startMillis < timeout_ms) {
+        TINY_GSM_YIELD();
+      }
+      ready = thisModem().stream.available() >= count;
+    }
+#if defined(TINY_GSM_AT_STATS)
+    atStats.responseWaiting(thisModem().stream.available() > 0);
+#endif
+    return ready;
+  }
+
+  // Called by the driver's waitResponse() when it times out; true if data is
+  // the start of a queued command's reply, which is kept while pollCommands()
+  // reads the rest of it in later slices, or the start of a URC that
+  // maintain(budget_us) will finish on a later call
+  inline bool replyContinues(const String& data) {
+#if TINY_GSM_COMMAND_QUEUE_SIZE > 0
+    if (commandSent && &data == &commandReply) { return true; }
+#endif
+#if defined(TINY_GSM_NO_HEAP)
+    return &data == partialData;
+#else
+    return &data == &partialLine;
+#endif
+  }
+
+  // Called by the driver's waitResponse() as it returns, with the number of
+  // characters it read towards the response
+  inline void atStatsResponse(int8_t index, size_t bytes) {
+#if defined(TINY_GSM_AT_STATS)
+    atStats.responseMatched(index, bytes);
+#else
+    (void)index;
+    (void)bytes;
+#endif
+  }
+
+  // Sends the next queued command or checks on the reply to the one already
+  // sent, without waiting for a reply that hasn't started to arrive.
+  // Returns true while a reply is outstanding.
+  bool pollCommands() {
+#if TINY_GSM_COMMAND_QUEUE_SIZE > 0
+    if (commandSent) {
+      TinyGsmCommand& command = commandQueue[commandHead];
+      uint32_t        elapsed = millis() - commandStart;
+      if (elapsed < command.timeout_ms && !thisModem().stream.available()) {
+        return true;
+      }
+      int8_t index = 0;
+      if (elapsed < command.timeout_ms) {
+        // What a slice reads of the reply stays in commandReply for the next
+        index = waitCommandResponse(
+            TinyGsmMin(command.timeout_ms - elapsed,
+                       static_cast<uint32_t>(TINY_GSM_COMMAND_SLICE_MS)));
+        if (!index && millis() - commandStart < command.timeout_ms) {
+          return true;
+        }
+      }
+      completeCommand(index);
+    }
+    if (!commandCount) { return false; }
+#if defined(TINY_GSM_AT_STATS)
+    atStats.commandSent(commandQueue[commandHead].cmd);
+#endif
+    thisModem().streamWrite("AT", commandQueue[commandHead].cmd,
+                            thisModem().gsmNL);
+    thisModem().stream.flush();
+    commandSent  = true;
+    commandStart = millis();
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  // Waits for the reply to a command sent by pollCommands(), so a blocking
+  // call can have the modem to itself.  It is done as soon as the reply is
+  // in, but a slow step like +CIICR can hold it up to that step's timeout.
+  // Commands not yet sent stay queued.
+  void finishCommand() {
+#if TINY_GSM_COMMAND_QUEUE_SIZE > 0
+    if (!commandSent) { return; }
+    TinyGsmCommand& command = commandQueue[commandHead];
+    uint32_t        elapsed = millis() - commandStart;
+    int8_t          index   = 0;
+    if (elapsed < command.timeout_ms) {
+      index = waitCommandResponse(command.timeout_ms - elapsed);
+    }
+    completeCommand(index);
+#endif
+  }
+
  protected:
   inline bool streamGetLength(char* buf, int8_t numChars,
                               const uint32_t timeout_ms = 1000L) {
     if (!buf) { return false; }
 
-    int8_t   numCharsReady = -1;
-    uint32_t startMillis   = millis();
-    while (millis() - startMillis < timeout_ms &&
-           (numCharsReady = thisModem().stream.available()) < numChars) {
-      TINY_GSM_YIELD();
-    }
-
-    if (numCharsReady >= numChars) {
+    if (streamWaitAvailable(numChars, millis(), timeout_ms)) {
       thisModem().stream.readBytes(buf, numChars);
       return true;
     }
@@ -313,6 +676,14 @@ class TinyGsmModem {
     return -9999;
   }
 
+  // Reads the address the modem sends up to lastChar and parses it in place,
+  // with no String in between; 0.0.0.0 if there wasn't one
+  inline IPAddress streamGetIpBefore(char lastChar) {
+    char buf[24];
+    streamGetStringBefore(lastChar, buf, sizeof(buf));
+    return TinyGsmIpFromString(buf);
+  }
+
   inline float streamGetFloatLength(int8_t         numChars,
                                     const uint32_t timeout_ms = 1000L) {
     char buf[numChars + 1];
@@ -338,17 +709,155 @@ class TinyGsmModem {
     return -9999.0F;
   }
 
+  // Reads up to lastChar into buf as a C string, like readStringUntil() with
+  // what doesn't fit skipped; returns the length
+  inline size_t streamGetStringBefore(char lastChar, char* buf, size_t len) {
+    if (!len) { return 0; }
+    size_t n = thisModem().stream.readBytesUntil(lastChar, buf, len - 1);
+    if (n == len - 1) { streamSkipUntil(lastChar); }
+    buf[n] = '\0';
+    return n;
+  }
+
+  // The String the outermost reply is read into: replyBuffer, which keeps its
+  // room between replies, or own when that was left out with the queue
+  inline String& reusedReply(String& own) {
+#if TINY_GSM_COMMAND_QUEUE_SIZE > 0
+    (void)own;
+    return replyBuffer;
+#else
+    return own;
+#endif
+  }
+
+  // Waits for a reply its caller only wants the index of.  The text is read
+  // into replyBuffer, which keeps its room between replies, so once it has
+  // grown to fit the longest this doesn't allocate.  A reply waited for
+  // while another is being read, from a callback, gets a String of its own.
+  template <typename... Args>
+  inline int8_t waitResponseReused(uint32_t timeout_ms, Args... responses) {
+    String  own;
+    bool    outer = !replyBusy;
+    String& data  = outer ? reusedReply(own) : own;
+    replyBusy     = true;
+    data          = "";
+    int8_t index  = thisModem().waitResponse(timeout_ms, data, responses...);
+    replyBusy     = !outer;
+    return index;
+  }
+
+  // Waits for the reply to a command and copies its text into buf, less the
+  // OK ending it and with line breaks made spaces, trimmed; returns the
+  // length, 0 if the reply didn't end with OK
+  inline size_t waitResponseText(uint32_t timeout_ms, char* buf, size_t len) {
+    String  own;
+    bool    outer = !replyBusy;
+    String& data  = outer ? reusedReply(own) : own;
+    replyBusy     = true;
+    data          = "";
+    int8_t index  = thisModem().waitResponse(timeout_ms, data);
+    replyBusy     = !outer;
+    if (index != 1 || !len) { return 0; }
+
+    // The reply ends with OK and the line break after it
+    size_t end = data.length();
+    while (end && (data[end - 1] == '\r' || data[end - 1] == '\n')) { end--; }
+    if (end >= 2) { end -= 2; }
+    size_t n = 0;
+    for (size_t i = 0; i < end && n + 1 < len; i++) {
+      char c = data[i];
+      if (c == '\r' && i + 1 < end && data[i + 1] == '\n') { i++; }
+      buf[n++] = c == '\r' ? ' ' : c;
+    }
+    buf[n] = '\0';
+    return TinyGsmTrim(buf);
+  }
+
+  // Reads the rest of a +CREG, +CGREG or +CEREG URC into the cached
+  // registration state; false if data doesn't end with one
+  inline bool streamRegistrationURC(const String& data) {
+    uint8_t type;
+    if (data.endsWith(GF("+CREG:"))) {
+      type = 0;
+    } else if (data.endsWith(GF("+CGREG:"))) {
+      type = 1;
+    } else if (data.endsWith(GF("+CEREG:"))) {
+      type = 2;
+    } else {
+      return false;
+    }
+    streamRegistration(type, false);
+    DBG("### Registration:", regStatus[type], regLac, regCellId, regAct);
+    return true;
+  }
+
   inline bool streamSkipUntil(const char c, const uint32_t timeout_ms = 1000L) {
     uint32_t startMillis = millis();
     while (millis() - startMillis < timeout_ms) {
-      while (millis() - startMillis < timeout_ms &&
-             !thisModem().stream.available()) {
-        TINY_GSM_YIELD();
-      }
+      streamWaitAvailable(1, startMillis, timeout_ms);
       if (thisModem().stream.read() == c) { return true; }
     }
     return false;
   }
+
+#if TINY_GSM_COMMAND_QUEUE_SIZE > 0
+  inline int8_t waitCommandResponse(uint32_t timeout_ms) {
+    TinyGsmCommand& command = commandQueue[commandHead];
+    if (!command.r1) {
+      return thisModem().waitResponse(timeout_ms, commandReply);
+    }
+    return thisModem().waitResponse(timeout_ms, commandReply, command.r1,
+                                    command.r2);
+  }
+
+  // Takes the answered command off the queue before running its callback,
+  // so the callback can queue or send more commands
+  inline void completeCommand(int8_t index) {
+    TinyGsmCommand&        command  = commandQueue[commandHead];
+    TinyGsmCommandCallback callback = command.callback;
+    void*                  arg      = command.arg;
+    command.cmd                     = "";
+    commandHead = (commandHead + 1) % TINY_GSM_COMMAND_QUEUE_SIZE;
+    commandCount--;
+    commandSent = false;
+#if defined(TINY_GSM_AT_STATS)
+    if (!index) { atStats.commandTimedOut(); }
+#endif
+    if (callback) { callback(index, commandReply, arg); }
+    commandReply = "";
+  }
+#endif
+
+  TinyGsmWaitStrategy* waitStrategy = NULL;
+  bool                 regURC       = false;
+  bool                 regTracking  = false;
+  int8_t               regStatus[3] = {-1, -1, -1};  // CREG, CGREG, CEREG
+  uint32_t             regStamp[3]  = {0, 0, 0};
+  uint32_t             regLac       = 0;
+  uint32_t             regCellId    = 0;
+  int8_t               regAct       = -1;
+#if TINY_GSM_COMMAND_QUEUE_SIZE > 0
+  TinyGsmCommand       commandQueue[TINY_GSM_COMMAND_QUEUE_SIZE];
+  uint8_t              commandHead  = 0;
+  uint8_t              commandCount = 0;
+  bool                 commandSent  = false;
+  uint32_t             commandStart = 0;
+  String               commandReply;
+  String               replyBuffer;
+#endif
+#if defined(TINY_GSM_NO_HEAP)
+  char                 partialLine[129] = {};
+  const String*        partialData      = NULL;
+#else
+  String               partialLine;
+#endif
+  bool                 replyBusy    = false;
+#if defined(TINY_GSM_AT_STATS)
+  TinyGsmATStats atStats;
+#endif
+#if defined(TINY_GSM_STREAM_TAP)
+  TinyGsmStreamTap streamTap;
+#endif
 };
 
 #endif  // SRC_TINYGSMMODEM_H_
@@ -0,0 +1,125 @@
+/**
+ * @file       TinyGsmPool.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef SRC_TINYGSMPOOL_H_
+#define SRC_TINYGSMPOOL_H_
+
+#include "TinyGsmCommon.h"
+
+// How long a released socket is kept open waiting to be used again
+#if !defined(TINY_GSM_POOL_IDLE_MS)
+#define TINY_GSM_POOL_IDLE_MS 60000L
+#endif
+
+// Include it after TinyGsmClient.h.
+//
+// Keeps sockets open between requests to the same host and port, so talking
+// to the same server again skips the DNS lookup, the TCP handshake and (for
+// a pool of secure clients) the TLS setup:
+//
+//   TinyGsmPool<TinyGsmClient> pool(modem);
+//   TinyGsmClient* client = pool.acquire("example.com", 80);
+//   if (client) {
+//     ... send a request and read the whole reply ...
+//     pool.release(client);
+//   }
+//
+// The pool owns poolSize sockets starting at firstMux; keep other clients
+// (or a second pool, e.g. of TinyGsmClientSecure) on different mux numbers.
+// A socket the modem reports closed is dropped instead of being handed out
+// again.  Call modem.setKeepAlive(true) first on modems that support it so
+// idle sockets aren't dropped by the network in the meantime.
+template <class clientType, uint8_t poolSize = TINY_GSM_MUX_COUNT>
+class TinyGsmPool {
+ public:
+  template <class modemType>
+  explicit TinyGsmPool(modemType& modem, uint8_t firstMux = 0) {
+    for (uint8_t i = 0; i < poolSize; i++) {
+      clients[i].init(&modem, firstMux + i);
+      hosts[i][0]  = '\0';
+      ports[i]     = 0;
+      idleSince[i] = 0;
+      inUse[i]     = false;
+    }
+  }
+
+  // Returns a socket connected to host:port, reusing an idle one when there
+  // is one, or NULL if every socket is in use or the connection fails
+  clientType* acquire(const char* host, uint16_t port, int timeout_s = 75) {
+    expireIdle();
+    int8_t slot = -1;
+    for (uint8_t i = 0; i < poolSize; i++) {
+      if (inUse[i]) { continue; }
+      if (ports[i] == port && hosts[i][0] && !strcmp(hosts[i], host)) {
+        inUse[i] = true;
+        return &clients[i];
+      }
+      // Otherwise take an unused socket, or close the longest idle one
+      if (slot < 0) {
+        slot = i;
+      } else if (hosts[slot][0] &&
+                 (!hosts[i][0] ||
+                  millis() - idleSince[i] > millis() - idleSince[slot])) {
+        slot = i;
+      }
+    }
+    if (slot < 0) { return NULL; }
+    hosts[slot][0] = '\0';
+    if (!clients[slot].connect(host, port, timeout_s)) { return NULL; }
+    // A host too long to keep gets its socket closed when released
+    TinyGsmKeepString(hosts[slot], TINY_GSM_HOST_LEN, host);
+    ports[slot] = port;
+    inUse[slot] = true;
+    return &clients[slot];
+  }
+
+  // Gives a socket back for reuse.  It is only kept open if the whole reply
+  // was read; anything left over would be read by the next user.
+  void release(clientType* client) {
+    int idx = client - clients;
+    if (idx < 0 || idx >= poolSize) { return; }
+    inUse[idx]     = false;
+    idleSince[idx] = millis();
+    if (!hosts[idx][0] || client->available() > 0 || !client->connected()) {
+      client->stop();
+      hosts[idx][0] = '\0';
+    }
+  }
+
+  // Closes idle sockets that have not been used for TINY_GSM_POOL_IDLE_MS
+  // and forgets the ones the modem has closed.  Called by acquire().
+  void expireIdle() {
+    for (uint8_t i = 0; i < poolSize; i++) {
+      if (inUse[i] || !hosts[i][0]) { continue; }
+      if (!clients[i].connected()) {
+        hosts[i][0] = '\0';
+      } else if (millis() - idleSince[i] > TINY_GSM_POOL_IDLE_MS) {
+        clients[i].stop();
+        hosts[i][0] = '\0';
+      }
+    }
+  }
+
+  // Number of sockets open and waiting to be reused
+  uint8_t idleCount() {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < poolSize; i++) {
+      if (!inUse[i] && hosts[i][0]) { count++; }
+    }
+    return count;
+  }
+
+ protected:
+  clientType clients[poolSize];
+  char       hosts[poolSize][TINY_GSM_HOST_LEN];  // empty when not open
+  uint16_t   ports[poolSize];
+  uint32_t   idleSince[poolSize];
+  bool       inUse[poolSize];
+};
+
+#endif  // SRC_TINYGSMPOOL_H_
@@ -19,8 +19,19 @@ class TinyGsmSMS {
   /*
    * Messaging functions
    */
+#if !defined(TINY_GSM_NO_HEAP)
   String sendUSSD(const String& code) {
-    return thisModem().sendUSSDImpl(code);
+    TINY_GSM_ALLOC_SCOPE("sendUSSD");
+    // The reply is read hex encoded before it is decoded in place, and the
+    // longest USSD string, 182 characters, takes 364 digits
+    char buf[384];
+    sendUSSD(code.c_str(), buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t sendUSSD(const char* code, char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().sendUSSDImpl(code, buf, len);
   }
   bool sendSMS(const String& number, const String& text) {
     return thisModem().sendSMSImpl(number, text);
@@ -111,7 +122,74 @@ class TinyGsmSMS {
     return result;
   }
 
-  String sendUSSDImpl(const String& code) {
+  // The same three decoding a C string of hex digits in place, which the text
+  // fits in but for the \x escapes; they return the length of the text
+  static inline byte TinyGsmHexByte(const char* hex) {
+    char buf[4] = {
+        0,
+    };
+    buf[0] = hex[0];
+    buf[1] = hex[1];
+    return strtol(buf, NULL, 16);
+  }
+
+  static inline size_t TinyGsmDecodeHex7bit(char* hex) {
+    size_t n        = 0;
+    byte   reminder = 0;
+    int8_t bitstate = 7;
+    for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+      byte b  = TinyGsmHexByte(hex + i);
+      byte bb = b << (7 - bitstate);
+      hex[n++] = (bb + reminder) & 0x7F;
+      reminder = b >> bitstate;
+      bitstate--;
+      if (bitstate == 0) {
+        hex[n++] = reminder;
+        reminder = 0;
+        bitstate = 7;
+      }
+    }
+    hex[n] = '\0';
+    return n;
+  }
+
+  static inline size_t TinyGsmDecodeHex8bit(char* hex) {
+    size_t n = 0;
+    for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+      hex[n++] = TinyGsmHexByte(hex + i);
+    }
+    hex[n] = '\0';
+    return n;
+  }
+
+  // len is the size of the buffer holding hex, as an escaped character comes
+  // out longer than its digits.  The digits are moved to the end of it first
+  // and the text stops short where it would run into those not yet decoded.
+  static inline size_t TinyGsmDecodeHex16bit(char* hex, size_t len) {
+    size_t digits = strlen(hex);
+    char*  in     = hex + (len - 1 - digits);
+    memmove(in, hex, digits + 1);
+    size_t n = 0;
+    for (; in[0] && in[1] && in[2] && in[3]; in += 4) {
+      if (TinyGsmHexByte(in)) {  // If high byte is non-zero, we can't handle it
+#if defined(TINY_GSM_UNICODE_TO_HEX)
+        if (hex + n + 6 > in + 4) { break; }
+        memmove(hex + n + 2, in, 4);
+        hex[n]     = '\\';
+        hex[n + 1] = 'x';
+        n += 6;
+#else
+        hex[n++] = '?';
+#endif
+      } else {
+        hex[n++] = TinyGsmHexByte(in + 2);
+      }
+    }
+    hex[n] = '\0';
+    return n;
+  }
+
+  size_t sendUSSDImpl(const char* code, char* buf, size_t len) {
     // Set preferred message format to text mode
     thisModem().sendAT(GF("+CMGF=1"));
     thisModem().waitResponse();
@@ -120,19 +198,19 @@ class TinyGsmSMS {
     thisModem().waitResponse();
     // Send the message
     thisModem().sendAT(GF("+CUSD=1,\""), code, GF("\""));
-    if (thisModem().waitResponse() != 1) { return ""; }
-    if (thisModem().waitResponse(10000L, GF("+CUSD:")) != 1) { return ""; }
-    thisModem().stream.readStringUntil('"');
-    String hex = thisModem().stream.readStringUntil('"');
-    thisModem().stream.readStringUntil(',');
+    if (thisModem().waitResponse() != 1) { return 0; }
+    if (thisModem().waitResponse(10000L, GF("+CUSD:")) != 1) { return 0; }
+    thisModem().streamSkipUntil('"');
+    size_t n = thisModem().streamGetStringBefore('"', buf, len);
+    thisModem().streamSkipUntil(',');
     int8_t dcs = thisModem().streamGetIntBefore('\n');
 
     if (dcs == 15) {
-      return TinyGsmDecodeHex8bit(hex);
+      return TinyGsmDecodeHex8bit(buf);
     } else if (dcs == 72) {
-      return TinyGsmDecodeHex16bit(hex);
+      return TinyGsmDecodeHex16bit(buf, len);
     } else {
-      return hex;
+      return n;
     }
   }
 
@@ -0,0 +1,162 @@
+/**
+ * @file       TinyGsmServer.tpp
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef SRC_TINYGSMSERVER_H_
+#define SRC_TINYGSMSERVER_H_
+
+#include "TinyGsmCommon.h"
+
+#define TINY_GSM_MODEM_HAS_SERVER
+
+template <class modemType, uint8_t muxCount>
+class TinyGsmServer {
+  /*
+   * CRTP Helper
+   */
+ protected:
+  inline const modemType& thisModem() const {
+    return static_cast<const modemType&>(*this);
+  }
+  inline modemType& thisModem() {
+    return static_cast<modemType&>(*this);
+  }
+
+  /*
+   * Inner Server
+   */
+ public:
+  // Listens for incoming TCP connections on one port.  A modem has a single
+  // listener; the incoming connections are put on free mux numbers chosen by
+  // the modem and queued until accept() hands them out:
+  //
+  //   TinyGsmClientServer server(modem, 8080);
+  //   TinyGsmClient       client;
+  //   server.begin();
+  //   ...
+  //   if (server.accept(client)) { ... talk to the client, then stop() ... }
+  //
+  // The queue holds one connection per mux, so a burst is only limited by
+  // the number of sockets the modem has.  On modems with a buffer, whatever
+  // arrives before accept() waits in the modem; on modems without one, it
+  // is lost, so accept connections promptly there.  Keep outgoing clients on
+  // mux numbers the listener isn't using.
+  template <class clientType>
+  class GsmServer {
+   public:
+    GsmServer() {}
+    GsmServer(modemType& modem, uint16_t port) {
+      init(&modem, port);
+    }
+
+    bool init(modemType* modem, uint16_t port) {
+      this->at   = modem;
+      this->port = port;
+      return true;
+    }
+
+    // Starts listening; the data connection must be up first
+    bool begin() {
+      return at->serverListen(port);
+    }
+    // Stops listening.  Connections already accepted stay open.
+    void stop() {
+      at->serverStop();
+    }
+    bool listening() {
+      return at->serverListening;
+    }
+
+    // Number of connections waiting to be accepted
+    int available() {
+      at->maintain(0);
+      return at->acceptCount;
+    }
+
+    // Binds client to the oldest waiting connection, optionally giving the
+    // address it came from.  Returns false if none is waiting.
+    bool accept(clientType& client, IPAddress* remoteIP = NULL) {
+      uint8_t   mux;
+      IPAddress ip;
+      at->maintain(0);
+      if (!at->serverNextIncoming(&mux, &ip)) { return false; }
+      client.init(at, mux);
+      at->socketAccepted(&client);
+      if (remoteIP) { *remoteIP = ip; }
+      return true;
+    }
+
+   protected:
+    modemType* at;
+    uint16_t   port;
+  };
+
+  /*
+   * Server functions
+   */
+ protected:
+  bool serverListen(uint16_t port) {
+    if (serverListening) { serverStop(); }
+    serverListening = thisModem().modemListen(port);
+    return serverListening;
+  }
+
+  void serverStop() {
+    if (!serverListening) { return; }
+    thisModem().modemStopListening();
+    serverListening = false;
+  }
+
+  // Called by the driver's URC handling for every incoming connection.  The
+  // connection stays in the queue until it is accepted, even if it closes in
+  // the meantime, so anything it sent can still be read.
+  void serverIncoming(int8_t mux, IPAddress ip) {
+    if (mux < 0 || mux >= muxCount) { return; }
+    DBG("### Incoming:", mux);
+    // The mux may have belonged to an old client, which must not pick up the
+    // new connection's data
+    thisModem().sockets[mux] = NULL;
+    // A mux that is already waiting was closed and reused; keep its place
+    for (uint8_t i = 0; i < acceptCount; i++) {
+      IncomingSocket& waiting = acceptQueue[(acceptHead + i) % muxCount];
+      if (waiting.mux == mux) {
+        waiting.ip = ip;
+        return;
+      }
+    }
+    IncomingSocket& incoming =
+        acceptQueue[(acceptHead + acceptCount) % muxCount];
+    incoming.mux = mux;
+    incoming.ip  = ip;
+    acceptCount++;
+  }
+
+  bool serverNextIncoming(uint8_t* mux, IPAddress* ip) {
+    if (!acceptCount) { return false; }
+    *mux       = acceptQueue[acceptHead].mux;
+    *ip        = acceptQueue[acceptHead].ip;
+    acceptHead = (acceptHead + 1) % muxCount;
+    acceptCount--;
+    return true;
+  }
+
+  bool modemListen(uint16_t port) TINY_GSM_ATTR_NOT_IMPLEMENTED;
+  void modemStopListening() TINY_GSM_ATTR_NOT_IMPLEMENTED;
+
+  struct IncomingSocket {
+    uint8_t   mux;
+    IPAddress ip;  // 0.0.0.0 if the modem doesn't say
+  };
+
+  IncomingSocket acceptQueue[muxCount];
+  uint8_t        acceptHead      = 0;
+  uint8_t        acceptCount     = 0;
+  bool           serverListening = false;
+  int8_t         serverMux       = -1;  // for modems where it takes a socket
+};
+
+#endif  // SRC_TINYGSMSERVER_H_
@@ -0,0 +1,77 @@
+/**
+ * @file       TinyGsmStreamTap.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef SRC_TINYGSMSTREAMTAP_H_
+#define SRC_TINYGSMSTREAMTAP_H_
+
+#include "TinyGsmCommon.h"
+#if defined(TINY_GSM_AT_TRACE)
+#include "TinyGsmATTrace.h"
+#endif
+
+// Sits between the modem and its serial port, counting the bytes going each
+// way and, with TINY_GSM_AT_TRACE, keeping a trace of them.  The modem puts
+// one in front of the stream it is given when something compiled in needs
+// it; otherwise the stream is used directly.
+class TinyGsmStreamTap : public Stream {
+ public:
+  Stream& attach(Stream& stream) {
+    inner = &stream;
+    return *this;
+  }
+
+  int available() override {
+    return inner->available();
+  }
+  int read() override {
+    int c = inner->read();
+    if (c >= 0) {
+      bytes_in++;
+#if defined(TINY_GSM_AT_TRACE)
+      uint8_t b = c;
+      trace.record(false, &b, 1);
+#endif
+    }
+    return c;
+  }
+  int peek() override {
+    return inner->peek();
+  }
+  void flush() override {
+    inner->flush();
+  }
+
+  size_t write(uint8_t c) override {
+    size_t n = inner->write(c);
+    bytes_out += n;
+#if defined(TINY_GSM_AT_TRACE)
+    trace.record(true, &c, n);
+#endif
+    return n;
+  }
+  size_t write(const uint8_t* buf, size_t size) override {
+    size_t n = inner->write(buf, size);
+    bytes_out += n;
+#if defined(TINY_GSM_AT_TRACE)
+    trace.record(true, buf, n);
+#endif
+    return n;
+  }
+  using Print::write;
+
+  uint32_t bytes_in  = 0;
+  uint32_t bytes_out = 0;
+#if defined(TINY_GSM_AT_TRACE)
+  TinyGsmATTrace trace;
+#endif
+
+ protected:
+  Stream* inner = NULL;
+};
+
+#endif  // SRC_TINYGSMSTREAMTAP_H_
@@ -19,17 +19,77 @@
 #define TINY_GSM_RX_BUFFER 64
 #endif
 
+// For modems that can check the size of their buffer, how often to ask the
+// modem whether data has arrived without a URC.  The interval doubles every
+// time nothing is found, up to the maximum, and drops back to the minimum as
+// soon as data shows up or is sent.  A driver that trusts its URCs can define
+// a longer interval before including this file.
+#if !defined(TINY_GSM_DATA_CHECK_MS)
+#define TINY_GSM_DATA_CHECK_MS 500
+#endif
+
+#if !defined(TINY_GSM_DATA_CHECK_MAX_MS)
+#define TINY_GSM_DATA_CHECK_MAX_MS 8000
+#endif
+
+// For modems that can't check the size of their buffer, how long the last
+// known socket state is trusted before connected() asks the modem again.
+// Closing URC's and successful reads and writes keep the state current in
+// between.
+#if !defined(TINY_GSM_CONNECTED_CHECK_MS)
+#define TINY_GSM_CONNECTED_CHECK_MS 1000
+#endif
+
+// For sockets set to reconnect on their own, the delay before the first
+// attempt and the most it can grow to.  The delay doubles after every failed
+// attempt and is picked at random from its upper half, so modems that lost
+// the network together don't all come back at the same moment.
+#if !defined(TINY_GSM_RECONNECT_MIN_MS)
+#define TINY_GSM_RECONNECT_MIN_MS 1000L
+#endif
+
+#if !defined(TINY_GSM_RECONNECT_MAX_MS)
+#define TINY_GSM_RECONNECT_MAX_MS 120000L
+#endif
+
+// Called when a socket that reconnected on its own is open again.  Anything
+// that was in flight when it closed is lost, so this is where to redo a
+// login or resend a request.
+typedef void (*TinyGsmStreamResetCallback)(Client& client, void* arg);
+
+// Kept for each socket when TINY_GSM_SOCKET_STATS is defined.  Overhead is
+// everything else that went over the serial port while the socket was being
+// read, written or checked: commands, response headers, echoes and the
+// expansion of hex encoded data.  Most of it is only counted for modems that
+// keep the data in a buffer of their own; with the others the data simply
+// arrives in a URC.
+struct TinyGsmSocketStats {
+  uint32_t payload_in;  // moved into the socket's buffer
+  uint32_t payload_out;
+  uint32_t overhead_in;
+  uint32_t overhead_out;
+  uint32_t reads;    // modemRead() round trips
+  uint32_t sends;    // modemSend() round trips
+  uint32_t checks;   // queries for the amount of data waiting, on modems
+                     // that don't check all sockets together in maintain()
+  uint32_t read_us;  // time spent blocked in them
+  uint32_t send_us;
+  uint32_t check_us;
+};
+
 // Because of the ordering of resolution of overrides in templates, these need
 // to be written out every time.  This macro is to shorten that.
-#define TINY_GSM_CLIENT_CONNECT_OVERRIDES                             \
-  int connect(IPAddress ip, uint16_t port, int timeout_s) {           \
-    return connect(TinyGsmStringFromIp(ip).c_str(), port, timeout_s); \
-  }                                                                   \
-  int connect(const char* host, uint16_t port) override {             \
-    return connect(host, port, 75);                                   \
-  }                                                                   \
-  int connect(IPAddress ip, uint16_t port) override {                 \
-    return connect(ip, port, 75);                                     \
+#define TINY_GSM_CLIENT_CONNECT_OVERRIDES                          \
+  int connect(IPAddress ip, uint16_t port, int timeout_s) {        \
+    TINY_GSM_ALLOC_SCOPE("connect(IPAddress)");                    \
+    char host[16];                                                 \
+    return connect(TinyGsmCharsFromIp(ip, host), port, timeout_s); \
+  }                                                                \
+  int connect(const char* host, uint16_t port) override {          \
+    return connect(host, port, 75);                                \
+  }                                                                \
+  int connect(IPAddress ip, uint16_t port) override {              \
+    return connect(ip, port, 75);                                  \
   }
 
 // // For modules that do not store incoming data in any sort of buffer
@@ -50,6 +110,22 @@ class TinyGsmTCP {
   void maintain() {
     return thisModem().maintainImpl();
   }
+  // Handles only what the modem has already sent and returns right away if
+  // there is nothing, instead of listening for new URC's.  No new pass over
+  // the incoming data is started once budget_us microseconds have gone by,
+  // and a URC cut off part way is finished on a later call.
+  // Returns the number of characters from the modem that were handled, so 0
+  // means the modem was idle.
+  size_t maintain(uint32_t budget_us) {
+    return thisModem().maintainImpl(budget_us);
+  }
+  // Has the modem probe idle sockets so they aren't silently dropped by the
+  // network; the first probe goes out after idle_s without traffic.  Applies
+  // to sockets opened afterwards.
+  bool setKeepAlive(bool enable, uint16_t idle_s = 60, uint16_t interval_s = 30,
+                    uint8_t count = 3) {
+    return thisModem().setKeepAliveImpl(enable, idle_s, interval_s, count);
+  }
 
   /*
    * CRTP Helper
@@ -72,14 +148,18 @@ class TinyGsmTCP {
     typedef TinyGsmFifo<uint8_t, TINY_GSM_RX_BUFFER> RxFifo;
 
    public:
+    ~GsmClient() {
+      free(reconnect_host);
+    }
+
     // bool init(modemType* modem, uint8_t);
     // int connect(const char* host, uint16_t port, int timeout_s);
 
     // Connect to a IP address given as an IPAddress object by
     // converting said IP address to text
     // virtual int connect(IPAddress ip,uint16_t port, int timeout_s) {
-    //   return connect(TinyGsmStringFromIp(ip).c_str(), port,
-    //   timeout_s);
+    //   char host[16];
+    //   return connect(TinyGsmCharsFromIp(ip, host), port, timeout_s);
     // }
     // int connect(const char* host, uint16_t port) override {
     //   return connect(host, port, 75);
@@ -89,18 +169,79 @@ class TinyGsmTCP {
     // }
 
     static inline String TinyGsmStringFromIp(IPAddress ip) {
-      String host;
-      host.reserve(16);
-      host += ip[0];
-      host += ".";
-      host += ip[1];
-      host += ".";
-      host += ip[2];
-      host += ".";
-      host += ip[3];
+      char host[16];
+      return TinyGsmCharsFromIp(ip, host);
+    }
+
+    // Writes ip as dotted decimal text into host, which is what's returned
+    static inline const char* TinyGsmCharsFromIp(IPAddress ip,
+                                                 char (&host)[16]) {
+      char* c = host;
+      for (uint8_t i = 0; i < 4; i++) {
+        uint8_t octet = ip[i];
+        if (i) { *c++ = '.'; }
+        if (octet >= 100) { *c++ = '0' + octet / 100; }
+        if (octet >= 10) { *c++ = '0' + octet / 10 % 10; }
+        *c++ = '0' + octet % 10;
+      }
+      *c = '\0';
       return host;
     }
 
+    // Starts connecting and returns without waiting for the result on modems
+    // that report it later; others simply connect.  Call connecting() until
+    // it returns false, then connected() says how it went.
+    virtual int connectAsync(const char* host, uint16_t port) {
+      return connect(host, port);
+    }
+
+    // True while a connectAsync() is still waiting for the modem to report
+    // the result.  Gives up on the socket once the connect timeout passes.
+    bool connecting() {
+      if (!sock_connecting) { return false; }
+      if (millis() - connect_start > connect_timeout_ms) {
+        sock_connecting = false;
+        stop();
+        return false;
+      }
+      at->maintain(0);
+      return sock_connecting;
+    }
+
+    // Keeps the socket connected to host:port.  Whenever the modem reports
+    // it closed, maintain() opens it again after a back-off delay, first
+    // bringing the data connection back up if that dropped too.  onReset is
+    // called every time the socket is open again.  Only modems with
+    // connectAsync() and their own steps for bringing the data connection
+    // back (SIM800, BG96) reconnect without blocking maintain().  Call
+    // stopAutoReconnect() before stop() or the socket will be reopened.
+    // The copy of host is the only room it takes on the heap; false if
+    // there is none for it.
+    bool setAutoReconnect(const char* host, uint16_t port,
+                          TinyGsmStreamResetCallback onReset = NULL,
+                          void*                      arg     = NULL) {
+      size_t size = strlen(host) + 1;
+      char*  copy = static_cast<char*>(realloc(reconnect_host, size));
+      if (!copy) {
+        auto_reconnect = false;
+        return false;
+      }
+      memcpy(copy, host, size);
+      reconnect_host     = copy;
+      reconnect_port     = port;
+      reconnect_callback = onReset;
+      reconnect_arg      = arg;
+      reconnect_delay    = TINY_GSM_RECONNECT_MIN_MS;
+      reconnect_at       = millis();
+      reconnect_waiting  = false;
+      reconnect_pending  = false;
+      auto_reconnect     = true;
+      return true;
+    }
+    void stopAutoReconnect() {
+      auto_reconnect = false;
+    }
+
     // void stop(uint32_t maxWaitMs);
     // void stop() override {
     //   stop(15000L);
@@ -109,8 +250,17 @@ class TinyGsmTCP {
     // Writes data out on the client using the modem send functionality
     size_t write(const uint8_t* buf, size_t size) override {
       TINY_GSM_YIELD();
-      at->maintain();
-      return at->modemSend(buf, size, mux);
+      at->maintain(0);
+#if defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+      // A reply is likely to follow, so go back to checking for it quickly
+      check_backoff = 0;
+      return sockSend(buf, size);
+#else
+      size_t sent = sockSend(buf, size);
+      // A successful send means the socket is still open
+      if (sent) { prev_check = millis(); }
+      return sent;
+#endif
     }
 
     size_t write(uint8_t c) override {
@@ -126,13 +276,13 @@ class TinyGsmTCP {
       TINY_GSM_YIELD();
 #if defined TINY_GSM_NO_MODEM_BUFFER
       // Returns the number of characters available in the TinyGSM fifo
-      if (!rx.size() && sock_connected) { at->maintain(); }
+      if (!rx.size() && sock_connected) { at->maintain(0); }
       return rx.size();
 
 #elif defined TINY_GSM_BUFFER_READ_NO_CHECK
       // Returns the combined number of characters available in the TinyGSM
       // fifo and the modem chips internal fifo.
-      if (!rx.size()) { at->maintain(); }
+      if (!rx.size()) { at->maintain(0); }
       return static_cast<uint16_t>(rx.size()) + sock_available;
 
 #elif defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
@@ -140,13 +290,8 @@ class TinyGsmTCP {
       // fifo and the modem chips internal fifo, doing an extra check-in
       // with the modem to see if anything has arrived without a UURC.
       if (!rx.size()) {
-        if (millis() - prev_check > 500) {
-          // setting got_data to true will tell maintain to run
-          // modemGetAvailable(mux)
-          got_data   = true;
-          prev_check = millis();
-        }
-        at->maintain();
+        checkMissedData();
+        at->maintain(0);
       }
       return static_cast<uint16_t>(rx.size()) + sock_available;
 
@@ -173,6 +318,7 @@ class TinyGsmTCP {
         } /* TODO: Read directly into user buffer? */
         if (!rx.size() && sock_connected) { at->maintain(); }
       }
+      if (cnt) { prev_check = millis(); }
       return cnt;
 
 #elif defined TINY_GSM_BUFFER_READ_NO_CHECK
@@ -189,13 +335,13 @@ class TinyGsmTCP {
         } /* TODO: Read directly into user buffer? */
         at->maintain();
         if (sock_available > 0) {
-          int n = at->modemRead(TinyGsmMin((uint16_t)rx.free(), sock_available),
-                                mux);
+          int n = sockRead(TinyGsmMin((uint16_t)rx.free(), sock_available));
           if (n == 0) break;
         } else {
           break;
         }
       }
+      if (cnt) { prev_check = millis(); }
       return cnt;
 
 #elif defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
@@ -211,18 +357,11 @@ class TinyGsmTCP {
           cnt += chunk;
           continue;
         }
-        // Workaround: Some modules "forget" to notify about data arrival
-        if (millis() - prev_check > 500) {
-          // setting got_data to true will tell maintain to run
-          // modemGetAvailable()
-          got_data   = true;
-          prev_check = millis();
-        }
+        checkMissedData();
         // TODO(vshymanskyy): Read directly into user buffer?
         at->maintain();
         if (sock_available > 0) {
-          int n = at->modemRead(TinyGsmMin((uint16_t)rx.free(), sock_available),
-                                mux);
+          int n = sockRead(TinyGsmMin((uint16_t)rx.free(), sock_available));
           if (n == 0) break;
         } else {
           break;
@@ -262,8 +401,14 @@ class TinyGsmTCP {
 #elif defined TINY_GSM_NO_MODEM_BUFFER || defined TINY_GSM_BUFFER_READ_NO_CHECK
       // If the modem doesn't have an internal buffer, or if we can't check how
       // many characters are in the buffer then the cascade won't happen.
-      // We need to call modemGetConnected to check the sock state.
-      return at->modemGetConnected(mux);
+      // Closing URC's clear sock_connected as soon as they arrive, so we only
+      // need to call modemGetConnected once the last known state is stale.
+      if (!sock_connected) { return false; }
+      if (millis() - prev_check > TINY_GSM_CONNECTED_CHECK_MS) {
+        sock_connected = at->modemGetConnected(mux);
+        prev_check     = millis();
+      }
+      return sock_connected;
 #else
 #error Modem client has been incorrectly created
 #endif
@@ -278,7 +423,110 @@ class TinyGsmTCP {
 
     String remoteIP() TINY_GSM_ATTR_NOT_IMPLEMENTED;
 
+#if defined(TINY_GSM_SOCKET_STATS)
+    TinyGsmSocketStats getStats() {
+      return stats;
+    }
+    void resetStats() {
+      memset(&stats, 0, sizeof(stats));
+    }
+#endif
+
    protected:
+    // Overridden by the socket behind a GsmUDP.  Drivers check isDatagram()
+    // to pick the datagram form of their commands, and report every datagram
+    // they move into rx, with the sender if the modem gives it.
+    virtual bool isDatagram() {
+      return false;
+    }
+    virtual void datagramReceived(uint16_t, IPAddress, uint16_t) {}
+
+    // The modem's send, read and data check for this socket, counted in its
+    // stats when they are kept
+    int16_t sockSend(const void* buf, size_t size) {
+#if defined(TINY_GSM_SOCKET_STATS)
+      TrafficMark mark    = statsMark();
+      int16_t     sent    = at->modemSend(buf, size, mux);
+      uint32_t    payload = sent > 0 ? sent : 0;
+      stats.sends++;
+      stats.payload_out += payload;
+      stats.send_us += statsOverhead(mark, 0, payload);
+      return sent;
+#else
+      return at->modemSend(buf, size, mux);
+#endif
+    }
+    size_t sockRead(size_t size) {
+#if defined(TINY_GSM_SOCKET_STATS)
+      TrafficMark mark    = statsMark();
+      size_t      before  = rx.size();
+      size_t      n       = at->modemRead(size, mux);
+      uint32_t    payload = rx.size() - before;
+      stats.reads++;
+      stats.payload_in += payload;
+      stats.read_us += statsOverhead(mark, payload, 0);
+      return n;
+#else
+      return at->modemRead(size, mux);
+#endif
+    }
+#if defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+    int16_t sockGetAvailable() {
+#if defined(TINY_GSM_SOCKET_STATS)
+      TrafficMark mark      = statsMark();
+      int16_t     available = at->modemGetAvailable(mux);
+      stats.checks++;
+      stats.check_us += statsOverhead(mark, 0, 0);
+      return available;
+#else
+      return at->modemGetAvailable(mux);
+#endif
+    }
+#endif
+
+#if defined(TINY_GSM_SOCKET_STATS)
+    struct TrafficMark {
+      uint32_t us;
+      uint32_t in;
+      uint32_t out;
+    };
+    TrafficMark statsMark() {
+      TrafficMark mark = {static_cast<uint32_t>(micros()),
+                          at->streamTap.bytes_in, at->streamTap.bytes_out};
+      return mark;
+    }
+    // Counts what went over the serial port since mark, less the payload, as
+    // overhead and returns the time taken
+    uint32_t statsOverhead(const TrafficMark& mark, uint32_t payload_in,
+                           uint32_t payload_out) {
+      stats.overhead_in += at->streamTap.bytes_in - mark.in - payload_in;
+      stats.overhead_out += at->streamTap.bytes_out - mark.out - payload_out;
+      return micros() - mark.us;
+    }
+#endif
+
+#if defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+    // Workaround: Some modules "forget" to notify about data arrival, so
+    // every so often ask anyway.  Setting got_data to true will tell maintain
+    // to run modemGetAvailable(mux).  Each check that finds nothing doubles
+    // the wait before the next one.
+    inline void checkMissedData() {
+      uint32_t interval = TinyGsmMin(
+          static_cast<uint32_t>(TINY_GSM_DATA_CHECK_MS) << check_backoff,
+          static_cast<uint32_t>(TINY_GSM_DATA_CHECK_MAX_MS));
+      if (millis() - prev_check > interval) {
+        got_data   = true;
+        prev_check = millis();
+        // With no interval to double there is nothing to back off from,
+        // and the shift must stay inside 32 bits
+        if (interval && interval < TINY_GSM_DATA_CHECK_MAX_MS &&
+            check_backoff < 31) {
+          check_backoff++;
+        }
+      }
+    }
+#endif
+
     // Read and dump anything remaining in the modem's internal buffer.
     // Using this in the client stop() function.
     // The socket will appear open in response to connected() even after it
@@ -292,7 +540,7 @@ class TinyGsmTCP {
       uint32_t startMillis = millis();
       while (sock_available > 0 && (millis() - startMillis < maxWaitMs)) {
         rx.clear();
-        at->modemRead(TinyGsmMin((uint16_t)rx.free(), sock_available), mux);
+        sockRead(TinyGsmMin((uint16_t)rx.free(), sock_available));
       }
       rx.clear();
       at->streamClear();
@@ -309,10 +557,28 @@ class TinyGsmTCP {
     modemType* at;
     uint8_t    mux;
     uint16_t   sock_available;
-    uint32_t   prev_check;
+    uint32_t   prev_check;  // last data check, or last known state if none
+    uint8_t    check_backoff;
     bool       sock_connected;
+    bool       sock_connecting;
+    uint32_t   connect_start;
+    uint32_t   connect_timeout_ms;
     bool       got_data;
     RxFifo     rx;
+
+    bool                       auto_reconnect;
+    bool                       reconnect_waiting;  // an attempt is scheduled
+    bool                       reconnect_pending;  // an attempt is under way
+    char*                      reconnect_host = NULL;
+    uint16_t                   reconnect_port;
+    uint32_t                   reconnect_at;
+    uint32_t                   reconnect_delay;
+    TinyGsmStreamResetCallback reconnect_callback;
+    void*                      reconnect_arg;
+
+#if defined(TINY_GSM_SOCKET_STATS)
+    TinyGsmSocketStats stats = {};
+#endif
   };
 
   /*
@@ -320,16 +586,14 @@ class TinyGsmTCP {
    */
  protected:
   void maintainImpl() {
+    // While a queued command waits for its reply, the reply and any URC's
+    // around it are read by the command queue
+    if (thisModem().pollCommands()) { return; }
+    reconnectSockets();
 #if defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
-    // Keep listening for modem URC's and proactively iterate through
-    // sockets asking if any data is avaiable
-    for (int mux = 0; mux < muxCount; mux++) {
-      GsmClient* sock = thisModem().sockets[mux];
-      if (sock && sock->got_data) {
-        sock->got_data       = false;
-        sock->sock_available = thisModem().modemGetAvailable(mux);
-      }
-    }
+    // Keep listening for modem URC's and proactively ask about any sockets
+    // that might have data avaiable
+    checkFlaggedSockets();
     while (thisModem().stream.available()) {
       thisModem().waitResponse(15, NULL, NULL);
     }
@@ -343,6 +607,168 @@ class TinyGsmTCP {
 #endif
   }
 
+  bool setKeepAliveImpl(bool enable, uint16_t idle_s, uint16_t interval_s,
+                        uint8_t count) TINY_GSM_ATTR_NOT_IMPLEMENTED;
+
+  size_t maintainImpl(uint32_t budget_us) {
+    uint32_t startMicros = micros();
+    size_t   handled     = 0;
+    if (thisModem().pollCommands()) { return handled; }
+    reconnectSockets();
+#if defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+    checkFlaggedSockets();
+#endif
+    // Only what has already arrived is handled, waiting at most for what is
+    // left of the budget.  A line cut off part way is kept for the next call
+    // rather than waited for.
+#if defined(TINY_GSM_NO_HEAP)
+    // Between calls it is kept in a fixed buffer
+    String line(thisModem().partialLine);
+    thisModem().partialData = &line;
+#else
+    String& line = thisModem().partialLine;
+#endif
+    do {
+      int before = thisModem().stream.available();
+      if (before <= 0) { break; }
+      uint32_t spent = micros() - startMicros;
+      uint32_t left  = spent < budget_us ? budget_us - spent : 0;
+      thisModem().waitResponse(left / 1000, line, NULL, NULL);
+      int after = thisModem().stream.available();
+      if (before > after) { handled += before - after; }
+      // Keep only the last line, still unfinished, with the line break ahead
+      // of it that the URC's are matched on
+      int nl = line.lastIndexOf('\n');
+      if (nl > 0) { line.remove(0, nl - 1); }
+      if (line.length() > 128) { line = ""; }
+    } while (micros() - startMicros < budget_us);
+#if defined(TINY_GSM_NO_HEAP)
+    TinyGsmCopyString(thisModem().partialLine, sizeof(thisModem().partialLine),
+                      line.c_str());
+    thisModem().partialData = NULL;
+#endif
+    return handled;
+  }
+
+  // Marks a socket just bound to a connection the modem accepted as open
+  void socketAccepted(GsmClient* sock) {
+    sock->sock_connected = true;
+    sock->prev_check     = millis();
+#if defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+    // Data may have come in before it was accepted
+    sock->got_data = true;
+#endif
+  }
+
+  // Reopens the sockets set to reconnect on their own that have closed, once
+  // their back-off delay has passed
+  void reconnectSockets() {
+    int8_t data = -2;  // not asked yet, the modem is asked once a pass
+    for (int mux = 0; mux < muxCount; mux++) {
+      GsmClient* sock = thisModem().sockets[mux];
+      if (!sock || !sock->auto_reconnect) { continue; }
+      if (sock->sock_connecting) {
+        if (millis() - sock->connect_start <= sock->connect_timeout_ms) {
+          continue;
+        }
+        // The next attempt closes the socket before opening it again
+        sock->sock_connecting = false;
+      }
+      if (sock->sock_connected) {
+        if (sock->reconnect_pending) {
+          sock->reconnect_pending = false;
+          sock->reconnect_delay   = TINY_GSM_RECONNECT_MIN_MS;
+          if (sock->reconnect_callback) {
+            sock->reconnect_callback(*sock, sock->reconnect_arg);
+          }
+        }
+        continue;
+      }
+      if (!sock->reconnect_waiting) {
+        // Wait somewhere between half and all of the current delay
+        uint32_t half   = sock->reconnect_delay / 2;
+        uint32_t jitter = (micros() ^ (mux * 2654435761UL)) % (half + 1);
+        sock->reconnect_at      = millis() + half + jitter;
+        sock->reconnect_waiting = true;
+        sock->reconnect_delay   = TinyGsmMin(
+            sock->reconnect_delay * 2, (uint32_t)TINY_GSM_RECONNECT_MAX_MS);
+      }
+      if ((int32_t)(millis() - sock->reconnect_at) < 0) { continue; }
+      if (data == -2) { data = thisModem().restoreDataConnectionImpl(); }
+      // Still bringing the data connection back, try again next pass
+      if (data == 0) { continue; }
+      sock->reconnect_waiting = false;
+      // Whatever the modem still held for the old connection is gone with it,
+      // so there is nothing to read out before closing
+      sock->sock_available = 0;
+      sock->rx.clear();
+      if (data < 0) { continue; }
+      sock->reconnect_pending = true;
+      sock->connectAsync(sock->reconnect_host, sock->reconnect_port);
+    }
+  }
+
+#if defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+  inline void checkFlaggedSockets() {
+    bool check_socks = false;
+    for (int mux = 0; mux < muxCount; mux++) {
+      GsmClient* sock = thisModem().sockets[mux];
+      if (sock && sock->got_data) { check_socks = true; }
+    }
+    if (!check_socks) { return; }
+    thisModem().modemCheckAvailable();
+    for (int mux = 0; mux < muxCount; mux++) {
+      GsmClient* sock = thisModem().sockets[mux];
+      if (sock && sock->sock_available) { sock->check_backoff = 0; }
+    }
+  }
+#endif
+
+#if defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+  // Updates the available count of every socket flagged with got_data, one
+  // socket at a time.  Drivers whose firmware can report on all sockets in a
+  // single command should override this so one round trip covers every mux.
+  void modemCheckAvailable() {
+    for (int mux = 0; mux < muxCount; mux++) {
+      GsmClient* sock = thisModem().sockets[mux];
+      if (sock && sock->got_data) {
+        sock->got_data       = false;
+        sock->sock_available = sock->sockGetAvailable();
+      }
+    }
+  }
+#endif
+
+  // Sends query<mux>arg for each socket in mask on one command line, as in
+  // AT+USORD=0,0;+USORD=2,0, for modems that take several commands at once
+  void sendATEachSocket(GsmConstStr query, GsmConstStr arg, uint8_t mask) {
+    thisModem().finishCommand();
+#if defined(TINY_GSM_AT_STATS)
+    thisModem().atStats.commandSent(query);
+#endif
+    thisModem().stream.print("AT");
+    bool first = true;
+    for (int mux = 0; mux < muxCount; mux++) {
+      if (!(mask & (1 << mux))) { continue; }
+      if (!first) { thisModem().stream.print(';'); }
+      thisModem().streamWrite(query, mux, arg);
+      first = false;
+    }
+    thisModem().stream.print(thisModem().gsmNL);
+    thisModem().stream.flush();
+    TINY_GSM_YIELD();
+  }
+
+  // Reads the next reply to a line from sendATEachSocket(): 1 for one of the
+  // replies, 2 once the line is done, anything else if a command failed
+  int8_t waitEachSocket(GsmConstStr reply) {
+    int8_t res = thisModem().waitResponse(1000L, reply, GF("OK\r\n"),
+                                          GF("ERROR\r\n"),
+                                          GF("\r\n+CME ERROR:"));
+    if (res == 4) { thisModem().streamSkipUntil('\n'); }  // The error text
+    return res;
+  }
+
   // Yields up to a time-out period and then reads a character from the stream
   // into the mux FIFO
   // TODO(SRGDamia1):  Do we need to wait two _timeout periods for no
@@ -351,13 +777,14 @@ class TinyGsmTCP {
   // function.
   inline void moveCharFromStreamToFifo(uint8_t mux) {
     if (!thisModem().sockets[mux]) return;
-    uint32_t startMillis = millis();
-    while (!thisModem().stream.available() &&
-           (millis() - startMillis < thisModem().sockets[mux]->_timeout)) {
-      TINY_GSM_YIELD();
-    }
+    thisModem().streamWaitAvailable(1, millis(),
+                                    thisModem().sockets[mux]->_timeout);
     char c = thisModem().stream.read();
     thisModem().sockets[mux]->rx.put(c);
+#if defined(TINY_GSM_SOCKET_STATS) && defined(TINY_GSM_NO_MODEM_BUFFER)
+    // Data from these modems comes in URC's instead of through sockRead()
+    thisModem().sockets[mux]->stats.payload_in++;
+#endif
   }
 };
 
@@ -21,8 +21,17 @@ class TinyGsmTime {
   /*
    * Time functions
    */
+#if !defined(TINY_GSM_NO_HEAP)
   String getGSMDateTime(TinyGSMDateTimeFormat format) {
-    return thisModem().getGSMDateTimeImpl(format);
+    TINY_GSM_ALLOC_SCOPE("getGSMDateTime");
+    char buf[32];
+    getGSMDateTime(format, buf, sizeof(buf));
+    return buf;
+  }
+#endif
+  size_t getGSMDateTime(TinyGSMDateTimeFormat format, char* buf, size_t len) {
+    if (!TinyGsmClearBuffer(buf, len)) { return 0; }
+    return thisModem().getGSMDateTimeImpl(format, buf, len);
   }
   bool getNetworkTime(int* year, int* month, int* day, int* hour, int* minute,
                       int* second, float* timezone) {
@@ -45,22 +54,27 @@ class TinyGsmTime {
    * Time functions
    */
  protected:
-  String getGSMDateTimeImpl(TinyGSMDateTimeFormat format) {
+  size_t getGSMDateTimeImpl(TinyGSMDateTimeFormat format, char* buf,
+                            size_t len) {
     thisModem().sendAT(GF("+CCLK?"));
-    if (thisModem().waitResponse(2000L, GF("+CCLK: \"")) != 1) { return ""; }
+    if (thisModem().waitResponse(2000L, GF("+CCLK: \"")) != 1) { return 0; }
 
-    String res;
+    size_t n = 0;
 
     switch (format) {
-      case DATE_FULL: res = thisModem().stream.readStringUntil('"'); break;
+      case DATE_FULL:
+        n = thisModem().streamGetStringBefore('"', buf, len);
+        break;
       case DATE_TIME:
         thisModem().streamSkipUntil(',');
-        res = thisModem().stream.readStringUntil('"');
+        n = thisModem().streamGetStringBefore('"', buf, len);
+        break;
+      case DATE_DATE:
+        n = thisModem().streamGetStringBefore(',', buf, len);
         break;
-      case DATE_DATE: res = thisModem().stream.readStringUntil(','); break;
     }
     thisModem().waitResponse();  // Ends with OK
-    return res;
+    return n;
   }
 
   bool getNetworkTimeImpl(int* year, int* month, int* day, int* hour,
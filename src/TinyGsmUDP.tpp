@@ -0,0 +1,287 @@
+/**
+ * @file       TinyGsmUDP.tpp
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef SRC_TINYGSMUDP_H_
+#define SRC_TINYGSMUDP_H_
+
+#include "TinyGsmCommon.h"
+
+#define TINY_GSM_MODEM_HAS_UDP
+
+#include <Udp.h>
+
+// Largest datagram that can be put together with beginPacket()/endPacket();
+// sendTo() takes the caller's buffer and isn't limited by this
+#if !defined(TINY_GSM_UDP_TX_BUFFER)
+#define TINY_GSM_UDP_TX_BUFFER 256
+#endif
+
+template <class modemType, uint8_t muxCount>
+class TinyGsmUDP {
+  /*
+   * CRTP Helper
+   */
+ protected:
+  inline const modemType& thisModem() const {
+    return static_cast<const modemType&>(*this);
+  }
+  inline modemType& thisModem() {
+    return static_cast<modemType&>(*this);
+  }
+
+  /*
+   * Inner UDP client
+   */
+ public:
+  // Built on the driver's TCP client, so a UDP socket takes a mux number like
+  // any other and its data comes in through the same URC's and FIFO.  Only
+  // for modems that can check the size of their buffer.
+  //
+  // Modems that can open a socket without a fixed remote end address every
+  // datagram on its own.  The others open the socket towards the destination
+  // of the first datagram and reopen it whenever the destination changes; on
+  // those, nothing can be received before the first datagram is sent.
+  //
+  // Each parsePacket() returns one read from the modem.  That is exactly one
+  // datagram on modems that report datagrams separately; on the others it can
+  // be several datagrams that arrived together, or part of one bigger than
+  // TINY_GSM_RX_BUFFER.
+  template <class clientType>
+  class GsmUDP : public UDP {
+   public:
+    GsmUDP() {}
+    explicit GsmUDP(modemType& modem, uint8_t mux = 0) {
+      init(&modem, mux);
+    }
+
+    bool init(modemType* modem, uint8_t mux = 0) {
+      this->at    = modem;
+      localPort   = 0;
+      bound       = false;
+      destHost[0] = '\0';
+      destPort    = 0;
+      txHost[0]   = '\0';
+      txLen       = 0;
+      packetLeft  = 0;
+      packetPort  = 0;
+      sock.packet = 0;
+      return sock.init(modem, mux);
+    }
+
+    uint8_t begin(uint16_t port) override {
+      stop();
+      localPort = port;
+      bound     = openSocket(NULL, 0);
+      // Otherwise the socket opens with the first datagram sent
+      return 1;
+    }
+
+    void stop() override {
+      if (sock.sock_connected) { sock.stop(); }
+      bound      = false;
+      destHost[0] = '\0';
+      destPort    = 0;
+      packetLeft  = 0;
+    }
+
+    int beginPacket(IPAddress ip, uint16_t port) override {
+      char host[16];
+      return beginPacket(clientType::TinyGsmCharsFromIp(ip, host), port);
+    }
+    // Fails for a host name longer than TINY_GSM_HOST_LEN
+    int beginPacket(const char* host, uint16_t port) override {
+      txPort = port;
+      txLen  = 0;
+      return TinyGsmKeepString(txHost, sizeof(txHost), host);
+    }
+    int endPacket() override {
+      size_t len = txLen;
+      txLen      = 0;
+      if (!txHost[0]) { return 0; }
+      return sendTo(txHost, txPort, txBuf, len) == len;
+    }
+
+    size_t write(uint8_t c) override {
+      return write(&c, 1);
+    }
+    size_t write(const uint8_t* buf, size_t size) override {
+      size_t len = TinyGsmMin(size, TINY_GSM_UDP_TX_BUFFER - txLen);
+      memcpy(txBuf + txLen, buf, len);
+      txLen += len;
+      return len;
+    }
+
+    // Sends one datagram straight from buf.  Returns the number of bytes the
+    // modem took.
+    size_t sendTo(const char* host, uint16_t port, const uint8_t* buf,
+                  size_t size) {
+      int16_t sent;
+      if (bound) {
+        sent = sock.sockSendTo(host, port, buf, size);
+      } else {
+        if (!sock.sock_connected || strcmp(destHost, host) ||
+            destPort != port) {
+          if (!openSocket(host, port)) { return 0; }
+        }
+        sent = sock.sockSend(buf, size);
+      }
+      // A failed send comes back negative
+      return sent > 0 ? sent : 0;
+    }
+    size_t sendTo(IPAddress ip, uint16_t port, const uint8_t* buf,
+                  size_t size) {
+      char host[16];
+      return sendTo(clientType::TinyGsmCharsFromIp(ip, host), port, buf, size);
+    }
+
+    // Moves on to the next datagram, dropping whatever is left of the current
+    // one.  Returns its size, or 0 if nothing has come in.
+    int parsePacket() override {
+      while (packetLeft > 0) {
+        uint8_t c;
+        sock.rx.get(&c, 1);
+        packetLeft--;
+      }
+      if (!sock.packet && sock.sock_connected) {
+        // Runs maintain() and the check for data that came in without a URC
+        sock.available();
+        if (sock.sock_available > 0 && !sock.packet) {
+          sock.sockRead(
+              TinyGsmMin((uint16_t)sock.rx.free(), sock.sock_available));
+        }
+      }
+      if (!sock.packet) { return 0; }
+      packetLeft  = sock.packet;
+      sock.packet = 0;
+      packetIP    = sock.packetIP;
+      packetPort  = sock.packetPort;
+      // Modems with a fixed remote end don't say who sent it
+      if (!packetPort) {
+        packetIP   = modemType::TinyGsmIpFromString(destHost);
+        packetPort = destPort;
+      }
+      return packetLeft;
+    }
+
+    int available() override {
+      return packetLeft;
+    }
+    int read(uint8_t* buf, size_t size) override {
+      size_t len = TinyGsmMin(size, static_cast<size_t>(packetLeft));
+      sock.rx.get(buf, len);
+      packetLeft -= len;
+      return len;
+    }
+    int read(char* buf, size_t size) override {
+      return read(reinterpret_cast<uint8_t*>(buf), size);
+    }
+    int read() override {
+      uint8_t c;
+      if (read(&c, 1) == 1) { return c; }
+      return -1;
+    }
+    int peek() override {
+      if (!packetLeft) { return -1; }
+      return sock.rx.peek();
+    }
+    void flush() override {
+      at->stream.flush();
+    }
+
+    IPAddress remoteIP() override {
+      return packetIP;
+    }
+    uint16_t remotePort() override {
+      return packetPort;
+    }
+
+   protected:
+    class Socket : public clientType {
+      friend class GsmUDP;
+
+     protected:
+      bool isDatagram() override {
+        return true;
+      }
+      void datagramReceived(uint16_t len, IPAddress ip,
+                            uint16_t port) override {
+        packet += len;
+        packetIP   = ip;
+        packetPort = port;
+      }
+
+      // modemSendTo() on this socket, counted in its stats like sockSend()
+      int16_t sockSendTo(const char* host, uint16_t port, const void* buf,
+                         size_t size) {
+#if defined(TINY_GSM_SOCKET_STATS)
+        typename clientType::TrafficMark mark = this->statsMark();
+
+        int16_t sent = this->at->modemSendTo(buf, size, this->mux, host, port);
+        uint32_t payload = sent > 0 ? sent : 0;
+        this->stats.sends++;
+        this->stats.payload_out += payload;
+        this->stats.send_us += this->statsOverhead(mark, 0, payload);
+        return sent;
+#else
+        return this->at->modemSendTo(buf, size, this->mux, host, port);
+#endif
+      }
+
+      uint16_t  packet;  // bytes of the next datagram waiting in rx
+      IPAddress packetIP;
+      uint16_t  packetPort;
+    };
+
+    // Opens the socket with no fixed remote end if host is NULL
+    bool openSocket(const char* host, uint16_t port) {
+      if (sock.sock_connected) { sock.stop(); }
+      uint8_t oldMux      = sock.mux;
+      sock.sock_connected = at->modemOpenUDP(host, port, &sock.mux, localPort);
+      if (sock.mux != oldMux) {
+        at->sockets[oldMux]   = NULL;
+        at->sockets[sock.mux] = &sock;
+      }
+      // A host too long to keep has the socket opened again for each send
+      TinyGsmKeepString(destHost, sizeof(destHost), host ? host : "");
+      destPort = port;
+      return sock.sock_connected;
+    }
+
+    modemType* at;
+    Socket     sock;
+    uint16_t   localPort;
+    bool       bound;  // opened with no fixed remote end
+    char       destHost[TINY_GSM_HOST_LEN];
+    uint16_t   destPort;
+    char       txHost[TINY_GSM_HOST_LEN];
+    uint16_t   txPort;
+    uint8_t    txBuf[TINY_GSM_UDP_TX_BUFFER];
+    size_t     txLen;
+    uint16_t   packetLeft;
+    IPAddress  packetIP;
+    uint16_t   packetPort;
+  };
+
+  /*
+   * UDP functions
+   */
+ protected:
+  // Opens a UDP socket towards host:port, or with no fixed remote end if host
+  // is NULL (returning false if the modem can't).  May move the socket to
+  // the mux number the modem picks.
+  bool modemOpenUDP(const char* host, uint16_t port, uint8_t* mux,
+                    uint16_t localPort) TINY_GSM_ATTR_NOT_IMPLEMENTED;
+
+  // Sends one datagram on a socket opened with no fixed remote end; only
+  // needed by modems that can open one
+  int16_t modemSendTo(const void*, size_t, uint8_t, const char*, uint16_t) {
+    return 0;
+  }
+};
+
+#endif  // SRC_TINYGSMUDP_H_
@@ -0,0 +1,85 @@
+/**
+ * @file       TinyGsmWait.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef SRC_TINYGSMWAIT_H_
+#define SRC_TINYGSMWAIT_H_
+
+#include "TinyGsmCommon.h"
+
+// Everywhere the library waits for the modem to send something it spins on
+// TINY_GSM_YIELD() by default.  Give the modem one of these with
+// setWaitStrategy() to have it sleep until characters actually arrive.
+class TinyGsmWaitStrategy {
+ public:
+  virtual ~TinyGsmWaitStrategy() {}
+
+  // Returns once the stream has at least count characters available or
+  // timeout_ms has passed since startMillis, true if the characters are there
+  virtual bool waitAvailable(Stream& stream, int count, uint32_t startMillis,
+                             uint32_t timeout_ms) = 0;
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <poll.h>
+
+// For host builds where the stream reads from a file descriptor (a tty or a
+// socket).  The stream's available() must pull in whatever the descriptor
+// has ready.
+class TinyGsmPollWait : public TinyGsmWaitStrategy {
+ public:
+  explicit TinyGsmPollWait(int fd) : fd(fd) {}
+
+  bool waitAvailable(Stream& stream, int count, uint32_t startMillis,
+                     uint32_t timeout_ms) override {
+    while (stream.available() < count) {
+      uint32_t elapsed = millis() - startMillis;
+      if (elapsed >= timeout_ms) { return false; }
+      struct pollfd pfd;
+      pfd.fd      = fd;
+      pfd.events  = POLLIN;
+      pfd.revents = 0;
+      // poll() takes an int, so wait at most a second at a time
+      int wait_ms = static_cast<int>(
+          TinyGsmMin(timeout_ms - elapsed, static_cast<uint32_t>(1000)));
+      if (poll(&pfd, 1, wait_ms) < 0 && errno != EINTR) {
+        return stream.available() >= count;
+      }
+    }
+    return true;
+  }
+
+ protected:
+  int fd;
+};
+#endif
+
+#if defined(INC_FREERTOS_H) && defined(SEMAPHORE_H)
+// For FreeRTOS, where the UART receive interrupt (or the UART driver's event
+// task) gives a binary semaphore every time characters come in.
+class TinyGsmSemaphoreWait : public TinyGsmWaitStrategy {
+ public:
+  explicit TinyGsmSemaphoreWait(SemaphoreHandle_t rxSemaphore)
+      : rxSemaphore(rxSemaphore) {}
+
+  bool waitAvailable(Stream& stream, int count, uint32_t startMillis,
+                     uint32_t timeout_ms) override {
+    while (stream.available() < count) {
+      uint32_t elapsed = millis() - startMillis;
+      if (elapsed >= timeout_ms) { return false; }
+      xSemaphoreTake(rxSemaphore, pdMS_TO_TICKS(timeout_ms - elapsed));
+    }
+    return true;
+  }
+
+ protected:
+  SemaphoreHandle_t rxSemaphore;
+};
+#endif
+
+#endif  // SRC_TINYGSMWAIT_H_
@@ -44,6 +44,13 @@ class TinyGsmWifi {
   bool networkConnectImpl(const char* ssid,
                           const char* pwd) TINY_GSM_ATTR_NOT_IMPLEMENTED;
   bool networkDisconnectImpl() TINY_GSM_ATTR_NOT_IMPLEMENTED;
+
+  // Used by sockets reconnecting on their own, 1 if the network is there
+  // and -1 if not.  The module rejoins the access point by itself, so there
+  // is nothing to bring back here.
+  int8_t restoreDataConnectionImpl() {
+    return thisModem().isNetworkConnected() ? 1 : -1;
+  }
 };
 
 #endif  // SRC_TINYGSMWIFI_H_
@@ -0,0 +1,353 @@
+/**************************************************************
+ *
+ * Times the small routines every driver leans on, on a Linux host, so a
+ * change to one of them can be checked for speed and heap use.
+ *
+ * Parts of them depend on the driver, so build once for each driver to
+ * look at, against a host Arduino core such as EpoxyDuino:
+ *
+ *   g++ -std=gnu++11 -O2 -DTINY_GSM_MODEM_SIM800 -I<core> -I../../../src \
+ *       Microbench.cpp <core sources> -o mb_sim800
+ *   ./mb_sim800 > results.csv
+ *   ./mb_bg96 --header no >> results.csv
+ *
+ * Options:
+ *   --filter <text>     only the benchmarks with text in their name
+ *   --min-ms <ms>       time each benchmark for at least this long,
+ *                       default 200
+ *   --format csv|json   one CSV row (after a header) or JSON object per
+ *                       benchmark, default csv
+ *   --header no         leaves out the CSV header, for appending
+ *   --budget <file>     fails the run if a benchmark allocates more often
+ *                       than its line "<benchmark> <allocs per op>" allows
+ *
+ * Each benchmark reports the mean time per operation, the heap allocations
+ * (malloc, calloc, realloc and new) and bytes asked for per operation, and
+ * how far the heap grew at most.  Heap use is counted by
+ * TINY_GSM_ALLOC_STATS, with glibc only here; elsewhere it shows -1.
+ *
+ * Benchmarks:
+ *   fifo_put_get          one character into and out of a TinyGsmFifo
+ *   fifo_bulk_<n>         n characters in and out in one call each
+ *   ip_from_string        TinyGsmIpFromString("192.168.100.200")
+ *   string_from_ip        TinyGsmStringFromIp(192.168.100.200)
+ *   chars_from_ip         TinyGsmCharsFromIp(192.168.100.200), into a buffer
+ *   decode_hex7bit,       TinyGsmDecodeHex7bit/8bit/16bit on a message of
+ *   decode_hex8bit,       160 hex characters (modems with SMS)
+ *   decode_hex16bit
+ *   get_int_before        streamGetIntBefore(',') over "12345,"
+ *   get_float_before      streamGetFloatBefore(',') over "-12.345678,"
+ *   wait_ok               waitResponse() over "\r\nOK\r\n"
+ *   wait_info             waitResponse() over an information line and OK
+ *   wait_error            waitResponse() over "\r\nERROR\r\n"
+ *
+ **************************************************************/
+
+// Heap use comes from the library's own accounting
+#define TINY_GSM_ALLOC_STATS
+
+#include <TinyGsmClient.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+#if defined(TINY_GSM_ALLOC_STATS_HOOKED)
+#define BENCH_COUNTS_HEAP 1
+#else
+#define BENCH_COUNTS_HEAP 0
+#endif
+
+// Hands out the same text over and over, to feed the parsers
+class MemoryStream : public Stream {
+ public:
+  void load(const char* text) {
+    data = text;
+    len  = strlen(text);
+    pos  = 0;
+  }
+  void rewind() {
+    pos = 0;
+  }
+
+  int available() override {
+    return len - pos;
+  }
+  int read() override {
+    return pos < len ? static_cast<uint8_t>(data[pos++]) : -1;
+  }
+  int peek() override {
+    return pos < len ? static_cast<uint8_t>(data[pos]) : -1;
+  }
+  void flush() override {}
+  size_t write(uint8_t) override {
+    return 1;
+  }
+  using Print::write;
+
+ protected:
+  const char* data = "";
+  size_t      len  = 0;
+  size_t      pos  = 0;
+};
+
+// Opens up the protected helpers
+class BenchModem : public TinyGsm {
+ public:
+  explicit BenchModem(Stream& stream) : TinyGsm(stream) {}
+
+  using TinyGsm::streamGetFloatBefore;
+  using TinyGsm::streamGetIntBefore;
+  using TinyGsm::TinyGsmIpFromString;
+#if defined(TINY_GSM_MODEM_HAS_SMS)
+  using TinyGsm::TinyGsmDecodeHex16bit;
+  using TinyGsm::TinyGsmDecodeHex7bit;
+  using TinyGsm::TinyGsmDecodeHex8bit;
+#endif
+};
+
+struct Options {
+  const char* filter = NULL;
+  double      min_ms = 200;
+  bool        json   = false;
+  bool        header = true;
+};
+
+// Most allocations per operation a benchmark may make
+struct Budget {
+  std::string name;
+  double      max_allocs;
+};
+
+static Options             opts;
+static std::vector<Budget> budgets;
+static bool                over_budget = false;
+static volatile uint32_t   sink;
+
+// The driver's class name, e.g. "Sim800", as the compiler spells it out
+template <class T>
+static std::string typeName() {
+  std::string name = __PRETTY_FUNCTION__;
+  size_t      at   = name.find("TinyGsm", name.find("T = "));
+  size_t      end  = name.find_first_of(";]", at);
+  if (at == std::string::npos || end == std::string::npos) { return "?"; }
+  return name.substr(at + 7, end - at - 7);
+}
+static const std::string modem_name = typeName<TinyGsm>();
+
+static double nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Runs op often enough to take min_ms, then reports it
+template <typename Op>
+static void bench(const char* name, Op op) {
+  if (opts.filter && !strstr(name, opts.filter)) { return; }
+  op();  // warm up
+  TinyGsmHeap& heap = TinyGsmHeapTotals();
+  uint64_t     runs = 1;
+  double       elapsed;
+  uint32_t     allocs;
+  uint32_t     bytes;
+  uint32_t     base;
+  for (;;) {
+    allocs       = heap.allocs;
+    bytes        = heap.bytes;
+    base         = heap.in_use;
+    heap.peak    = heap.in_use;
+    double start = nowNs();
+    for (uint64_t i = 0; i < runs; i++) { op(); }
+    elapsed = nowNs() - start;
+    if (elapsed >= opts.min_ms * 1e6) { break; }
+    // Aim a little past min_ms from what this round took
+    double scale = elapsed > 0 ? opts.min_ms * 1.2e6 / elapsed : 100;
+    runs = static_cast<uint64_t>(runs * TinyGsmMin(TinyGsmMax(scale, 2.0),
+                                                   100.0));
+  }
+  double ns        = elapsed / runs;
+  double per_alloc = -1;
+  double per_bytes = -1;
+  double peak      = -1;
+  if (BENCH_COUNTS_HEAP) {
+    per_alloc = static_cast<double>(heap.allocs - allocs) / runs;
+    per_bytes = static_cast<double>(heap.bytes - bytes) / runs;
+    peak      = heap.peak > base ? heap.peak - base : 0;
+  }
+  if (opts.json) {
+    printf("{\"modem\":\"%s\",\"benchmark\":\"%s\",\"ns_per_op\":%.1f,"
+           "\"allocs_per_op\":%.2f,\"bytes_per_op\":%.1f,"
+           "\"heap_peak\":%.0f}\n",
+           modem_name.c_str(), name, ns, per_alloc, per_bytes, peak);
+  } else {
+    printf("%s,%s,%.1f,%.2f,%.1f,%.0f\n", modem_name.c_str(), name, ns,
+           per_alloc, per_bytes, peak);
+  }
+  fflush(stdout);
+  for (size_t b = 0; b < budgets.size(); b++) {
+    if (budgets[b].name == name && per_alloc > budgets[b].max_allocs) {
+      fprintf(stderr, "%s: %.2f allocations per operation, budget %.2f\n",
+              name, per_alloc, budgets[b].max_allocs);
+      over_budget = true;
+    }
+  }
+}
+
+// Reads "<benchmark> <most allocations per operation>" lines
+static bool loadBudgets(const char* path) {
+  FILE* file = fopen(path, "r");
+  if (!file) { return false; }
+  char   name[64];
+  double max_allocs;
+  while (fscanf(file, "%63s %lf", name, &max_allocs) == 2) {
+    Budget budget;
+    budget.name       = name;
+    budget.max_allocs = max_allocs;
+    budgets.push_back(budget);
+  }
+  fclose(file);
+  return true;
+}
+
+static void fifoBenchmarks() {
+  static TinyGsmFifo<uint8_t, TINY_GSM_RX_BUFFER> fifo;
+  bench("fifo_put_get", [] {
+    uint8_t c = 0x55;
+    fifo.put(c);
+    fifo.get(&c);
+    sink += c;
+  });
+
+  static TinyGsmFifo<uint8_t, 1024> bulk;
+  static uint8_t                    buf[512];
+  const int                         sizes[] = {8, 64, 512};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    static int n;
+    n = sizes[s];
+    char name[32];
+    snprintf(name, sizeof(name), "fifo_bulk_%d", n);
+    bench(name, [] {
+      bulk.put(buf, n);
+      sink += bulk.get(buf, n);
+    });
+  }
+}
+
+static void addressBenchmarks() {
+  static String    text("192.168.100.200");
+  static IPAddress ip(192, 168, 100, 200);
+  bench("ip_from_string", [] {
+    IPAddress parsed = BenchModem::TinyGsmIpFromString(text);
+    sink += parsed[3];
+  });
+  bench("string_from_ip", [] {
+    String printed = TinyGsmClient::TinyGsmStringFromIp(ip);
+    sink += printed.length();
+  });
+  bench("chars_from_ip", [] {
+    char printed[16];
+    sink += strlen(TinyGsmClient::TinyGsmCharsFromIp(ip, printed));
+  });
+}
+
+#if defined(TINY_GSM_MODEM_HAS_SMS)
+static void smsBenchmarks() {
+  static String hex7;
+  static String hex8;
+  static String hex16;
+  // "Hello world!" and the like, repeated out to 160 characters
+  while (hex7.length() < 160) { hex7 += "C8329BFD065DDF72363904"; }
+  while (hex8.length() < 160) { hex8 += "48656C6C6F20776F726C6421"; }
+  while (hex16.length() < 160) { hex16 += "00480065006C006C006F0021"; }
+  hex7  = hex7.substring(0, 160);
+  hex8  = hex8.substring(0, 160);
+  hex16 = hex16.substring(0, 160);
+  bench("decode_hex7bit", [] {
+    sink += BenchModem::TinyGsmDecodeHex7bit(hex7).length();
+  });
+  bench("decode_hex8bit", [] {
+    sink += BenchModem::TinyGsmDecodeHex8bit(hex8).length();
+  });
+  bench("decode_hex16bit", [] {
+    sink += BenchModem::TinyGsmDecodeHex16bit(hex16).length();
+  });
+}
+#endif
+
+static void parserBenchmarks() {
+  static MemoryStream stream;
+  static BenchModem   modem(stream);
+
+  stream.load("12345,");
+  bench("get_int_before", [] {
+    stream.rewind();
+    sink += modem.streamGetIntBefore(',');
+  });
+  stream.load("-12.345678,");
+  bench("get_float_before", [] {
+    stream.rewind();
+    sink += static_cast<uint32_t>(modem.streamGetFloatBefore(','));
+  });
+
+  stream.load(GSM_NL "OK" GSM_NL);
+  bench("wait_ok", [] {
+    stream.rewind();
+    sink += modem.waitResponse(1000L);
+  });
+  stream.load(GSM_NL "+CSQ: 20,0" GSM_NL GSM_NL "OK" GSM_NL);
+  bench("wait_info", [] {
+    stream.rewind();
+    sink += modem.waitResponse(1000L);
+  });
+  stream.load(GSM_NL "ERROR" GSM_NL);
+  bench("wait_error", [] {
+    stream.rewind();
+    sink += modem.waitResponse(1000L);
+  });
+}
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (!value) {
+      fprintf(stderr, "Missing value for %s\n", argv[i]);
+      return 2;
+    }
+    if (!strcmp(argv[i], "--filter")) {
+      opts.filter = value;
+    } else if (!strcmp(argv[i], "--min-ms")) {
+      opts.min_ms = atof(value);
+    } else if (!strcmp(argv[i], "--format")) {
+      opts.json = !strcmp(value, "json");
+    } else if (!strcmp(argv[i], "--header")) {
+      opts.header = strcmp(value, "no") != 0;
+    } else if (!strcmp(argv[i], "--budget")) {
+      if (!loadBudgets(value)) {
+        fprintf(stderr, "Can't read %s\n", value);
+        return 2;
+      }
+    } else {
+      fprintf(stderr, "Unknown option %s\n", argv[i]);
+      return 2;
+    }
+    i++;
+  }
+  if (!opts.json && opts.header) {
+    printf("modem,benchmark,ns_per_op,allocs_per_op,bytes_per_op,"
+           "heap_peak\n");
+  }
+
+  fifoBenchmarks();
+  addressBenchmarks();
+#if defined(TINY_GSM_MODEM_HAS_SMS)
+  smsBenchmarks();
+#endif
+  parserBenchmarks();
+  // Going over an allocation budget fails the run, so scripts notice
+  return over_budget ? 1 : 0;
+}
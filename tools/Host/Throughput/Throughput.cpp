@@ -0,0 +1,315 @@
+/**************************************************************
+ *
+ * Measures how fast a driver downloads over a TCP socket, against the
+ * modem simulator in tools/Host, using the test files in extras/.
+ *
+ * The driver, TINY_GSM_RX_BUFFER and TINY_GSM_USE_HEX are fixed when the
+ * driver is built, so build once for each combination to compare, against
+ * a host Arduino core such as EpoxyDuino:
+ *
+ *   g++ -std=gnu++11 -O2 -DTINY_GSM_MODEM_SIM800 -DTINY_GSM_RX_BUFFER=512 \
+ *       -I<core> -I../../../src -I.. Throughput.cpp <core sources> \
+ *       -o tp_sim800_512
+ *   ./tp_sim800_512 > results.csv
+ *   ./tp_bg96_64 --header no >> results.csv
+ *
+ * (add -DTINY_GSM_USE_HEX for the hex reads of the SIMCom modems).  The
+ * baud rates and files are gone through on each run:
+ *
+ *   --baud <list>       serial speeds, default 115200,460800,921600
+ *   --files <list>      files in extras/, default test_1k.bin,test_10k.bin,
+ *                       test_100k.bin,test_1m.bin
+ *   --extras <dir>      where they are, default ../../../extras
+ *   --link <bps>        network speed into the modem, default 2000000
+ *   --latency <us>      modem's response latency, default 500
+ *   --repeat <n>        downloads of each file at each speed, default 3
+ *   --format csv|json   one CSV row (after a header) or JSON object per
+ *                       measurement, default csv
+ *   --header no         leaves out the CSV header, for appending
+ *
+ * Each measurement is the mean over the repeats:
+ *   bytes_per_s      payload bytes over the time from the request to the
+ *                    last byte read
+ *   cpu_ms_per_kb    user CPU time for the same, the simulator's share
+ *                    included; the harness sleeps while waiting on the
+ *                    serial port, but waking up for each character costs
+ *                    a little, so slow ports show a bit more
+ *   at_per_kb        AT commands sent for each KB received
+ *   read_p50_ns,     latency of the client.read() calls that returned
+ *   read_p99_ns      data, across all the repeats
+ *   ok               whether every download came back intact
+ *
+ * A 1 MB file takes a minute and a half at 115200 baud.
+ *
+ **************************************************************/
+
+#if !defined(TINY_GSM_RX_BUFFER)
+#define TINY_GSM_RX_BUFFER 64
+#endif
+
+#include <TinyGsmClient.h>
+#include <TinyGsmSimulator.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#if defined(TINY_GSM_MODEM_SIM800)
+#define MODEM_NAME "SIM800"
+#define MODEM_DIALECT SIM_SIM800
+#elif defined(TINY_GSM_MODEM_SIM808) || defined(TINY_GSM_MODEM_SIM868)
+#define MODEM_NAME "SIM808"
+#define MODEM_DIALECT SIM_SIM800
+#elif defined(TINY_GSM_MODEM_BG96)
+#define MODEM_NAME "BG96"
+#define MODEM_DIALECT SIM_BG96
+#elif defined(TINY_GSM_MODEM_SIM7070) || defined(TINY_GSM_MODEM_SIM7080) || \
+    defined(TINY_GSM_MODEM_SIM7090)
+#define MODEM_NAME "SIM7080"
+#define MODEM_DIALECT SIM_SIM7080
+#elif defined(TINY_GSM_MODEM_ESP8266)
+#define MODEM_NAME "ESP8266"
+#define MODEM_DIALECT SIM_ESP8266
+#else
+#error "The simulator doesn't speak this modem's dialect"
+#endif
+
+#if defined(TINY_GSM_USE_HEX)
+#define MODEM_HEX 1
+#else
+#define MODEM_HEX 0
+#endif
+
+struct Options {
+  std::vector<uint32_t>    bauds;
+  std::vector<std::string> files;
+  std::string              extras    = "../../../extras";
+  uint32_t                 link_bps  = 2000000;
+  uint32_t                 latency   = 500;
+  int                      repeat    = 3;
+  bool                     json      = false;
+  bool                     header    = true;
+};
+
+struct Download {
+  bool     ok;
+  size_t   bytes;
+  double   wall_ms;
+  double   cpu_ms;
+  uint32_t commands;
+};
+
+static double clockMs(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// User CPU time, leaving out the kernel's share of sleeping on the port
+static double userCpuMs() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec * 1000.0 + usage.ru_utime.tv_usec / 1000.0;
+}
+
+static double percentile(std::vector<double>& values, double p) {
+  if (values.empty()) { return 0; }
+  std::sort(values.begin(), values.end());
+  size_t i = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+  return values[i];
+}
+
+static std::vector<std::string> splitList(const char* in) {
+  std::vector<std::string> items;
+  std::string              item;
+  for (; *in; in++) {
+    if (*in == ',') {
+      if (!item.empty()) { items.push_back(item); }
+      item.clear();
+    } else {
+      item += *in;
+    }
+  }
+  if (!item.empty()) { items.push_back(item); }
+  return items;
+}
+
+static bool readFile(const std::string& path, std::string& out) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) { return false; }
+  char   chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    out.append(chunk, n);
+  }
+  fclose(file);
+  return true;
+}
+
+// Brings up a fresh modem and downloads one file, adding the latency of
+// every read() that returned data to read_ns
+static Download download(const Options& opts, uint32_t baud,
+                         const std::string& name, const std::string& expected,
+                         std::vector<double>& read_ns) {
+  Download result = {false, 0, 0, 0, 0};
+
+  TinyGsmSimulator sim(MODEM_DIALECT);
+  sim.config.baud       = baud;
+  sim.config.link_bps   = opts.link_bps;
+  sim.config.latency_us = opts.latency;
+  sim.serveData(name.c_str(), expected);
+  TinyGsmSimulatorWait wait(sim);
+  TinyGsm              modem(sim);
+  TinyGsmClient        client(modem);
+  modem.setWaitStrategy(&wait);
+
+  if (!modem.init()) { return result; }
+#if defined(TINY_GSM_MODEM_HAS_WIFI)
+  if (!modem.networkConnect("sim", "password")) { return result; }
+#else
+  if (!modem.gprsConnect("internet")) { return result; }
+#endif
+  if (!client.connect("example.com", 80)) { return result; }
+
+  std::string request  = "GET /" + name + " HTTP/1.0\r\n\r\n";
+  uint32_t    commands = sim.commandCount();
+  double      wall     = clockMs(CLOCK_MONOTONIC);
+  double      cpu      = userCpuMs();
+  client.write(reinterpret_cast<const uint8_t*>(request.data()),
+               request.size());
+
+  std::string received;
+  uint8_t     buf[512];
+  uint32_t    idle = millis();
+  while (received.size() < expected.size()) {
+    double start = clockMs(CLOCK_MONOTONIC);
+    int    n     = client.read(buf, sizeof(buf));
+    if (n > 0) {
+      read_ns.push_back((clockMs(CLOCK_MONOTONIC) - start) * 1000000.0);
+      received.append(reinterpret_cast<char*>(buf), n);
+      idle = millis();
+      continue;
+    }
+    if (!client.connected() && !client.available()) { break; }
+    // Data lost along the way never comes
+    if (millis() - idle > 5000) { break; }
+    // Nothing new until the modem says something
+    wait.waitAvailable(sim, 1, millis(), 2);
+  }
+
+  result.wall_ms  = clockMs(CLOCK_MONOTONIC) - wall;
+  result.cpu_ms   = userCpuMs() - cpu;
+  result.commands = sim.commandCount() - commands;
+  result.bytes    = received.size();
+  result.ok       = received == expected;
+  client.stop();
+  return result;
+}
+
+int main(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i < argc; i++) {
+    const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (!value) {
+      fprintf(stderr, "Missing value for %s\n", argv[i]);
+      return 2;
+    }
+    if (!strcmp(argv[i], "--baud")) {
+      std::vector<std::string> bauds = splitList(value);
+      for (size_t b = 0; b < bauds.size(); b++) {
+        opts.bauds.push_back(atol(bauds[b].c_str()));
+      }
+    } else if (!strcmp(argv[i], "--files")) {
+      opts.files = splitList(value);
+    } else if (!strcmp(argv[i], "--extras")) {
+      opts.extras = value;
+    } else if (!strcmp(argv[i], "--link")) {
+      opts.link_bps = atol(value);
+    } else if (!strcmp(argv[i], "--latency")) {
+      opts.latency = atol(value);
+    } else if (!strcmp(argv[i], "--repeat")) {
+      opts.repeat = TinyGsmMax(1, atoi(value));
+    } else if (!strcmp(argv[i], "--format")) {
+      opts.json = !strcmp(value, "json");
+    } else if (!strcmp(argv[i], "--header")) {
+      opts.header = strcmp(value, "no") != 0;
+    } else {
+      fprintf(stderr, "Unknown option %s\n", argv[i]);
+      return 2;
+    }
+    i++;
+  }
+  if (opts.bauds.empty()) {
+    opts.bauds.push_back(115200);
+    opts.bauds.push_back(460800);
+    opts.bauds.push_back(921600);
+  }
+  if (opts.files.empty()) {
+    opts.files = splitList("test_1k.bin,test_10k.bin,test_100k.bin,"
+                           "test_1m.bin");
+  }
+
+  if (!opts.json && opts.header) {
+    printf("modem,rx_buffer,hex,baud,file,bytes,ok,bytes_per_s,"
+           "cpu_ms_per_kb,at_per_kb,read_p50_ns,read_p99_ns\n");
+  }
+
+  bool all_ok = true;
+  for (size_t f = 0; f < opts.files.size(); f++) {
+    const std::string& name = opts.files[f];
+    std::string        expected;
+    if (!readFile(opts.extras + "/" + name, expected)) {
+      fprintf(stderr, "Can't read %s/%s\n", opts.extras.c_str(),
+              name.c_str());
+      return 1;
+    }
+    for (size_t b = 0; b < opts.bauds.size(); b++) {
+      std::vector<double> read_ns;
+      Download            total = {true, 0, 0, 0, 0};
+      for (int run = 0; run < opts.repeat; run++) {
+        Download one = download(opts, opts.bauds[b], name, expected, read_ns);
+        total.ok &= one.ok;
+        total.bytes += one.bytes;
+        total.wall_ms += one.wall_ms;
+        total.cpu_ms += one.cpu_ms;
+        total.commands += one.commands;
+      }
+      all_ok &= total.ok;
+      double kb          = total.bytes / 1024.0;
+      double bytes_per_s = total.wall_ms > 0
+                               ? total.bytes * 1000.0 / total.wall_ms
+                               : 0;
+      double cpu_per_kb  = kb > 0 ? total.cpu_ms / kb : 0;
+      double at_per_kb   = kb > 0 ? total.commands / kb : 0;
+      double p50         = percentile(read_ns, 0.50);
+      double p99         = percentile(read_ns, 0.99);
+      if (opts.json) {
+        printf("{\"modem\":\"%s\",\"rx_buffer\":%d,\"hex\":%d,"
+               "\"baud\":%u,\"file\":\"%s\",\"bytes\":%u,\"ok\":%s,"
+               "\"bytes_per_s\":%.0f,\"cpu_ms_per_kb\":%.4f,"
+               "\"at_per_kb\":%.3f,\"read_p50_ns\":%.0f,"
+               "\"read_p99_ns\":%.0f}\n",
+               MODEM_NAME, TINY_GSM_RX_BUFFER, MODEM_HEX,
+               opts.bauds[b], name.c_str(),
+               static_cast<unsigned>(total.bytes / opts.repeat),
+               total.ok ? "true" : "false", bytes_per_s, cpu_per_kb,
+               at_per_kb, p50, p99);
+      } else {
+        printf("%s,%d,%d,%u,%s,%u,%d,%.0f,%.4f,%.3f,%.0f,%.0f\n",
+               MODEM_NAME, TINY_GSM_RX_BUFFER, MODEM_HEX,
+               opts.bauds[b], name.c_str(),
+               static_cast<unsigned>(total.bytes / opts.repeat), total.ok,
+               bytes_per_s, cpu_per_kb, at_per_kb, p50, p99);
+      }
+      fflush(stdout);
+    }
+  }
+  // A download that went wrong fails the run, so scripts notice
+  return all_ok ? 0 : 1;
+}
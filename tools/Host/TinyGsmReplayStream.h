@@ -0,0 +1,420 @@
+/**
+ * @file       TinyGsmReplayStream.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef TOOLS_HOST_TINYGSMREPLAYSTREAM_H_
+#define TOOLS_HOST_TINYGSMREPLAYSTREAM_H_
+
+// Plays the modem's side of a captured session back to a driver on a host,
+// so its parsing can be timed against real byte patterns without hardware.
+// Host only; it needs a Linux (or other POSIX) Arduino core.
+
+#include <Arduino.h>
+#include <TinyGsmWait.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+struct TinyGsmTraceRecord {
+  bool        to_modem;
+  uint32_t    us;  // 0 when the capture has no times
+  std::string data;
+};
+
+// A captured session, read from any of:
+//
+//  - the binary trace from TinyGsmATTrace::writeTo() or saveTo()
+//  - the text trace from TinyGsmATTrace::printTo()
+//  - a raw log from tools/AT_Spy or DUMP_AT_COMMANDS (StreamDebugger)
+//
+// Raw logs have neither times nor directions.  Lines starting with "AT" are
+// taken to be commands and everything else the modem's, except a line
+// repeating the command before it, which is the modem's echo.  Data sent
+// after a '>' prompt ends up on the modem's side.
+class TinyGsmTrace {
+ public:
+  std::vector<TinyGsmTraceRecord> records;
+
+  bool load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) { return false; }
+    std::string content;
+    char        chunk[4096];
+    size_t      n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+      content.append(chunk, n);
+    }
+    fclose(file);
+    records.clear();
+    if (content.compare(0, 5, std::string("TGAT\x01", 5)) == 0) {
+      return parseBinary(content);
+    } else if (!content.empty() && content[0] == '[') {
+      return parseText(content);
+    }
+    return parseRaw(content);
+  }
+
+  size_t bytesFromModem() const {
+    size_t total = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+      if (!records[i].to_modem) { total += records[i].data.size(); }
+    }
+    return total;
+  }
+
+ protected:
+  bool parseBinary(const std::string& in) {
+    size_t i = 5;
+    while (i + 5 <= in.size()) {
+      uint8_t            header = in[i];
+      TinyGsmTraceRecord record;
+      record.to_modem = header & 0x80;
+      record.us       = 0;
+      for (uint8_t b = 0; b < 4; b++) {
+        record.us |= static_cast<uint32_t>(static_cast<uint8_t>(in[i + 1 + b]))
+                     << (8 * b);
+      }
+      size_t len = header & 0x7F;
+      if (i + 5 + len > in.size()) { return false; }
+      record.data = in.substr(i + 5, len);
+      append(record);
+      i += 5 + len;
+    }
+    return i == in.size();
+  }
+
+  // "[<us>] > data" or "[<us>] < data", one record per line
+  bool parseText(const std::string& in) {
+    size_t i = 0;
+    while (i < in.size()) {
+      size_t end = in.find('\n', i);
+      if (end == std::string::npos) { end = in.size(); }
+      std::string line = in.substr(i, end - i);
+      i                = end + 1;
+      if (!line.empty() && line[line.size() - 1] == '\r') {
+        line.erase(line.size() - 1);
+      }
+      size_t close = line.find("] ");
+      if (line.empty() || line[0] != '[' || close == std::string::npos ||
+          close + 3 > line.size()) {
+        continue;
+      }
+      TinyGsmTraceRecord record;
+      record.us       = strtoul(line.c_str() + 1, NULL, 10);
+      record.to_modem = line[close + 2] == '>';
+      record.data     = unescape(line.substr(close + 4));
+      append(record);
+    }
+    return !records.empty();
+  }
+
+  bool parseRaw(const std::string& in) {
+    std::string last_command;
+    size_t      i = 0;
+    while (i < in.size()) {
+      size_t end = in.find('\n', i);
+      end        = end == std::string::npos ? in.size() : end + 1;
+      TinyGsmTraceRecord record;
+      record.us   = 0;
+      record.data = in.substr(i, end - i);
+      i           = end;
+      bool command =
+          record.data.size() >= 2 && toupper(record.data[0]) == 'A' &&
+          toupper(record.data[1]) == 'T';
+      record.to_modem = command && record.data != last_command;
+      if (record.to_modem) {
+        last_command = record.data;
+      } else {
+        last_command.clear();
+      }
+      append(record);
+    }
+    return !records.empty();
+  }
+
+  // Joins records going the same way at the same time, as a trace splits
+  // them only because of its record length
+  void append(const TinyGsmTraceRecord& record) {
+    if (!records.empty()) {
+      TinyGsmTraceRecord& last = records.back();
+      if (last.to_modem == record.to_modem && last.us == record.us) {
+        last.data += record.data;
+        return;
+      }
+    }
+    records.push_back(record);
+  }
+
+  static std::string unescape(const std::string& in) {
+    std::string out;
+    for (size_t i = 0; i < in.size(); i++) {
+      if (in[i] != '\\' || i + 1 >= in.size()) {
+        out += in[i];
+        continue;
+      }
+      char c = in[++i];
+      if (c == 'r') {
+        out += '\r';
+      } else if (c == 'n') {
+        out += '\n';
+      } else if (c == 'x' && i + 2 < in.size()) {
+        out += static_cast<char>(strtoul(in.substr(i + 1, 2).c_str(), NULL,
+                                         16));
+        i += 2;
+      } else {
+        out += c;
+      }
+    }
+    return out;
+  }
+};
+
+enum TinyGsmReplaySpeed {
+  REPLAY_REALTIME,  // keep the gaps of the capture
+  REPLAY_MAX,       // hand everything over as soon as it is asked for
+  REPLAY_JITTER,    // the capture's gaps plus a random delay
+};
+
+// Feeds the modem's side of a trace to a driver.  Everything the driver
+// writes between two reads is one command, which is lined up with the
+// commands in the trace by its text:
+//
+//  - the next command of the trace is answered with what the modem sent
+//    after it in the capture
+//  - a command a little further on skips the trace ahead to it, dropping
+//    the replies to the commands the driver left out
+//  - a command the trace had earlier, like a repeated status poll, is
+//    answered as it was then, without moving on
+//  - anything else is taken to be the next command with other arguments
+//
+// Replies never come before their command, even at full speed, and
+// unsolicited lines come after the command they followed in the capture.
+// From there on the gaps of the capture are kept, depending on the speed.
+class TinyGsmReplayStream : public Stream {
+ public:
+  TinyGsmReplayStream(const TinyGsmTrace& trace, TinyGsmReplaySpeed speed,
+                      uint32_t jitter_us = 0)
+      : trace(trace),
+        speed(speed),
+        jitter_us(jitter_us) {
+    // Group the trace into commands and the replies after each; whatever
+    // came before the first command belongs to an empty one
+    commands.push_back(Command());
+    for (size_t i = 0; i < trace.records.size(); i++) {
+      const TinyGsmTraceRecord& record = trace.records[i];
+      if (record.to_modem) {
+        if (commands.back().replies_begin != i ||
+            commands.size() == 1) {
+          Command command;
+          command.replies_begin = i;
+          commands.push_back(command);
+        }
+        commands.back().text += record.data;
+        commands.back().us            = record.us;
+        commands.back().replies_begin = i + 1;
+      }
+      commands.back().replies_end = i + 1;
+    }
+    rewind();
+  }
+
+  void rewind() {
+    current      = 0;
+    next         = commands[0].replies_begin;
+    anchor_us    = micros();
+    anchor_trace = commands[0].us;
+    random_delay = 0;
+    in_turn      = false;
+    delivered    = 0;
+    written      = 0;
+    turns        = 0;
+    repeated     = 0;
+    pending.clear();
+    pending_pos = 0;
+    turn.clear();
+  }
+
+  int available() override {
+    release();
+    return pending.size() - pending_pos;
+  }
+  int read() override {
+    if (!available()) { return -1; }
+    delivered++;
+    return static_cast<uint8_t>(pending[pending_pos++]);
+  }
+  int peek() override {
+    if (!available()) { return -1; }
+    return static_cast<uint8_t>(pending[pending_pos]);
+  }
+  void flush() override {}
+
+  size_t write(uint8_t c) override {
+    in_turn = true;
+    turn += static_cast<char>(c);
+    written++;
+    return 1;
+  }
+  using Print::write;
+
+  // True once the driver has had everything the modem sent
+  bool finished() {
+    endTurn();
+    return current + 1 >= commands.size() && !nextDue(NULL) && !available();
+  }
+
+  // When the next reply is due, in host micros(); false if there is none
+  // until the driver sends another command
+  bool nextDue(uint32_t* due_us) {
+    while (next < commands[current].replies_end &&
+           trace.records[next].to_modem) {
+      next++;
+    }
+    if (next >= commands[current].replies_end) { return false; }
+    if (!due_us) { return true; }
+    const TinyGsmTraceRecord& record = trace.records[next];
+    uint32_t                  delay  = 0;
+    if (speed != REPLAY_MAX && record.us && anchor_trace &&
+        static_cast<int32_t>(record.us - anchor_trace) > 0) {
+      delay = record.us - anchor_trace;
+    }
+    *due_us = anchor_us + delay + random_delay;
+    return true;
+  }
+
+  uint32_t bytesDelivered() {
+    return delivered;
+  }
+  uint32_t bytesWritten() {
+    return written;
+  }
+  // Commands the driver sent, and how many of them were answered with an
+  // earlier reply
+  uint32_t commandsSent() {
+    return turns;
+  }
+  uint32_t commandsRepeated() {
+    return repeated;
+  }
+
+ protected:
+  struct Command {
+    std::string text;
+    uint32_t    us            = 0;
+    size_t      replies_begin = 0;
+    size_t      replies_end   = 0;
+  };
+
+  void release() {
+    endTurn();
+    if (pending_pos == pending.size()) {
+      pending.clear();
+      pending_pos = 0;
+    }
+    uint32_t due;
+    while (nextDue(&due) && static_cast<int32_t>(micros() - due) >= 0) {
+      pending += trace.records[next].data;
+      next++;
+      if (speed == REPLAY_JITTER && jitter_us) {
+        random_delay += rand() % (jitter_us + 1);
+      }
+    }
+  }
+
+  // Lines up the command the driver just finished writing with the trace
+  void endTurn() {
+    if (!in_turn) { return; }
+    in_turn = false;
+    turns++;
+    size_t lookahead = TinyGsmMin(current + 9, commands.size());
+    for (size_t i = current + 1; i < lookahead; i++) {
+      if (commands[i].text == turn) {
+        moveTo(i);
+        turn.clear();
+        return;
+      }
+    }
+    for (size_t i = current + 1; i-- > 1;) {
+      if (commands[i].text == turn) {
+        // Leave the trace where it is
+        for (size_t r = commands[i].replies_begin; r < commands[i].replies_end;
+             r++) {
+          if (!trace.records[r].to_modem) { pending += trace.records[r].data; }
+        }
+        repeated++;
+        turn.clear();
+        return;
+      }
+    }
+    if (current + 1 < commands.size()) { moveTo(current + 1); }
+    turn.clear();
+  }
+
+  void moveTo(size_t command) {
+    current      = command;
+    next         = commands[command].replies_begin;
+    anchor_us    = micros();
+    anchor_trace = commands[command].us;
+    random_delay = 0;
+  }
+
+  const TinyGsmTrace&  trace;
+  TinyGsmReplaySpeed   speed;
+  uint32_t             jitter_us;
+  std::vector<Command> commands;
+  size_t               current;
+  size_t               next;
+  uint32_t             anchor_us;
+  uint32_t             anchor_trace;
+  uint32_t             random_delay;
+  bool                 in_turn;
+  std::string          turn;
+  std::string          pending;
+  size_t               pending_pos;
+  uint32_t             delivered;
+  uint32_t             written;
+  uint32_t             turns;
+  uint32_t             repeated;
+};
+
+// Sleeps until the replay has the characters due instead of spinning, so
+// the CPU time measured is the driver's own
+class TinyGsmReplayWait : public TinyGsmWaitStrategy {
+ public:
+  explicit TinyGsmReplayWait(TinyGsmReplayStream& replay) : replay(replay) {}
+
+  bool waitAvailable(Stream& stream, int count, uint32_t startMillis,
+                     uint32_t timeout_ms) override {
+    while (stream.available() < count) {
+      uint32_t elapsed = millis() - startMillis;
+      if (elapsed >= timeout_ms) { return false; }
+      uint32_t sleep_us = (timeout_ms - elapsed) * 1000;
+      uint32_t due;
+      if (replay.nextDue(&due)) {
+        int32_t until = due - micros();
+        sleep_us      = until > 0 ? TinyGsmMin(sleep_us,
+                                          static_cast<uint32_t>(until))
+                                  : 0;
+      }
+      if (sleep_us) {
+        struct timespec ts;
+        ts.tv_sec  = sleep_us / 1000000;
+        ts.tv_nsec = (sleep_us % 1000000) * 1000;
+        nanosleep(&ts, NULL);
+      }
+    }
+    return true;
+  }
+
+ protected:
+  TinyGsmReplayStream& replay;
+};
+
+#endif  // TOOLS_HOST_TINYGSMREPLAYSTREAM_H_
@@ -0,0 +1,905 @@
+/**
+ * @file       TinyGsmSimulator.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Oct 2026
+ */
+
+#ifndef TOOLS_HOST_TINYGSMSIMULATOR_H_
+#define TOOLS_HOST_TINYGSMSIMULATOR_H_
+
+// A modem in software, for running drivers on a host without a radio.  It
+// speaks enough of the AT dialect of one modem family to bring up the data
+// connection and use TCP sockets, and behind each socket sits a server that
+// answers with a file or echoes what it is sent:
+//
+//   TinyGsmSimulator sim(SIM_SIM800);
+//   sim.config.baud     = 115200;
+//   sim.config.link_bps = 2000000;
+//   sim.serve("extras/test_1m.bin");
+//   TinyGsm       modem(sim);
+//   TinyGsmClient client(modem);
+//   modem.setWaitStrategy(new TinyGsmSimulatorWait(sim));
+//
+// Replies come back at the speed of the serial port after the configured
+// latency, and data reaches the modem's socket buffers at the speed of the
+// link, so every run of the same code sees the same bytes in the same
+// order.  Host only; it needs a Linux (or other POSIX) Arduino core.
+//
+// Dialects and what they cover:
+//   SIM_SIM800   +CIPSTART, +CIPSEND, +CIPRXGET (modes 1-4), +CIPSTATUS,
+//                +CIPCLOSE, +CDNSGIP and the GPRS bring-up commands
+//   SIM_BG96     +QIOPEN, +QISEND, +QIRD, +QISTATE, +QICLOSE, +QIDNSGIP and
+//                the "recv" and "closed" +QIURC's
+//   SIM_SIM7080  +CAOPEN, +CASEND, +CARECV, +CASTATE, +CACLOSE, +CNACT and
+//                +CADATAIND
+//   SIM_ESP8266  +CIPSTART, +CIPSEND, +CIPSTATUS, +CIPCLOSE, +CWJAP, with
+//                the data pushed in +IPD messages
+// Any other command gets OK; respond() overrides the answer to a command.
+
+#include <Arduino.h>
+#include <TinyGsmWait.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+enum TinyGsmSimDialect {
+  SIM_SIM800,
+  SIM_BG96,
+  SIM_SIM7080,
+  SIM_ESP8266,
+};
+
+struct TinyGsmSimConfig {
+  uint32_t baud        = 115200;   // serial port speed; 0 for no limit
+  uint32_t latency_us  = 500;      // from a command to the start of its reply
+  uint32_t command_us  = 0;        // added to every command as processing
+  uint32_t connect_us  = 100000;   // to open a socket
+  uint32_t rtt_us      = 50000;    // from a send to the server's answer
+  uint32_t link_bps    = 1000000;  // network speed into the modem; 0 no limit
+  uint16_t buffer_size = 8192;     // modem's receive buffer for each socket
+  uint16_t read_max    = 1460;     // most bytes a read (or +IPD) carries
+};
+
+#define TINY_GSM_SIM_SOCKETS 12
+
+class TinyGsmSimulator : public Stream {
+ public:
+  TinyGsmSimConfig config;
+
+  explicit TinyGsmSimulator(TinyGsmSimDialect dialect) : dialect(dialect) {
+    reset();
+  }
+
+  // Adds a file for the servers to send.  A request naming the file (by the
+  // part of its path after the last '/') gets it, any other request the
+  // first file.  Without files the servers echo.
+  bool serve(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) { return false; }
+    Payload payload;
+    char    chunk[4096];
+    size_t  n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+      payload.data.append(chunk, n);
+    }
+    fclose(file);
+    const char* name = strrchr(path, '/');
+    payload.name     = name ? name + 1 : path;
+    payloads.push_back(payload);
+    return true;
+  }
+  void serveData(const char* name, const std::string& data) {
+    Payload payload;
+    payload.name = name;
+    payload.data = data;
+    payloads.push_back(payload);
+  }
+  // Puts an HTTP/1.0 status line and Content-Length ahead of each file
+  void setHttp(bool enable) {
+    http = enable;
+  }
+  // Whether the server closes the socket once the file is sent (default)
+  void setCloseAfterPayload(bool enable) {
+    close_after = enable;
+  }
+
+  // Answers every command starting with command (after the "AT") with reply
+  // instead, exactly as given
+  void respond(const char* command, const char* reply) {
+    Override entry;
+    entry.command = command;
+    entry.reply   = reply;
+    overrides.push_back(entry);
+  }
+  // Sends text unprompted after delay_us, e.g. a burst of URC's
+  void inject(uint32_t delay_us, const char* text) {
+    schedule(micros() + delay_us, text);
+  }
+  // Has the server end of a socket close, as if the remote end went away
+  void closeRemote(uint8_t mux) {
+    if (mux < TINY_GSM_SIM_SOCKETS && sockets[mux].open) {
+      remoteClose(mux);
+    }
+  }
+
+  // Back to a modem just powered on, with the files kept
+  void reset() {
+    for (uint8_t i = 0; i < TINY_GSM_SIM_SOCKETS; i++) {
+      sockets[i] = Socket();
+    }
+    out.clear();
+    timed.clear();
+    line.clear();
+    data_left   = 0;
+    uart_free   = 0;
+    bearer_open = false;
+    pdp_active  = false;
+    reg_mode    = 0;
+    ip_state    = "IP INITIAL";
+    commands    = 0;
+    to_host     = 0;
+    from_host   = 0;
+  }
+
+  int available() override {
+    tick();
+    uint32_t now   = micros();
+    size_t   total = 0;
+    for (size_t i = 0; i < out.size(); i++) {
+      size_t ready = readyIn(out[i], now);
+      total += ready - out[i].pos;
+      if (ready < out[i].data.size()) { break; }
+    }
+    return total;
+  }
+  int read() override {
+    if (!available()) { return -1; }
+    Chunk&  chunk = out.front();
+    uint8_t c     = chunk.data[chunk.pos++];
+    if (chunk.pos == chunk.data.size()) { out.pop_front(); }
+    to_host++;
+    return c;
+  }
+  int peek() override {
+    if (!available()) { return -1; }
+    return static_cast<uint8_t>(out.front().data[out.front().pos]);
+  }
+  void flush() override {}
+
+  size_t write(uint8_t c) override {
+    tick();
+    from_host++;
+    if (data_left) {
+      data += static_cast<char>(c);
+      if (!--data_left) { dataReceived(); }
+      return 1;
+    }
+    if (c == '\r') {
+      if (line.size() >= 2 && toupper(line[0]) == 'A' &&
+          toupper(line[1]) == 'T') {
+        command(line.substr(2), line.size() + 1);
+      }
+      line.clear();
+    } else if (c != '\n') {
+      line += static_cast<char>(c);
+    }
+    return 1;
+  }
+  using Print::write;
+
+  // When the next character for the host is due, in host micros(); false if
+  // nothing is on its way yet
+  bool nextDue(uint32_t* due_us) {
+    tick();
+    if (!out.empty()) {
+      const Chunk& chunk = out.front();
+      *due_us = chunk.start + static_cast<uint32_t>(chunk.pos * byteNs() /
+                                                    1000);
+      return true;
+    }
+    if (!timed.empty()) {
+      *due_us = timed.front().start;
+      return true;
+    }
+    return false;
+  }
+
+  // Commands answered, and characters sent each way
+  uint32_t commandCount() {
+    return commands;
+  }
+  uint32_t bytesToHost() {
+    return to_host;
+  }
+  uint32_t bytesFromHost() {
+    return from_host;
+  }
+
+ protected:
+  struct Chunk {
+    uint32_t    start;  // when the first character is out
+    std::string data;
+    size_t      pos;
+  };
+  struct Payload {
+    std::string name;
+    std::string data;
+  };
+  struct Override {
+    std::string command;
+    std::string reply;
+  };
+  struct Socket {
+    bool               open          = false;
+    bool               remote_closed = false;
+    std::string        host;
+    uint16_t           port          = 0;
+    std::string        buffer;  // received, waiting to be read
+    bool               notified      = false;
+    uint32_t           received      = 0;
+    uint32_t           read          = 0;
+    // The server's answer: head, then body if there is one
+    bool               serving       = false;
+    std::string        head;
+    const std::string* body          = NULL;
+    size_t             pos           = 0;
+    uint32_t           fill_us       = 0;
+    double             credit        = 0;
+  };
+
+  /*
+   * Serial port
+   */
+  uint64_t byteNs() {
+    return config.baud ? 10000000000ULL / config.baud : 0;
+  }
+
+  size_t readyIn(const Chunk& chunk, uint32_t now) {
+    if (static_cast<int32_t>(now - chunk.start) < 0) { return 0; }
+    uint64_t ns = byteNs();
+    if (!ns) { return chunk.data.size(); }
+    uint64_t count = static_cast<uint64_t>(now - chunk.start) * 1000 / ns + 1;
+    return count < chunk.data.size() ? count : chunk.data.size();
+  }
+
+  // Queues text for the host, starting no earlier than start and after
+  // anything already queued
+  void emit(const std::string& text, uint32_t start) {
+    if (text.empty()) { return; }
+    // Anything timed to go out earlier goes first
+    while (!timed.empty() &&
+           static_cast<int32_t>(timed.front().start - start) <= 0) {
+      Chunk early = timed.front();
+      timed.pop_front();
+      emit(early.data, early.start);
+    }
+    // With nothing queued the port has long gone quiet
+    if (!out.empty() && static_cast<int32_t>(uart_free - start) > 0) {
+      start = uart_free;
+    }
+    Chunk chunk;
+    chunk.start = start;
+    chunk.data  = text;
+    chunk.pos   = 0;
+    out.push_back(chunk);
+    uart_free = start + static_cast<uint32_t>(text.size() * byteNs() / 1000);
+  }
+
+  void schedule(uint32_t start, const std::string& text) {
+    Chunk chunk;
+    chunk.start = start;
+    chunk.data  = text;
+    chunk.pos   = 0;
+    std::deque<Chunk>::iterator it = timed.begin();
+    while (it != timed.end() &&
+           static_cast<int32_t>(it->start - start) <= 0) {
+      it++;
+    }
+    timed.insert(it, chunk);
+  }
+
+  // Moves due timed text out and lets the servers send
+  void tick() {
+    uint32_t now = micros();
+    while (!timed.empty() &&
+           static_cast<int32_t>(now - timed.front().start) >= 0) {
+      Chunk due = timed.front();
+      timed.pop_front();
+      emit(due.data, due.start);
+    }
+    for (uint8_t mux = 0; mux < TINY_GSM_SIM_SOCKETS; mux++) {
+      if (sockets[mux].serving) { serveSome(mux, now); }
+    }
+  }
+
+  /*
+   * Servers
+   */
+  void dataReceived() {
+    Socket& sock = sockets[data_mux];
+    switch (dialect) {
+      case SIM_SIM800:
+        reply("\r\nDATA ACCEPT:" + num(data_mux) + "," + num(data.size()) +
+              "\r\n");
+        break;
+      case SIM_BG96: reply("\r\nSEND OK\r\n"); break;
+      case SIM_SIM7080: reply("\r\nOK\r\n"); break;
+      case SIM_ESP8266:
+        reply("\r\nRecv " + num(data.size()) + " bytes\r\n\r\nSEND OK\r\n");
+        break;
+    }
+    sendReply(data.size());
+    if (!sock.open || sock.remote_closed) { return; }
+    if (payloads.empty()) {
+      // Echo, after anything still being echoed
+      if (!sock.serving) {
+        sock.head.clear();
+        sock.pos = 0;
+        startServing(sock);
+      }
+      sock.head += data;
+      return;
+    }
+    if (sock.serving) { return; }
+    const Payload* payload = &payloads[0];
+    for (size_t i = 0; i < payloads.size(); i++) {
+      if (data.find(payloads[i].name) != std::string::npos) {
+        payload = &payloads[i];
+        break;
+      }
+    }
+    sock.head.clear();
+    if (http) {
+      sock.head = "HTTP/1.0 200 OK\r\nContent-Length: " +
+                  num(payload->data.size()) + "\r\n\r\n";
+    }
+    sock.body = &payload->data;
+    sock.pos  = 0;
+    startServing(sock);
+  }
+
+  void startServing(Socket& sock) {
+    sock.serving = true;
+    sock.fill_us = micros() + config.rtt_us;
+    sock.credit  = 0;
+  }
+
+  void serveSome(uint8_t mux, uint32_t now) {
+    Socket& sock = sockets[mux];
+    if (static_cast<int32_t>(now - sock.fill_us) < 0) { return; }
+    size_t total = sock.head.size() + (sock.body ? sock.body->size() : 0);
+    size_t room  = config.buffer_size > sock.buffer.size()
+                       ? config.buffer_size - sock.buffer.size()
+                       : 0;
+    size_t count = total - sock.pos;
+    if (config.link_bps) {
+      sock.credit += static_cast<double>(now - sock.fill_us) *
+                     config.link_bps / 8000000.0;
+      // A full buffer holds the sender back rather than saving up for later
+      if (sock.credit > config.buffer_size) {
+        sock.credit = config.buffer_size;
+      }
+      count = TinyGsmMin(count, static_cast<size_t>(sock.credit));
+    }
+    sock.fill_us = now;
+    count        = TinyGsmMin(count, room);
+    if (count) {
+      sock.credit -= count;
+      bool was_empty = sock.buffer.empty();
+      while (count--) {
+        sock.buffer += sock.pos < sock.head.size()
+                           ? sock.head[sock.pos]
+                           : (*sock.body)[sock.pos - sock.head.size()];
+        sock.pos++;
+        sock.received++;
+      }
+      dataArrived(mux, was_empty, sock.pos == total);
+    }
+    if (sock.pos < total) { return; }
+    sock.serving = false;
+    if (close_after && (sock.body || !payloads.empty())) {
+      remoteClose(mux);
+    }
+  }
+
+  // Tells the host about new data the way the modem would
+  void dataArrived(uint8_t mux, bool was_empty, bool last) {
+    Socket& sock = sockets[mux];
+    if (dialect == SIM_ESP8266) {
+      // Pushed out in packets of at most read_max
+      while (sock.buffer.size() >= config.read_max ||
+             (last && !sock.buffer.empty())) {
+        std::string part = sock.buffer.substr(0, config.read_max);
+        sock.buffer.erase(0, part.size());
+        sock.read += part.size();
+        emit("\r\n+IPD," + num(mux) + "," + num(part.size()) + ":" + part,
+             micros());
+      }
+      return;
+    }
+    if (!was_empty || sock.notified) { return; }
+    sock.notified = true;
+    switch (dialect) {
+      case SIM_SIM800:
+        emit("\r\n+CIPRXGET: 1," + num(mux) + "\r\n", micros());
+        break;
+      case SIM_BG96:
+        emit("\r\n+QIURC: \"recv\"," + num(mux) + "\r\n", micros());
+        break;
+      case SIM_SIM7080:
+        emit("\r\n+CADATAIND: " + num(mux) + "\r\n", micros());
+        break;
+      default: break;
+    }
+  }
+
+  void remoteClose(uint8_t mux) {
+    Socket& sock = sockets[mux];
+    if (sock.remote_closed) { return; }
+    sock.remote_closed = true;
+    sock.serving       = false;
+    switch (dialect) {
+      case SIM_SIM800:
+        emit("\r\n" + num(mux) + ", CLOSED\r\n", micros());
+        break;
+      case SIM_BG96:
+        emit("\r\n+QIURC: \"closed\"," + num(mux) + "\r\n", micros());
+        break;
+      case SIM_SIM7080:
+        emit("\r\n+CASTATE: " + num(mux) + ",0\r\n", micros());
+        break;
+      case SIM_ESP8266:
+        emit("\r\n" + num(mux) + ",CLOSED\r\n", micros());
+        sock.open = false;
+        break;
+    }
+  }
+
+  /*
+   * Commands
+   */
+  void command(const std::string& cmd, size_t length) {
+    commands++;
+    // The command has to come in over the serial port before it is handled
+    command_end = micros() + static_cast<uint32_t>(length * byteNs() / 1000);
+    pending.clear();
+    for (size_t i = 0; i < overrides.size(); i++) {
+      if (cmd.compare(0, overrides[i].command.size(), overrides[i].command) ==
+          0) {
+        reply(overrides[i].reply);
+        sendReply(0);
+        return;
+      }
+    }
+    size_t      eq   = cmd.find('=');
+    std::string name = cmd.substr(0, eq);
+    std::vector<std::string> args;
+    if (eq != std::string::npos) { args = splitArgs(cmd.substr(eq + 1)); }
+    bool handled = false;
+    switch (dialect) {
+      case SIM_SIM800: handled = sim800(name, args); break;
+      case SIM_BG96: handled = bg96(name, args); break;
+      case SIM_SIM7080: handled = sim7080(name, args); break;
+      case SIM_ESP8266: handled = esp8266(name, args); break;
+    }
+    if (!handled && !common(name, args)) { reply("\r\nOK\r\n"); }
+    sendReply(0);
+  }
+
+  void reply(const std::string& text) {
+    pending += text;
+  }
+  void sendReply(size_t extra_bytes) {
+    uint32_t start = command_end + config.latency_us + config.command_us +
+                     static_cast<uint32_t>(extra_bytes * byteNs() / 1000);
+    emit(pending, start);
+    pending.clear();
+  }
+  // Text that follows the reply after a delay, like a connect result
+  void later(uint32_t delay_us, const std::string& text) {
+    schedule(command_end + config.latency_us + config.command_us + delay_us,
+             text);
+  }
+  void prompt(const std::string& text, int mux, size_t len) {
+    reply(text);
+    data_mux  = mux;
+    data_left = len;
+    data.clear();
+  }
+
+  bool common(const std::string& name, const std::vector<std::string>& args) {
+    if (name == "+CPIN?") {
+      reply("\r\n+CPIN: READY\r\n\r\nOK\r\n");
+    } else if (name == "+CREG?" || name == "+CGREG?" || name == "+CEREG?") {
+      reply("\r\n" + name.substr(0, name.size() - 1) + ": " + num(reg_mode) +
+            ",1\r\n\r\nOK\r\n");
+    } else if ((name == "+CREG" || name == "+CGREG" || name == "+CEREG") &&
+               !args.empty()) {
+      reg_mode = atoi(args[0].c_str());
+      reply("\r\nOK\r\n");
+    } else if (name == "+CSQ") {
+      reply("\r\n+CSQ: 20,0\r\n\r\nOK\r\n");
+    } else if (name == "+CGATT?") {
+      reply("\r\n+CGATT: 1\r\n\r\nOK\r\n");
+    } else if (name == "+CGPADDR") {
+      reply("\r\n+CGPADDR: 1,\"10.0.0.2\"\r\n\r\nOK\r\n");
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  bool sim800(const std::string& name, const std::vector<std::string>& args) {
+    int mux = args.empty() ? -1 : atoi(args[0].c_str());
+    if (name == "+CIPSTART" && args.size() >= 4 && validMux(mux)) {
+      reply("\r\nOK\r\n");
+      openSocket(mux, args[2], atoi(args[3].c_str()));
+      ip_state = "IP PROCESSING";
+      later(config.connect_us, "\r\n" + num(mux) + ", CONNECT OK\r\n");
+    } else if (name == "+CIPSEND" && args.size() >= 2 && connected(mux)) {
+      prompt("\r\n> ", mux, atoi(args[1].c_str()));
+    } else if (name == "+CIPRXGET" && args.size() >= 2) {
+      int mode = mux;
+      mux      = atoi(args[1].c_str());
+      if (mode == 4) {
+        reply("\r\n+CIPRXGET: 4," + num(mux) + "," +
+              num(buffered(mux)) + "\r\n\r\nOK\r\n");
+      } else if ((mode == 2 || mode == 3) && args.size() >= 3) {
+        size_t      want = atoi(args[2].c_str());
+        // Hex takes two characters for each byte
+        size_t      most = mode == 3 ? config.read_max / 2 : config.read_max;
+        std::string part = take(mux, TinyGsmMin(want, most));
+        if (mode == 3) { part = hex(part); }
+        reply("\r\n+CIPRXGET: " + num(mode) + "," + num(mux) + "," +
+              num(mode == 3 ? part.size() / 2 : part.size()) + "," +
+              num(buffered(mux)) + "\r\n" + part + "\r\nOK\r\n");
+      } else {
+        reply("\r\nOK\r\n");
+      }
+    } else if (name == "+CIPCLOSE" && validMux(mux)) {
+      closeSocket(mux);
+      reply("\r\n" + num(mux) + ", CLOSE OK\r\n");
+    } else if (name == "+CIPSTATUS") {
+      reply("\r\nOK\r\n\r\nSTATE: " + ip_state + "\r\n");
+      for (int i = 0; i < 6; i++) {
+        Socket& sock = sockets[i];
+        if (sock.open) {
+          reply("\r\nC: " + num(i) + ",0,\"TCP\",\"" + sock.host + "\",\"" +
+                num(sock.port) + "\",\"" +
+                (sock.remote_closed ? "CLOSED" : "CONNECTED") + "\"\r\n");
+        } else {
+          reply("\r\nC: " + num(i) + ",,\"\",\"\",\"\",\"INITIAL\"\r\n");
+        }
+      }
+    } else if (name == "+CIPMUX?") {
+      reply("\r\n+CIPMUX: 1\r\n\r\nOK\r\n");
+    } else if (name == "+CSTT?") {
+      reply("\r\n+CSTT: \"" + apn + "\",\"" + apn_user + "\",\"" + apn_pwd +
+            "\"\r\n\r\nOK\r\n");
+    } else if (name == "+CSTT") {
+      apn      = args.empty() ? "" : args[0];
+      apn_user = args.size() > 1 ? args[1] : "";
+      apn_pwd  = args.size() > 2 ? args[2] : "";
+      ip_state = "IP START";
+      reply("\r\nOK\r\n");
+    } else if (name == "+CIICR") {
+      ip_state = "IP GPRSACT";
+      reply("\r\nOK\r\n");
+    } else if (name.compare(0, 6, "+CIFSR") == 0) {
+      if (ip_state == "IP GPRSACT") { ip_state = "IP STATUS"; }
+      reply("\r\n10.0.0.2\r\n\r\nOK\r\n");
+    } else if (name == "+CIPSHUT") {
+      for (int i = 0; i < TINY_GSM_SIM_SOCKETS; i++) { closeSocket(i); }
+      ip_state = "IP INITIAL";
+      reply("\r\nSHUT OK\r\n");
+    } else if (name == "+SAPBR" && args.size() >= 2) {
+      int op = atoi(args[0].c_str());
+      if (op == 1) { bearer_open = true; }
+      if (op == 0) { bearer_open = false; }
+      if (op == 2) {
+        reply(std::string("\r\n+SAPBR: 1,") + (bearer_open ? "1" : "3") +
+              ",\"10.0.0.2\"\r\n");
+      }
+      reply("\r\nOK\r\n");
+    } else if (name == "+CDNSGIP" && !args.empty()) {
+      reply("\r\nOK\r\n");
+      later(config.rtt_us,
+            "\r\n+CDNSGIP: 1,\"" + args[0] + "\",\"203.0.113.10\"\r\n");
+    } else if (name == "+CIPSSL=?") {
+      reply("\r\n+CIPSSL: (0,1)\r\n\r\nOK\r\n");
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  bool bg96(const std::string& name, const std::vector<std::string>& args) {
+    int mux = args.size() > 1 ? atoi(args[1].c_str()) : -1;
+    if (name == "+QIOPEN" && args.size() >= 5 && validMux(mux)) {
+      reply("\r\nOK\r\n");
+      openSocket(mux, args[3], atoi(args[4].c_str()));
+      later(config.connect_us, "\r\n+QIOPEN: " + num(mux) + ",0\r\n");
+    } else if (name == "+QISEND" && args.size() >= 2) {
+      mux = atoi(args[0].c_str());
+      if (!connected(mux)) {
+        reply("\r\nERROR\r\n");
+        return true;
+      }
+      prompt("\r\n> ", mux, atoi(args[1].c_str()));
+    } else if (name == "+QIRD" && args.size() >= 2) {
+      mux         = atoi(args[0].c_str());
+      size_t want = atoi(args[1].c_str());
+      if (!want) {
+        Socket& sock = sockets[mux];
+        reply("\r\n+QIRD: " + num(sock.received) + "," + num(sock.read) +
+              "," + num(buffered(mux)) + "\r\n\r\nOK\r\n");
+      } else {
+        std::string part =
+            take(mux, TinyGsmMin(want, static_cast<size_t>(config.read_max)));
+        reply("\r\n+QIRD: " + num(part.size()) + "\r\n" + part +
+              "\r\n\r\nOK\r\n");
+      }
+    } else if (name == "+QISTATE") {
+      for (int i = 0; i < TINY_GSM_SIM_SOCKETS; i++) {
+        Socket& sock = sockets[i];
+        if (!sock.open) { continue; }
+        reply("\r\n+QISTATE: " + num(i) + ",\"TCP\",\"" + sock.host + "\"," +
+              num(sock.port) + ",5000," + (sock.remote_closed ? "4" : "2") +
+              ",1," + num(i) + ",0,\"uart1\"\r\n");
+      }
+      reply("\r\nOK\r\n");
+    } else if (name == "+QICLOSE") {
+      closeSocket(atoi(args.empty() ? "-1" : args[0].c_str()));
+      reply("\r\nOK\r\n");
+    } else if (name == "+QIACT") {
+      pdp_active = true;
+      reply("\r\nOK\r\n");
+    } else if (name == "+QIDEACT") {
+      for (int i = 0; i < TINY_GSM_SIM_SOCKETS; i++) { closeSocket(i); }
+      pdp_active = false;
+      reply("\r\nOK\r\n");
+    } else if (name == "+QIACT?") {
+      if (pdp_active) { reply("\r\n+QIACT: 1,1,1,\"10.0.0.2\"\r\n"); }
+      reply("\r\nOK\r\n");
+    } else if (name == "+QIDNSGIP" && args.size() >= 2) {
+      reply("\r\nOK\r\n");
+      later(config.rtt_us, "\r\n+QIURC: \"dnsgip\",0,1,600\r\n"
+                           "\r\n+QIURC: \"dnsgip\",\"203.0.113.10\"\r\n");
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  bool sim7080(const std::string& name, const std::vector<std::string>& args) {
+    int mux = args.empty() ? -1 : atoi(args[0].c_str());
+    if (name == "+CAOPEN" && args.size() >= 5 && validMux(mux)) {
+      openSocket(mux, args[3], atoi(args[4].c_str()));
+      later(config.connect_us,
+            "\r\n+CAOPEN: " + num(mux) + ",0\r\n\r\nOK\r\n");
+    } else if (name == "+CASEND" && args.size() >= 2) {
+      if (!connected(mux)) {
+        reply("\r\nERROR\r\n");
+        return true;
+      }
+      prompt("\r\n> ", mux, atoi(args[1].c_str()));
+    } else if (name == "+CARECV" && args.size() >= 2) {
+      size_t      want = atoi(args[1].c_str());
+      std::string part =
+          take(mux, TinyGsmMin(want, static_cast<size_t>(config.read_max)));
+      reply("\r\n+CARECV: " + num(part.size()) + "," + part +
+            "\r\n\r\nOK\r\n");
+    } else if (name == "+CARECV?") {
+      for (int i = 0; i < TINY_GSM_SIM_SOCKETS; i++) {
+        if (sockets[i].open && buffered(i)) {
+          reply("\r\n+CARECV: " + num(i) + "," + num(buffered(i)) + "\r\n");
+        }
+      }
+      reply("\r\nOK\r\n");
+    } else if (name == "+CASTATE?") {
+      for (int i = 0; i < TINY_GSM_SIM_SOCKETS; i++) {
+        if (!sockets[i].open) { continue; }
+        reply("\r\n+CASTATE: " + num(i) + "," +
+              (sockets[i].remote_closed ? "0" : "1") + "\r\n");
+      }
+      reply("\r\nOK\r\n");
+    } else if (name == "+CACLOSE") {
+      closeSocket(mux);
+      reply("\r\nOK\r\n");
+    } else if (name == "+CNACT" && args.size() >= 2) {
+      pdp_active = atoi(args[1].c_str()) != 0;
+      reply("\r\nOK\r\n");
+      if (pdp_active) { later(0, "\r\n+APP PDP: 0,ACTIVE\r\n"); }
+    } else if (name == "+CNACT?") {
+      reply(std::string("\r\n+CNACT: 0,") + (pdp_active ? "1" : "0") +
+            ",\"10.0.0.2\"\r\n\r\nOK\r\n");
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  bool esp8266(const std::string& name, const std::vector<std::string>& args) {
+    int mux = args.empty() ? -1 : atoi(args[0].c_str());
+    if (name == "+CIPSTART" && args.size() >= 4 && validMux(mux)) {
+      openSocket(mux, args[2], atoi(args[3].c_str()));
+      later(config.connect_us,
+            "\r\n" + num(mux) + ",CONNECT\r\n\r\nOK\r\n");
+    } else if (name == "+CIPSEND" && args.size() >= 2) {
+      if (!connected(mux)) {
+        reply("\r\nlink is not valid\r\n\r\nERROR\r\n");
+        return true;
+      }
+      prompt("\r\nOK\r\n> ", mux, atoi(args[1].c_str()));
+    } else if (name == "+CIPSTATUS") {
+      bool any = false;
+      for (int i = 0; i < 5; i++) { any |= sockets[i].open; }
+      reply(std::string("\r\nSTATUS:") +
+            (!pdp_active ? "5" : any ? "3" : "2") + "\r\n");
+      for (int i = 0; i < 5; i++) {
+        Socket& sock = sockets[i];
+        if (!sock.open) { continue; }
+        reply("+CIPSTATUS:" + num(i) + ",\"TCP\",\"" + sock.host + "\"," +
+              num(sock.port) + ",5000,0\r\n");
+      }
+      reply("\r\nOK\r\n");
+    } else if (name == "+CIPCLOSE") {
+      closeSocket(mux);
+      reply("\r\n" + num(mux) + ",CLOSED\r\n\r\nOK\r\n");
+    } else if (name == "+CWJAP" || name == "+CWJAP_CUR") {
+      pdp_active = true;
+      reply("\r\nWIFI CONNECTED\r\nWIFI GOT IP\r\n\r\nOK\r\n");
+    } else if (name == "+CWJAP?") {
+      reply(pdp_active ? "\r\n+CWJAP:\"sim\",\"02:00:00:00:00:01\",6,-60"
+                         "\r\n\r\nOK\r\n"
+                       : "\r\nNo AP\r\n\r\nOK\r\n");
+    } else if (name == "+CIPSTA?") {
+      reply("\r\n+CIPSTA:ip:\"10.0.0.2\"\r\n\r\nOK\r\n");
+    } else if (name == "+CWQAP") {
+      pdp_active = false;
+      reply("\r\nOK\r\nWIFI DISCONNECT\r\n");
+    } else if (name == "+RST") {
+      reset();
+      reply("\r\nOK\r\n");
+      later(config.connect_us, "\r\nready\r\n");
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  /*
+   * Sockets
+   */
+  bool validMux(int mux) {
+    return mux >= 0 && mux < TINY_GSM_SIM_SOCKETS;
+  }
+  bool connected(int mux) {
+    return validMux(mux) && sockets[mux].open && !sockets[mux].remote_closed;
+  }
+  size_t buffered(int mux) {
+    return validMux(mux) ? sockets[mux].buffer.size() : 0;
+  }
+
+  void openSocket(int mux, const std::string& host, uint16_t port) {
+    Socket& sock = sockets[mux];
+    sock         = Socket();
+    sock.open    = true;
+    sock.host    = host;
+    sock.port    = port;
+  }
+  void closeSocket(int mux) {
+    if (validMux(mux)) { sockets[mux] = Socket(); }
+  }
+
+  // Takes up to size bytes out of a socket's buffer, as a read command does
+  std::string take(int mux, size_t size) {
+    if (!validMux(mux)) { return ""; }
+    Socket&     sock = sockets[mux];
+    std::string part = sock.buffer.substr(0, size);
+    sock.buffer.erase(0, part.size());
+    sock.read += part.size();
+    if (sock.buffer.empty()) { sock.notified = false; }
+    return part;
+  }
+
+  static std::string num(size_t value) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%u", static_cast<unsigned>(value));
+    return buf;
+  }
+  static std::string hex(const std::string& in) {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string       out;
+    for (size_t i = 0; i < in.size(); i++) {
+      out += digits[static_cast<uint8_t>(in[i]) >> 4];
+      out += digits[static_cast<uint8_t>(in[i]) & 0x0F];
+    }
+    return out;
+  }
+  // Splits command arguments at the commas outside quotes, without the quotes
+  static std::vector<std::string> splitArgs(const std::string& in) {
+    std::vector<std::string> args(1);
+    bool                     quoted = false;
+    for (size_t i = 0; i < in.size(); i++) {
+      if (in[i] == '"') {
+        quoted = !quoted;
+      } else if (in[i] == ',' && !quoted) {
+        args.push_back("");
+      } else {
+        args.back() += in[i];
+      }
+    }
+    return args;
+  }
+
+  TinyGsmSimDialect     dialect;
+  std::vector<Payload>  payloads;
+  std::vector<Override> overrides;
+  bool                  http        = false;
+  bool                  close_after = true;
+  Socket                sockets[TINY_GSM_SIM_SOCKETS];
+  std::deque<Chunk>     out;
+  std::deque<Chunk>     timed;
+  uint32_t              uart_free;
+  std::string           line;
+  std::string           pending;
+  uint32_t              command_end = 0;
+  int                   data_mux    = 0;
+  size_t                data_left;
+  std::string           data;
+  bool                  bearer_open;
+  bool                  pdp_active;
+  int                   reg_mode;  // the last +CxREG=<n>, shared by all three
+  std::string           ip_state;
+  std::string           apn;
+  std::string           apn_user;
+  std::string           apn_pwd;
+  uint32_t              commands;
+  uint32_t              to_host;
+  uint32_t              from_host;
+};
+
+// Sleeps until the simulator has the characters due instead of spinning
+class TinyGsmSimulatorWait : public TinyGsmWaitStrategy {
+ public:
+  explicit TinyGsmSimulatorWait(TinyGsmSimulator& sim) : sim(sim) {}
+
+  bool waitAvailable(Stream& stream, int count, uint32_t startMillis,
+                     uint32_t timeout_ms) override {
+    while (stream.available() < count) {
+      uint32_t elapsed = millis() - startMillis;
+      if (elapsed >= timeout_ms) { return false; }
+      // Servers fill the buffers as time goes by, so never sleep long
+      uint32_t sleep_us = TinyGsmMin((timeout_ms - elapsed) * 1000,
+                                     static_cast<uint32_t>(1000));
+      uint32_t due;
+      if (sim.nextDue(&due)) {
+        int32_t until = due - micros();
+        if (until <= 0) {
+          sleep_us = 0;
+        } else if (static_cast<uint32_t>(until) < sleep_us) {
+          sleep_us = until;
+        }
+      }
+      if (sleep_us) {
+        struct timespec ts;
+        ts.tv_sec  = 0;
+        ts.tv_nsec = sleep_us * 1000;
+        nanosleep(&ts, NULL);
+      }
+    }
+    return true;
+  }
+
+ protected:
+  TinyGsmSimulator& sim;
+};
+
+#endif  // TOOLS_HOST_TINYGSMSIMULATOR_H_
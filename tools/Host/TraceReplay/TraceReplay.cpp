@@ -0,0 +1,278 @@
+/**************************************************************
+ *
+ * Replays a captured modem session into a driver on a Linux host and
+ * times how the driver handles it, without any hardware.
+ *
+ * Capture the session with TINY_GSM_AT_TRACE (getATTrace().saveTo(),
+ * writeTo() or printTo()), tools/AT_Spy or DUMP_AT_COMMANDS.  Then build
+ * this for the modem it came from, against a host Arduino core such as
+ * EpoxyDuino:
+ *
+ *   g++ -std=gnu++11 -O2 -DTINY_GSM_MODEM_SIM800 -DTINY_GSM_AT_STATS \
+ *       -I<core> -I../../../src -I.. TraceReplay.cpp <core sources>
+ *
+ * and run it with the steps the application took:
+ *
+ *   ./a.out capture.bin --speed max init gprs:internet \
+ *       connect:example.com:80 "send:GET / HTTP/1.0\r\n\r\n" read stop
+ *
+ * Steps:
+ *   init                 modem.init()
+ *   test                 modem.testAT()
+ *   network              modem.waitForNetwork()
+ *   gprs:<apn>           modem.gprsConnect(apn)
+ *   wifi:<ssid>:<pass>   modem.networkConnect(ssid, pass)
+ *   connect:<host>:<p>   client.connect(host, port)
+ *   send:<text>          client.print(text), with \r and \n escapes
+ *   read[:<bytes>]       client.read() until done or that many bytes
+ *   maintain:<ms>        modem.maintain() for that long, e.g. for URCs
+ *   stop                 client.stop()
+ *
+ * Options:
+ *   --speed realtime     keep the gaps of the capture (default)
+ *   --speed max          no gaps at all
+ *   --speed jitter:<us>  the gaps plus up to that much more per record
+ *   --repeat <n>         run the steps n times and add up the results
+ *
+ * Each step reports its result, the wall and CPU time it took and the
+ * bytes it consumed.  The harness sleeps while waiting on the replay, so
+ * CPU time is the driver's own parsing.  At the end come the read()
+ * latency percentiles and, when built with TINY_GSM_AT_STATS, the time
+ * each AT command took to be answered.
+ *
+ **************************************************************/
+
+#include <TinyGsmClient.h>
+#include <TinyGsmReplayStream.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+class StdoutPrint : public Print {
+ public:
+  size_t write(uint8_t c) override {
+    return fputc(c, stdout) == EOF ? 0 : 1;
+  }
+  using Print::write;
+};
+
+struct StepTotal {
+  std::string name;
+  uint32_t    runs;
+  uint32_t    ok;
+  double      wall_ms;
+  double      cpu_ms;
+  uint32_t    bytes;
+};
+
+static double clockMs(clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static std::string unescapeArg(const char* in) {
+  std::string out;
+  for (; *in; in++) {
+    if (*in == '\\' && in[1] == 'r') {
+      out += '\r';
+      in++;
+    } else if (*in == '\\' && in[1] == 'n') {
+      out += '\n';
+      in++;
+    } else {
+      out += *in;
+    }
+  }
+  return out;
+}
+
+// Splits a step at its colons, but leaves the text to send whole
+static std::vector<std::string> splitArg(const std::string& arg) {
+  std::vector<std::string> parts;
+  size_t                   start = 0;
+  size_t                   colon;
+  while ((parts.empty() || parts[0] != "send") &&
+         (colon = arg.find(':', start)) != std::string::npos) {
+    parts.push_back(arg.substr(start, colon - start));
+    start = colon + 1;
+  }
+  parts.push_back(arg.substr(start));
+  return parts;
+}
+
+// Runs one step, giving its result and adding the latency of every read()
+// that returned data to read_ns
+static bool runStep(const std::vector<std::string>& step, TinyGsm& modem,
+                    TinyGsmClient& client, TinyGsmReplayStream& replay,
+                    std::vector<double>& read_ns) {
+  const std::string& name = step[0];
+  if (name == "init") { return modem.init(); }
+  if (name == "test") { return modem.testAT(); }
+  if (name == "network") { return modem.waitForNetwork(); }
+#if defined(TINY_GSM_MODEM_HAS_GPRS)
+  if (name == "gprs" && step.size() > 1) {
+    return modem.gprsConnect(step[1].c_str());
+  }
+#endif
+#if defined(TINY_GSM_MODEM_HAS_WIFI)
+  if (name == "wifi" && step.size() > 2) {
+    return modem.networkConnect(step[1].c_str(), step[2].c_str());
+  }
+#endif
+  if (name == "connect" && step.size() > 2) {
+    return client.connect(step[1].c_str(), atoi(step[2].c_str()));
+  }
+  if (name == "send" && step.size() > 1) {
+    std::string text = unescapeArg(step[1].c_str());
+    return client.write(reinterpret_cast<const uint8_t*>(text.data()),
+                        text.size()) == text.size();
+  }
+  if (name == "read") {
+    size_t   want = step.size() > 1 ? atol(step[1].c_str()) : 0;
+    size_t   got  = 0;
+    uint8_t  buf[512];
+    uint32_t idle = millis();
+    // Reads until the count is reached, or the replay has nothing left and
+    // the socket has been quiet for a second
+    while (!want || got < want) {
+      double start = clockMs(CLOCK_MONOTONIC);
+      int    n     = client.read(buf, sizeof(buf));
+      if (n > 0) {
+        read_ns.push_back((clockMs(CLOCK_MONOTONIC) - start) * 1000000.0);
+        got += n;
+        idle = millis();
+        continue;
+      }
+      if (!client.connected() && !client.available()) { break; }
+      if (replay.finished() && millis() - idle > 1000) { break; }
+      client.available();
+    }
+    return got > 0;
+  }
+  if (name == "maintain" && step.size() > 1) {
+    uint32_t start = millis();
+    while (millis() - start < static_cast<uint32_t>(atol(step[1].c_str()))) {
+      modem.maintain();
+    }
+    return true;
+  }
+  if (name == "stop") {
+    client.stop();
+    return true;
+  }
+  fprintf(stderr, "Unknown step %s\n", name.c_str());
+  exit(2);
+}
+
+static double percentile(std::vector<double>& values, double p) {
+  if (values.empty()) { return 0; }
+  std::sort(values.begin(), values.end());
+  size_t i = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+  return values[i];
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    fprintf(stderr,
+            "Usage: %s <capture> [--speed realtime|max|jitter:<us>] "
+            "[--repeat <n>] <step>...\n",
+            argv[0]);
+    return 2;
+  }
+
+  TinyGsmTrace trace;
+  if (!trace.load(argv[1])) {
+    fprintf(stderr, "Can't read %s\n", argv[1]);
+    return 1;
+  }
+
+  TinyGsmReplaySpeed                    speed     = REPLAY_REALTIME;
+  uint32_t                              jitter_us = 0;
+  int                                   repeat    = 1;
+  std::vector<std::vector<std::string> > steps;
+  for (int i = 2; i < argc; i++) {
+    if (!strcmp(argv[i], "--speed") && i + 1 < argc) {
+      std::string value = argv[++i];
+      if (value == "max") {
+        speed = REPLAY_MAX;
+      } else if (value.compare(0, 7, "jitter:") == 0) {
+        speed     = REPLAY_JITTER;
+        jitter_us = atol(value.c_str() + 7);
+      }
+    } else if (!strcmp(argv[i], "--repeat") && i + 1 < argc) {
+      repeat = TinyGsmMax(1, atoi(argv[++i]));
+    } else {
+      steps.push_back(splitArg(argv[i]));
+    }
+  }
+
+  printf("capture %s: %u records, %u bytes from the modem\n", argv[1],
+         static_cast<unsigned>(trace.records.size()),
+         static_cast<unsigned>(trace.bytesFromModem()));
+
+  TinyGsmReplayStream    replay(trace, speed, jitter_us);
+  TinyGsmReplayWait      wait(replay);
+  std::vector<StepTotal> totals(steps.size());
+  std::vector<double>    read_ns;
+  double                 total_cpu = 0;
+  uint32_t               delivered = 0;
+  uint32_t               sent      = 0;
+  uint32_t               repeated  = 0;
+
+  for (int run = 0; run < repeat; run++) {
+    replay.rewind();
+    // A fresh modem each run, so no state carries over
+    TinyGsm       modem(replay);
+    TinyGsmClient client(modem);
+    modem.setWaitStrategy(&wait);
+    for (size_t s = 0; s < steps.size(); s++) {
+      uint32_t before = replay.bytesDelivered();
+      double   wall   = clockMs(CLOCK_MONOTONIC);
+      double   cpu    = clockMs(CLOCK_PROCESS_CPUTIME_ID);
+      bool     ok     = runStep(steps[s], modem, client, replay, read_ns);
+      StepTotal& total = totals[s];
+      total.name       = steps[s][0];
+      total.runs++;
+      total.ok += ok;
+      total.wall_ms += clockMs(CLOCK_MONOTONIC) - wall;
+      total.cpu_ms += clockMs(CLOCK_PROCESS_CPUTIME_ID) - cpu;
+      total.bytes += replay.bytesDelivered() - before;
+    }
+    delivered += replay.bytesDelivered();
+    sent += replay.commandsSent();
+    repeated += replay.commandsRepeated();
+#if defined(TINY_GSM_AT_STATS)
+    if (run == repeat - 1) {
+      StdoutPrint out;
+      printf("\nAT commands (last run):\n");
+      modem.getATStats().printTo(out);
+    }
+#endif
+  }
+
+  printf("\n%-10s %5s %5s %10s %10s %10s\n", "step", "runs", "ok", "wall_ms",
+         "cpu_ms", "bytes");
+  for (size_t s = 0; s < totals.size(); s++) {
+    StepTotal& total = totals[s];
+    printf("%-10s %5u %5u %10.3f %10.3f %10u\n", total.name.c_str(),
+           total.runs, total.ok, total.wall_ms / total.runs,
+           total.cpu_ms / total.runs, total.bytes / total.runs);
+    total_cpu += total.cpu_ms;
+  }
+  printf("\nparsed %u bytes in %.3f ms of CPU (%.1f ns per byte)\n",
+         delivered, total_cpu,
+         delivered ? total_cpu * 1000000.0 / delivered : 0.0);
+  printf("%u commands sent, %u answered with an earlier reply\n", sent,
+         repeated);
+  printf("read() calls returning data: %u, p50 %.0f ns, p99 %.0f ns\n",
+         static_cast<unsigned>(read_ns.size()), percentile(read_ns, 0.50),
+         percentile(read_ns, 0.99));
+  return 0;
+}
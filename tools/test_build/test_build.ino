@@ -5,6 +5,7 @@
  *
  **************************************************************/
 #include <TinyGsmClient.h>
+#include <TinyGsmPool.h>
 
 TinyGsm modem(Serial);
 
@@ -20,10 +21,34 @@ void loop() {
   modem.init();
   modem.init("1234");
   modem.setBaud(115200);
+  modem.setWaitStrategy(NULL);
   modem.testAT();
+  modem.sendATAsync("+CSQ");
+  modem.commandsPending();
+#if defined(TINY_GSM_AT_STATS)
+  modem.getATStats().enabled = true;
+  modem.getATStats().printTo(Serial);
+  modem.getATStats().clear();
+#endif
+#if defined(TINY_GSM_AT_TRACE)
+  modem.getATTrace().enabled = true;
+  modem.getATTrace().printTo(Serial);
+  modem.getATTrace().writeTo(Serial);
+  modem.getATTrace().clear();
+#endif
+#if defined(TINY_GSM_ALLOC_STATS)
+  modem.getAllocStats().enabled = true;
+  modem.getAllocStats().printTo(Serial);
+  modem.getAllocStats().clear();
+#endif
 
+#if !defined(TINY_GSM_NO_HEAP)
   modem.getModemInfo();
   modem.getModemName();
+#endif
+  char text[64];
+  modem.getModemInfo(text, sizeof(text));
+  modem.getModemName(text, sizeof(text));
   modem.factoryDefault();
 
   // Test Power functions
@@ -34,27 +59,48 @@ void loop() {
 
   // Test generic network functions
   modem.getRegistrationStatus();
+  modem.enableRegistrationURC();
+  modem.getLocationAreaCode();
+  modem.getCellId();
+  modem.getAccessTechnology();
   modem.isNetworkConnected();
   modem.waitForNetwork();
   modem.waitForNetwork(15000L);
   modem.waitForNetwork(15000L, true);
   modem.getSignalQuality();
+#if !defined(TINY_GSM_NO_HEAP)
   modem.getLocalIP();
+#endif
+  modem.getLocalIP(text, sizeof(text));
   modem.localIP();
 
 // Test the GPRS and SIM card functions
 #if defined(TINY_GSM_MODEM_HAS_GPRS)
   modem.simUnlock("1234");
+#if !defined(TINY_GSM_NO_HEAP)
   modem.getSimCCID();
   modem.getIMEI();
   modem.getIMSI();
+#endif
+  modem.getSimCCID(text, sizeof(text));
+  modem.getIMEI(text, sizeof(text));
+  modem.getIMSI(text, sizeof(text));
   modem.getSimStatus();
 
   modem.gprsConnect("myAPN");
   modem.gprsConnect("myAPN", "myUser");
   modem.gprsConnect("myAPN", "myAPNUser", "myAPNPass");
+  modem.gprsConnectAsync("myAPN", "myAPNUser", "myAPNPass");
+  while (!modem.gprsConnectStatus()) { modem.maintain(); }
   modem.gprsDisconnect();
+#if !defined(TINY_GSM_NO_HEAP)
   modem.getOperator();
+#endif
+  modem.getOperator(text, sizeof(text));
+#if defined(TINY_GSM_MODEM_SIM800) || defined(TINY_GSM_MODEM_SIM808)
+  modem.gprsResume("myAPN", "myAPNUser", "myAPNPass");
+  modem.getGprsStepTime(TinyGsm::GPRS_STEP_CIICR);
+#endif
 #endif
 
 // Test WiFi Functions
@@ -65,6 +111,7 @@ void loop() {
 
   // Test TCP functions
   modem.maintain();
+  modem.maintain(1000);
   TinyGsmClient client;
   TinyGsmClient client2(modem);
   TinyGsmClient client3(modem, 1);
@@ -75,6 +122,10 @@ void loop() {
   char resource[] = "something";
 
   client.connect(server, 80);
+  client.connectAsync(server, 80);
+  client.connecting();
+  client.setAutoReconnect(server, 80);
+  client.stopAutoReconnect();
 
   // Make a HTTP GET request:
   client.print(String("GET ") + resource + " HTTP/1.0\r\n");
@@ -89,8 +140,57 @@ void loop() {
     }
   }
 
+#if defined(TINY_GSM_SOCKET_STATS)
+  client.getStats();
+  client.resetStats();
+#endif
+
   client.stop();
 
+// Test the connection pool
+  TinyGsmPool<TinyGsmClient, 1> pool(modem);
+  TinyGsmClient*                 pooled = pool.acquire(server, 80);
+  if (pooled) { pool.release(pooled); }
+  pool.expireIdle();
+  pool.idleCount();
+
+// Test the DNS cache
+#if defined(TINY_GSM_MODEM_HAS_DNS)
+  modem.resolve(server);
+  modem.prefetchHost(server);
+  modem.clearDNSCache();
+#endif
+
+#if defined(TINY_GSM_MODEM_HAS_UDP)
+  TinyGsmClientUDP udp(modem, 1);
+  uint8_t          datagram[16];
+  udp.begin(5000);
+  udp.beginPacket(server, 5000);
+  udp.write('x');
+  udp.endPacket();
+  udp.sendTo(server, 5000, datagram, sizeof(datagram));
+  if (udp.parsePacket()) { udp.read(datagram, sizeof(datagram)); }
+  udp.remoteIP();
+  udp.remotePort();
+  udp.stop();
+#endif
+
+#if defined(TINY_GSM_MODEM_HAS_SERVER)
+  TinyGsmClientServer tcp_server(modem, 8080);
+  TinyGsmClient       accepted;
+  IPAddress           accepted_ip;
+  tcp_server.begin();
+  tcp_server.listening();
+  if (tcp_server.available()) { tcp_server.accept(accepted, &accepted_ip); }
+  tcp_server.accept(accepted);
+  tcp_server.stop();
+#endif
+
+#if defined(TINY_GSM_MODEM_SIM800) || defined(TINY_GSM_MODEM_SIM808) || \
+    defined(TINY_GSM_MODEM_BG96)
+  modem.setKeepAlive(true);
+#endif
+
 #if defined(TINY_GSM_MODEM_HAS_SSL)
   // modem.addCertificate();  // not yet impemented
   // modem.deleteCertificate();  // not yet impemented
@@ -135,8 +235,11 @@ void loop() {
   modem.sendSMS(String("+380000000000"), String("Hello from "));
 
 #if not defined(TINY_GSM_MODEM_XBEE) && not defined(TINY_GSM_MODEM_SARAR4)
+#if !defined(TINY_GSM_NO_HEAP)
   modem.sendUSSD("*111#");
 #endif
+  modem.sendUSSD("*111#", text, sizeof(text));
+#endif
 
 #if not defined(TINY_GSM_MODEM_XBEE) && not defined(TINY_GSM_MODEM_M590) && \
     not defined(TINY_GSM_MODEM_SARAR4)
@@ -147,8 +250,12 @@ void loop() {
 
 // Test the GSM location functions
 #if defined(TINY_GSM_MODEM_HAS_GSM_LOCATION) && not defined(__AVR_ATmega32U4__)
+#if !defined(TINY_GSM_NO_HEAP)
   modem.getGsmLocationRaw();
   modem.getGsmLocation();
+#endif
+  modem.getGsmLocationRaw(text, sizeof(text));
+  modem.getGsmLocation(text, sizeof(text));
   float glatitude  = -9999;
   float glongitude = -9999;
   float gacc       = 0;
@@ -167,7 +274,10 @@ void loop() {
 // Test the GPS functions
 #if defined(TINY_GSM_MODEM_HAS_GPS) && not defined(__AVR_ATmega32U4__)
   modem.enableGPS();
+#if !defined(TINY_GSM_NO_HEAP)
   modem.getGPSraw();
+#endif
+  modem.getGPSraw(text, sizeof(text));
   float latitude  = -9999;
   float longitude = -9999;
   float speed     = 0;
@@ -194,7 +304,10 @@ void loop() {
 
 // Test the Network time function
 #if defined(TINY_GSM_MODEM_HAS_TIME) && not defined(__AVR_ATmega32U4__)
+#if !defined(TINY_GSM_NO_HEAP)
   modem.getGSMDateTime(DATE_FULL);
+#endif
+  modem.getGSMDateTime(DATE_FULL, text, sizeof(text));
   int   year3    = 0;
   int   month3   = 0;
   int   day3     = 0;